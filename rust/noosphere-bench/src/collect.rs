@@ -0,0 +1,349 @@
+//! Running the benchmarks of the workspace and collecting their results as
+//! [Metric]s
+
+use anyhow::{anyhow, Result};
+use serde::Deserialize;
+use std::{
+    collections::BTreeMap,
+    path::{Path, PathBuf},
+    process::Command,
+    time::SystemTime,
+};
+
+use crate::results::Metric;
+
+/// The root of the cargo workspace that this runner is a part of
+pub fn workspace_root() -> PathBuf {
+    Path::new(env!("CARGO_MANIFEST_DIR"))
+        .join("../..")
+        .canonicalize()
+        .unwrap_or_else(|_| PathBuf::from("."))
+}
+
+fn target_directory(workspace_root: &Path) -> PathBuf {
+    std::env::var_os("CARGO_TARGET_DIR")
+        .map(PathBuf::from)
+        .unwrap_or_else(|| workspace_root.join("target"))
+}
+
+fn run(command: &mut Command) -> Result<String> {
+    println!("Running {:?}", command);
+
+    let output = command.output()?;
+
+    if !output.status.success() {
+        return Err(anyhow!(
+            "Command {:?} failed ({}):\n{}",
+            command,
+            output.status,
+            String::from_utf8_lossy(&output.stderr)
+        ));
+    }
+
+    Ok(String::from_utf8_lossy(&output.stdout).trim().to_string())
+}
+
+/// The git revision of the workspace, suffixed with `-dirty` if there are
+/// uncommitted changes
+pub fn git_revision(workspace_root: &Path) -> Result<String> {
+    let revision = run(Command::new("git").current_dir(workspace_root).args([
+        "rev-parse",
+        "--short=12",
+        "HEAD",
+    ]))?;
+    let status = run(Command::new("git").current_dir(workspace_root).args([
+        "status",
+        "--porcelain",
+        "--untracked-files=no",
+    ]))?;
+
+    Ok(if status.is_empty() {
+        revision
+    } else {
+        format!("{revision}-dirty")
+    })
+}
+
+/// A short description of the machine that benchmarks are running on
+pub fn host_description() -> String {
+    let cpu = std::fs::read_to_string("/proc/cpuinfo")
+        .ok()
+        .and_then(|cpuinfo| {
+            cpuinfo
+                .lines()
+                .find(|line| line.starts_with("model name"))
+                .and_then(|line| line.split_once(':'))
+                .map(|(_, model)| model.trim().to_string())
+        })
+        .unwrap_or_else(|| "unknown CPU".into());
+    let parallelism = std::thread::available_parallelism()
+        .map(|parallelism| parallelism.get())
+        .unwrap_or(1);
+
+    format!(
+        "{} {} ({cpu}, {parallelism} threads)",
+        std::env::consts::OS,
+        std::env::consts::ARCH
+    )
+}
+
+#[derive(Deserialize)]
+struct StorageAnalysis {
+    count: u64,
+    p50: u64,
+    p99: u64,
+    ops_per_sec: f64,
+}
+
+#[derive(Deserialize)]
+struct StorageStats {
+    reads: StorageAnalysis,
+    writes: StorageAnalysis,
+    physical_bytes_stored: u64,
+}
+
+#[derive(Deserialize)]
+struct StorageReport {
+    benchmark: String,
+    storage: String,
+    stats: StorageStats,
+}
+
+/// Run the storage benchmark (the `bench` example of `noosphere-storage`),
+/// optionally with extra cargo `features` (e.g. `rocksdb`)
+pub fn run_storage_bench(
+    workspace_root: &Path,
+    features: Option<&str>,
+) -> Result<BTreeMap<String, Metric>> {
+    let report_path = target_directory(workspace_root).join("noosphere-bench-storage.json");
+    let mut command = Command::new("cargo");
+
+    command.current_dir(workspace_root).args([
+        "run",
+        "--release",
+        "-p",
+        "noosphere-storage",
+        "--example",
+        "bench",
+    ]);
+
+    if let Some(features) = features {
+        command.args(["--features", features]);
+    }
+
+    command.arg("--").arg("--json").arg(&report_path);
+    run(&mut command)?;
+
+    let reports: Vec<StorageReport> =
+        serde_json::from_str(&std::fs::read_to_string(&report_path)?)?;
+
+    Ok(storage_metrics(reports))
+}
+
+fn storage_metrics(reports: Vec<StorageReport>) -> BTreeMap<String, Metric> {
+    let mut metrics = BTreeMap::new();
+
+    for report in reports {
+        let prefix = format!("storage/{}/{}", report.storage, report.benchmark);
+
+        for (operation, analysis) in [
+            ("reads", &report.stats.reads),
+            ("writes", &report.stats.writes),
+        ] {
+            if analysis.count == 0 {
+                continue;
+            }
+
+            metrics.insert(
+                format!("{prefix}/{operation}/p50"),
+                Metric::lower(analysis.p50 as f64, "us"),
+            );
+            metrics.insert(
+                format!("{prefix}/{operation}/p99"),
+                Metric::lower(analysis.p99 as f64, "us"),
+            );
+            metrics.insert(
+                format!("{prefix}/{operation}/throughput"),
+                Metric::higher(analysis.ops_per_sec, "ops/s"),
+            );
+        }
+
+        metrics.insert(
+            format!("{prefix}/physical_bytes"),
+            Metric::lower(report.stats.physical_bytes_stored as f64, "bytes"),
+        );
+    }
+
+    metrics
+}
+
+#[derive(Deserialize)]
+struct CriterionEstimate {
+    point_estimate: f64,
+}
+
+#[derive(Deserialize)]
+struct CriterionEstimates {
+    mean: CriterionEstimate,
+}
+
+#[derive(Deserialize)]
+struct CriterionBenchmark {
+    full_id: String,
+}
+
+/// The cargo invocations that run the Criterion benchmarks collected by
+/// [run_core_benches]. Each names the bench targets to run (`--benches` or
+/// `--bench <name>`), so that `--noplot` is only handed to Criterion and not
+/// to the libtest harness of a crate's lib target, which would reject it.
+fn core_bench_commands(workspace_root: &Path) -> Vec<Command> {
+    [
+        &["-p", "noosphere-core", "--features", "helpers", "--benches"][..],
+        &["-p", "noosphere-collections", "--bench", "hamt"][..],
+    ]
+    .into_iter()
+    .map(|target| {
+        let mut command = Command::new("cargo");
+        command
+            .current_dir(workspace_root)
+            .arg("bench")
+            .args(target)
+            .args(["--", "--noplot"]);
+        command
+    })
+    .collect()
+}
+
+/// Run the Criterion benchmarks of `noosphere-core` (and the HAMT benchmarks
+/// of `noosphere-collections`), and collect the mean time of every benchmark
+/// that was measured by this run
+pub fn run_core_benches(workspace_root: &Path) -> Result<BTreeMap<String, Metric>> {
+    let started = SystemTime::now();
+
+    for mut command in core_bench_commands(workspace_root) {
+        run(&mut command)?;
+    }
+
+    let mut metrics = BTreeMap::new();
+    collect_criterion_estimates(
+        &target_directory(workspace_root).join("criterion"),
+        started,
+        &mut metrics,
+    )?;
+
+    Ok(metrics)
+}
+
+/// Criterion keeps the estimates of the latest run of each benchmark in a
+/// `new` directory; only those that were written since `since` are collected,
+/// so that benchmarks that were not part of this run are not reported
+fn collect_criterion_estimates(
+    directory: &Path,
+    since: SystemTime,
+    metrics: &mut BTreeMap<String, Metric>,
+) -> Result<()> {
+    if !directory.is_dir() {
+        return Ok(());
+    }
+
+    for entry in std::fs::read_dir(directory)? {
+        let path = entry?.path();
+
+        if !path.is_dir() {
+            continue;
+        }
+
+        let estimates_path = path.join("new").join("estimates.json");
+
+        if estimates_path.is_file() && std::fs::metadata(&estimates_path)?.modified()? >= since {
+            let estimates: CriterionEstimates =
+                serde_json::from_str(&std::fs::read_to_string(&estimates_path)?)?;
+            let benchmark: CriterionBenchmark = serde_json::from_str(&std::fs::read_to_string(
+                path.join("new").join("benchmark.json"),
+            )?)?;
+
+            metrics.insert(
+                format!("core/{}", benchmark.full_id),
+                Metric::lower(estimates.mean.point_estimate, "ns"),
+            );
+        }
+
+        collect_criterion_estimates(&path, since, metrics)?;
+    }
+
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use std::{
+        path::Path,
+        time::{Duration, SystemTime},
+    };
+
+    use super::{collect_criterion_estimates, core_bench_commands};
+
+    #[test]
+    fn it_only_hands_criterion_options_to_bench_targets() {
+        let commands = core_bench_commands(Path::new("."))
+            .iter()
+            .map(|command| {
+                command
+                    .get_args()
+                    .map(|arg| arg.to_string_lossy().into_owned())
+                    .collect::<Vec<_>>()
+            })
+            .collect::<Vec<_>>();
+
+        assert_eq!(commands.len(), 2);
+
+        for args in commands {
+            let (cargo_args, criterion_args) =
+                args.split_at(args.iter().position(|arg| arg == "--").unwrap());
+
+            assert_eq!(cargo_args[0], "bench");
+            assert!(cargo_args
+                .iter()
+                .any(|arg| arg == "--benches" || arg == "--bench"));
+            assert_eq!(criterion_args, ["--", "--noplot"]);
+        }
+    }
+
+    #[test]
+    fn it_collects_fresh_criterion_estimates() {
+        let directory = tempfile::TempDir::new().unwrap();
+        let benchmark = directory.path().join("car").join("encode").join("100");
+
+        std::fs::create_dir_all(benchmark.join("new")).unwrap();
+        std::fs::write(
+            benchmark.join("new").join("estimates.json"),
+            r#"{"mean":{"point_estimate":1234.5},"median":{"point_estimate":1200.0}}"#,
+        )
+        .unwrap();
+        std::fs::write(
+            benchmark.join("new").join("benchmark.json"),
+            r#"{"group_id":"car","function_id":"encode","value_str":"100","full_id":"car/encode/100"}"#,
+        )
+        .unwrap();
+
+        let mut metrics = Default::default();
+        collect_criterion_estimates(
+            directory.path(),
+            SystemTime::now() - Duration::from_secs(60),
+            &mut metrics,
+        )
+        .unwrap();
+
+        assert_eq!(metrics["core/car/encode/100"].value, 1234.5);
+
+        let mut stale_metrics = Default::default();
+        collect_criterion_estimates(
+            directory.path(),
+            SystemTime::now() + Duration::from_secs(60),
+            &mut stale_metrics,
+        )
+        .unwrap();
+
+        assert!(stale_metrics.is_empty());
+    }
+}
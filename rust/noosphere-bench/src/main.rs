@@ -0,0 +1,219 @@
+//! A runner for Noosphere's benchmarks that records results by git revision
+//! and flags regressions against a stored baseline. See the README for usage.
+
+mod collect;
+mod results;
+
+use anyhow::{anyhow, Result};
+use clap::{Parser, Subcommand};
+use std::{
+    path::{Path, PathBuf},
+    time::{SystemTime, UNIX_EPOCH},
+};
+
+use collect::{git_revision, host_description, run_core_benches, run_storage_bench};
+use results::{compare, BenchmarkResults, MetricChange};
+
+/// The name of the results file that runs are compared against by default
+const BASELINE_FILE_NAME: &str = "baseline.json";
+
+#[derive(Debug, Parser)]
+#[clap(name = "noosphere-bench", version, about)]
+struct Cli {
+    #[clap(subcommand)]
+    command: Command,
+}
+
+#[derive(Debug, Subcommand)]
+enum Command {
+    /// Run the benchmarks, record the results under the current git revision
+    /// and compare them to the baseline
+    Run {
+        /// The directory that results are recorded in; defaults to
+        /// `benchmarks` in the workspace root
+        #[clap(long)]
+        output_dir: Option<PathBuf>,
+
+        /// The results to compare against; defaults to `baseline.json` in the
+        /// output directory, if it exists
+        #[clap(long)]
+        baseline: Option<PathBuf>,
+
+        /// How much worse (in percent) a metric may get before it is flagged
+        /// as a regression
+        #[clap(long, default_value_t = 10.0)]
+        threshold: f64,
+
+        /// Also record the results of this run as the new baseline
+        #[clap(long)]
+        save_baseline: bool,
+
+        /// Extra cargo features to build the storage benchmark with (e.g.
+        /// `rocksdb`)
+        #[clap(long)]
+        storage_features: Option<String>,
+
+        /// Don't run the storage benchmark
+        #[clap(long)]
+        skip_storage: bool,
+
+        /// Don't run the core micro-benchmarks
+        #[clap(long)]
+        skip_core: bool,
+    },
+
+    /// Compare two previously recorded runs
+    Compare {
+        /// The results to compare against
+        baseline: PathBuf,
+
+        /// The results to check for regressions
+        candidate: PathBuf,
+
+        /// How much worse (in percent) a metric may get before it is flagged
+        /// as a regression
+        #[clap(long, default_value_t = 10.0)]
+        threshold: f64,
+    },
+}
+
+fn report(baseline: &BenchmarkResults, candidate: &BenchmarkResults, threshold: f64) -> Result<()> {
+    let changes = compare(baseline, candidate, threshold);
+
+    println!(
+        "\nComparing {} against baseline {} (threshold {threshold}%)\n",
+        candidate.revision, baseline.revision
+    );
+
+    if baseline.host != candidate.host {
+        println!(
+            "Warning: the baseline was recorded on a different host ({})\n",
+            baseline.host
+        );
+    }
+
+    for MetricChange {
+        name,
+        baseline,
+        candidate,
+        regression_percent,
+        is_regression,
+    } in changes.iter()
+    {
+        println!(
+            "{} {name}: {baseline:.1} -> {candidate:.1} ({:+.1}% worse)",
+            if *is_regression {
+                "REGRESSED"
+            } else {
+                "ok       "
+            },
+            regression_percent
+        );
+    }
+
+    let regressions = changes.iter().filter(|change| change.is_regression).count();
+
+    if regressions > 0 {
+        Err(anyhow!(
+            "{regressions} of {} metrics regressed by more than {threshold}%",
+            changes.len()
+        ))
+    } else {
+        println!("\nNo regressions in {} metrics", changes.len());
+        Ok(())
+    }
+}
+
+#[allow(clippy::too_many_arguments)]
+fn run(
+    workspace_root: &Path,
+    output_dir: Option<PathBuf>,
+    baseline: Option<PathBuf>,
+    threshold: f64,
+    save_baseline: bool,
+    storage_features: Option<String>,
+    skip_storage: bool,
+    skip_core: bool,
+) -> Result<()> {
+    let output_dir = output_dir.unwrap_or_else(|| workspace_root.join("benchmarks"));
+    let mut results = BenchmarkResults {
+        revision: git_revision(workspace_root)?,
+        host: host_description(),
+        ..Default::default()
+    };
+
+    if !skip_storage {
+        results.metrics.extend(run_storage_bench(
+            workspace_root,
+            storage_features.as_deref(),
+        )?);
+    }
+
+    if !skip_core {
+        results.metrics.extend(run_core_benches(workspace_root)?);
+    }
+
+    results.timestamp = SystemTime::now().duration_since(UNIX_EPOCH)?.as_secs();
+
+    let results_path = output_dir.join(format!("{}.json", results.revision));
+    results.write(&results_path)?;
+    println!(
+        "Recorded {} metrics to {:?}",
+        results.metrics.len(),
+        results_path
+    );
+
+    let baseline_path = baseline.unwrap_or_else(|| output_dir.join(BASELINE_FILE_NAME));
+    let comparison = if baseline_path.is_file() {
+        report(
+            &BenchmarkResults::read(&baseline_path)?,
+            &results,
+            threshold,
+        )
+    } else {
+        println!(
+            "No baseline found at {:?}; nothing to compare",
+            baseline_path
+        );
+        Ok(())
+    };
+
+    if save_baseline {
+        results.write(&output_dir.join(BASELINE_FILE_NAME))?;
+        println!("Saved {} as the new baseline", results.revision);
+    }
+
+    comparison
+}
+
+fn main() -> Result<()> {
+    match Cli::parse().command {
+        Command::Run {
+            output_dir,
+            baseline,
+            threshold,
+            save_baseline,
+            storage_features,
+            skip_storage,
+            skip_core,
+        } => run(
+            &collect::workspace_root(),
+            output_dir,
+            baseline,
+            threshold,
+            save_baseline,
+            storage_features,
+            skip_storage,
+            skip_core,
+        ),
+        Command::Compare {
+            baseline,
+            candidate,
+            threshold,
+        } => report(
+            &BenchmarkResults::read(&baseline)?,
+            &BenchmarkResults::read(&candidate)?,
+            threshold,
+        ),
+    }
+}
@@ -0,0 +1,181 @@
+//! The recorded results of a benchmark run, and how two runs are compared
+
+use anyhow::Result;
+use serde::{Deserialize, Serialize};
+use std::{collections::BTreeMap, path::Path};
+
+/// A single measurement taken during a benchmark run
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct Metric {
+    /// The measured value, in `unit`s
+    pub value: f64,
+    /// The unit of the value (e.g. `ns` or `ops/s`)
+    pub unit: String,
+    /// Whether a larger value is an improvement (e.g. for throughput)
+    pub higher_is_better: bool,
+}
+
+impl Metric {
+    /// A metric where smaller values are better, such as a latency
+    pub fn lower(value: f64, unit: &str) -> Self {
+        Metric {
+            value,
+            unit: unit.into(),
+            higher_is_better: false,
+        }
+    }
+
+    /// A metric where larger values are better, such as a throughput
+    pub fn higher(value: f64, unit: &str) -> Self {
+        Metric {
+            value,
+            unit: unit.into(),
+            higher_is_better: true,
+        }
+    }
+}
+
+/// All of the metrics recorded by one benchmark run
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct BenchmarkResults {
+    /// The git revision that was measured
+    pub revision: String,
+    /// Seconds since the UNIX epoch when the run finished
+    pub timestamp: u64,
+    /// A description of the machine that the run happened on
+    pub host: String,
+    /// Metrics by name, e.g. `storage/SledDbStorage/sphere_writing_large_files/writes/p99`
+    pub metrics: BTreeMap<String, Metric>,
+}
+
+impl BenchmarkResults {
+    /// Read results that were previously written with [BenchmarkResults::write]
+    pub fn read(path: &Path) -> Result<Self> {
+        Ok(serde_json::from_str(&std::fs::read_to_string(path)?)?)
+    }
+
+    /// Write these results as JSON to `path`
+    pub fn write(&self, path: &Path) -> Result<()> {
+        if let Some(parent) = path.parent() {
+            std::fs::create_dir_all(parent)?;
+        }
+
+        std::fs::write(path, serde_json::to_string_pretty(self)?)?;
+        Ok(())
+    }
+}
+
+/// How one metric changed between a baseline and a candidate run
+#[derive(Debug, Clone, PartialEq)]
+pub struct MetricChange {
+    /// The name of the metric
+    pub name: String,
+    /// The value in the baseline
+    pub baseline: f64,
+    /// The value in the candidate
+    pub candidate: f64,
+    /// How much worse (positive) or better (negative) the candidate is, as a
+    /// percentage of the baseline
+    pub regression_percent: f64,
+    /// Whether the regression exceeds the threshold of the comparison
+    pub is_regression: bool,
+}
+
+/// Compare every metric that is present in both `baseline` and `candidate`.
+/// A metric regresses when it gets worse by more than `threshold_percent`.
+pub fn compare(
+    baseline: &BenchmarkResults,
+    candidate: &BenchmarkResults,
+    threshold_percent: f64,
+) -> Vec<MetricChange> {
+    candidate
+        .metrics
+        .iter()
+        .filter_map(|(name, metric)| {
+            let baseline_metric = baseline.metrics.get(name)?;
+
+            if baseline_metric.value == 0.0 {
+                return None;
+            }
+
+            let change =
+                (metric.value - baseline_metric.value) / baseline_metric.value.abs() * 100.0;
+            let regression_percent = if metric.higher_is_better {
+                -change
+            } else {
+                change
+            };
+
+            Some(MetricChange {
+                name: name.clone(),
+                baseline: baseline_metric.value,
+                candidate: metric.value,
+                regression_percent,
+                is_regression: regression_percent > threshold_percent,
+            })
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{compare, BenchmarkResults, Metric};
+
+    #[test]
+    fn it_flags_metrics_that_got_worse_beyond_the_threshold() {
+        let mut baseline = BenchmarkResults::default();
+        baseline
+            .metrics
+            .insert("latency".into(), Metric::lower(100.0, "ns"));
+        baseline
+            .metrics
+            .insert("throughput".into(), Metric::higher(1000.0, "ops/s"));
+        baseline
+            .metrics
+            .insert("removed".into(), Metric::lower(1.0, "ns"));
+
+        let mut candidate = BenchmarkResults::default();
+        candidate
+            .metrics
+            .insert("latency".into(), Metric::lower(108.0, "ns"));
+        candidate
+            .metrics
+            .insert("throughput".into(), Metric::higher(800.0, "ops/s"));
+        candidate
+            .metrics
+            .insert("added".into(), Metric::lower(1.0, "ns"));
+
+        let changes = compare(&baseline, &candidate, 10.0);
+
+        assert_eq!(changes.len(), 2);
+
+        let latency = changes.iter().find(|c| c.name == "latency").unwrap();
+        assert!((latency.regression_percent - 8.0).abs() < 1e-9);
+        assert!(!latency.is_regression);
+
+        let throughput = changes.iter().find(|c| c.name == "throughput").unwrap();
+        assert!((throughput.regression_percent - 20.0).abs() < 1e-9);
+        assert!(throughput.is_regression);
+    }
+
+    #[test]
+    fn it_round_trips_results_through_json() {
+        let directory = tempfile::TempDir::new().unwrap();
+        let path = directory.path().join("nested").join("results.json");
+        let mut results = BenchmarkResults {
+            revision: "abc1234".into(),
+            timestamp: 1,
+            host: "test".into(),
+            ..Default::default()
+        };
+        results
+            .metrics
+            .insert("latency".into(), Metric::lower(1.5, "ns"));
+
+        results.write(&path).unwrap();
+        let read = BenchmarkResults::read(&path).unwrap();
+
+        assert_eq!(read.revision, results.revision);
+        assert_eq!(read.metrics, results.metrics);
+    }
+}
@@ -19,6 +19,11 @@ publishing the contents of those spheres to public networks."#))]
 pub struct Cli {
     #[clap(subcommand)]
     pub command: OrbCommand,
+
+    /// Record how long each phase of the command takes, and write a report to
+    /// the .sphere/profiles directory of the workspace when it finishes
+    #[clap(long, global = true)]
+    pub profile: bool,
 }
 
 #[allow(missing_docs)]
@@ -136,6 +141,11 @@ pub enum SphereCommand {
         /// Only output the orb id
         #[clap(long)]
         id: bool,
+
+        /// Only output a breakdown of the space used by the sphere's local
+        /// storage
+        #[clap(long)]
+        storage: bool,
     },
 
     /// Saves changed files to a sphere, creating and signing a new revision in
@@ -163,6 +173,21 @@ pub enum SphereCommand {
         render_depth: Option<u32>,
     },
 
+    /// Watches the workspace for changed files and saves them to the sphere as
+    /// they change, batching changes that happen in quick succession; only
+    /// the changed files are read, so saves stay fast in large workspaces
+    Watch {
+        /// How long to wait for further changes (in milliseconds) before
+        /// saving a batch of changes
+        #[clap(long, default_value = "500")]
+        debounce_ms: u64,
+
+        /// The maximum depth to traverse through followed spheres when
+        /// rendering updates
+        #[clap(short = 'd', long)]
+        render_depth: Option<u32>,
+    },
+
     /// Force a render of local sphere content as well as the peer graph; note
     /// that this will overwrite any unsaved changes to local sphere content
     Render {
@@ -5,9 +5,16 @@ use crate::native::workspace::Workspace;
 use anyhow::Result;
 use noosphere_core::context::HasSphereContext;
 use noosphere_gateway::{Gateway, SingleTenantGatewayManager};
-use std::net::{IpAddr, TcpListener};
+use noosphere_storage::Space;
+use std::{
+    net::{IpAddr, TcpListener},
+    time::Duration,
+};
 use url::Url;
 
+/// How often the gateway's storage stats are refreshed in its metrics
+const STORAGE_STATS_INTERVAL: Duration = Duration::from_secs(60);
+
 /// Start a Noosphere gateway server
 pub async fn serve(
     interface: IpAddr,
@@ -21,6 +28,8 @@ pub async fn serve(
 
     let listener = TcpListener::bind((interface, port))?;
     let counterpart = workspace.counterpart_identity().await?;
+    // The workspace's storage is metered, so the gateway's block I/O is
+    // reported (by operation) in its metrics
     let sphere_context = workspace.sphere_context().await?;
     let gateway_identity = sphere_context
         .sphere_context()
@@ -39,6 +48,22 @@ pub async fn serve(
 
     let gateway = Gateway::new(manager)?;
 
+    // Storage stats are gathered periodically rather than when metrics are
+    // scraped, so that scrapes stay cheap
+    let storage = workspace.db().await?.storage().clone();
+    let storage_stats_task = tokio::spawn(async move {
+        let mut interval = tokio::time::interval(STORAGE_STATS_INTERVAL);
+
+        loop {
+            interval.tick().await;
+
+            match storage.get_storage_stats().await {
+                Ok(stats) => stats.record_metrics(),
+                Err(error) => warn!("Failed to gather storage stats: {}", error),
+            }
+        }
+    });
+
     info!(
         r#"A geist is summoned to manage local sphere {}
 
@@ -51,6 +76,7 @@ pub async fn serve(
         counterpart
     );
 
-    gateway.start(listener).await?;
-    Ok(())
+    let result = gateway.start(listener).await;
+    storage_stats_task.abort();
+    result
 }
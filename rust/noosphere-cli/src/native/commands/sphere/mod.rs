@@ -8,6 +8,7 @@ mod render;
 mod save;
 mod status;
 mod sync;
+mod watch;
 
 pub use auth::*;
 pub use config::*;
@@ -17,6 +18,7 @@ pub use render::*;
 pub use save::*;
 pub use status::*;
 pub use sync::*;
+pub use watch::*;
 
 use std::{str::FromStr, sync::Arc};
 
@@ -1,9 +1,6 @@
 use anyhow::{anyhow, Result};
-use cid::Cid;
-use libipld_cbor::DagCborCodec;
 use noosphere_core::context::{HasMutableSphereContext, SphereContentWrite, SphereCursor};
 use noosphere_core::data::Header;
-use noosphere_storage::BlockStore;
 
 use crate::native::{
     content::{Content, FileReference},
@@ -13,24 +10,25 @@ use crate::native::{
 /// TODO(#105): We may want to change this to take an optional list of paths to
 /// consider, and allow the user to rely on their shell for glob filtering
 pub async fn save(render_depth: Option<u32>, workspace: &Workspace) -> Result<()> {
-    workspace.ensure_sphere_initialized()?;
+    if save_changes(render_depth, workspace).await? {
+        Ok(())
+    } else {
+        Err(anyhow!("No changes to save"))
+    }
+}
 
-    let mut db = workspace.db().await?;
+/// Same as [save], but a workspace without any changes is not an error:
+/// returns whether anything was saved. The workspace is only scanned once.
+pub async fn save_changes(render_depth: Option<u32>, workspace: &Workspace) -> Result<bool> {
+    workspace.ensure_sphere_initialized()?;
 
     let sphere_context = workspace.sphere_context().await?;
 
     let mut has_unsaved_changes = sphere_context.has_unsaved_changes().await?;
 
-    if let Some((content, content_changes, memory_store)) = Content::read_changes(workspace).await?
-    {
-        let content_entries = memory_store.entries.lock().await;
-
-        for (cid_bytes, block) in content_entries.iter() {
-            let cid = Cid::try_from(cid_bytes.as_slice())?;
-            db.put_block(&cid, block).await?;
-            db.put_links::<DagCborCodec>(&cid, block).await?;
-        }
+    let db = workspace.db().await?;
 
+    if let Some((content, content_changes)) = Content::read_changes(workspace, &db).await? {
         let mut sphere_context = workspace.sphere_context().await?;
 
         for (slug, _) in content_changes
@@ -69,9 +67,7 @@ pub async fn save(render_depth: Option<u32>, workspace: &Workspace) -> Result<()
         info!("Save complete!\nThe latest sphere revision is {cid}");
 
         workspace.render(render_depth, false).await?;
-
-        Ok(())
-    } else {
-        Err(anyhow!("No changes to save"))
     }
+
+    Ok(has_unsaved_changes)
 }
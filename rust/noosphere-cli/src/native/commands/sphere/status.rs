@@ -4,6 +4,7 @@ use crate::native::{content::Content, Workspace};
 use anyhow::Result;
 use noosphere_core::context::{HasSphereContext, SphereCursor};
 use noosphere_core::data::ContentType;
+use noosphere_storage::{MemoryStore, Space};
 
 fn status_section(
     name: &str,
@@ -25,9 +26,49 @@ fn status_section(
     }
 }
 
+/// Report how much space the sphere's local storage uses, broken down by store
+async fn storage_status(workspace: &Workspace) -> Result<()> {
+    let stats = workspace.db().await?.storage().get_storage_stats().await?;
+    let describe = |value: Option<u64>| {
+        value
+            .map(|value| value.to_string())
+            .unwrap_or_else(|| "-".into())
+    };
+
+    info!("Local storage uses {} bytes\n", stats.space_usage);
+    info!(
+        "{:<10} {:>14} {:>14} {:>12}",
+        "Store", "Live bytes", "On disk", "Entries"
+    );
+
+    for (name, store) in stats.stores.iter() {
+        info!(
+            "{:<10} {:>14} {:>14} {:>12}",
+            name,
+            describe(store.live_bytes),
+            describe(store.on_disk_bytes),
+            describe(store.entries)
+        );
+    }
+
+    if let Some(average_block_size) = stats.average_block_size() {
+        info!("\nAverage block size: {average_block_size:.1} bytes");
+    }
+
+    if let Some(space_amplification) = stats.space_amplification() {
+        info!("Space amplification: {space_amplification:.2}");
+    }
+
+    if let Some(pending_compaction_bytes) = stats.pending_compaction_bytes {
+        info!("Pending compaction: {pending_compaction_bytes} bytes");
+    }
+
+    Ok(())
+}
+
 /// Get the current status of the workspace, reporting the content that has
 /// changed in some way (if any)
-pub async fn status(only_id: bool, workspace: &Workspace) -> Result<()> {
+pub async fn status(only_id: bool, only_storage: bool, workspace: &Workspace) -> Result<()> {
     workspace.ensure_sphere_initialized()?;
 
     let identity = workspace.sphere_identity().await?;
@@ -37,15 +78,20 @@ pub async fn status(only_id: bool, workspace: &Workspace) -> Result<()> {
         return Ok(());
     }
 
+    if only_storage {
+        return storage_status(workspace).await;
+    }
+
     info!("This sphere's identity is {identity}");
 
     let sphere_context = workspace.sphere_context().await?;
     let cid = SphereCursor::latest(sphere_context).version().await?;
     info!("The latest (saved) version of your sphere is {cid}\n");
 
-    // TODO(#556): No need to pack new blocks into a memory store at this step;
-    // maybe [Content::read_changes] can be optimized for this path
-    let (_, content_changes, _) = match Content::read_changes(workspace).await? {
+    // Reading the changes must not write the blocks of unsaved files to the
+    // sphere's storage
+    let scratch = MemoryStore::default();
+    let (_, content_changes) = match Content::read_changes(workspace, &scratch).await? {
         Some(changes) => changes,
         None => {
             info!("No new changes to sphere content!");
@@ -1,6 +1,7 @@
 use crate::native::{content::Content, workspace::Workspace};
 use anyhow::{anyhow, Result};
 use noosphere_core::context::{SphereSync, SyncExtent, SyncRecovery};
+use noosphere_storage::MemoryStore;
 
 /// Attempt to synchronize the local workspace with a configured gateway,
 /// optionally automatically retrying a fixed number of times in case a rebase
@@ -9,8 +10,9 @@ use noosphere_core::context::{SphereSync, SyncExtent, SyncRecovery};
 pub async fn sync(auto_retry: u32, render_depth: Option<u32>, workspace: &Workspace) -> Result<()> {
     workspace.ensure_sphere_initialized()?;
 
-    match Content::read_changes(workspace).await? {
-        Some((_, content_changes, _)) if !content_changes.is_empty() => {
+    // Only checking for changes, so their blocks are not kept
+    match Content::read_changes(workspace, &MemoryStore::default()).await? {
+        Some((_, content_changes)) if !content_changes.is_empty() => {
             return Err(anyhow!(
                 "You have unsaved local changes; save or revert them before syncing!"
             ));
@@ -0,0 +1,477 @@
+use anyhow::{anyhow, Result};
+use cid::Cid;
+use noosphere_core::context::{
+    HasMutableSphereContext, SphereContentRead, SphereContentWrite, SphereCursor,
+};
+use noosphere_core::data::{ContentType, Header};
+use notify::{EventKind, RecursiveMode, Watcher};
+use std::{
+    collections::{BTreeMap, BTreeSet},
+    path::{Path, PathBuf},
+    time::Duration,
+};
+use tokio::{
+    fs, select,
+    sync::mpsc::unbounded_channel,
+    time::{sleep_until, Instant},
+};
+
+use crate::native::{
+    commands::sphere::save_changes,
+    content::{Content, FileReference},
+    paths::SpherePaths,
+    stat_cache::{FileStat, StatCache, RACY_MODIFICATION_WINDOW},
+    workspace::Workspace,
+};
+
+/// A file that was chunked too soon after it was modified for its stat to be
+/// cached; it is cached once it has gone unmodified for long enough
+struct SettlingFile {
+    cache_key: String,
+    stat: FileStat,
+    cid: Cid,
+    content_type: ContentType,
+}
+
+/// Watch the workspace for changes to its files, saving them to the sphere as
+/// they happen. Changes are batched: once no file has changed for `debounce`,
+/// only the files that changed are read, chunked and saved as a new revision
+/// of the sphere. Anything that the watcher cannot account for file-by-file
+/// (a directory that was created, moved or removed, or a watcher that
+/// overflowed) falls back to a full scan of the workspace, as with
+/// [save_changes]. Runs until interrupted.
+pub async fn watch(
+    debounce: Duration,
+    render_depth: Option<u32>,
+    workspace: &Workspace,
+) -> Result<()> {
+    workspace.ensure_sphere_initialized()?;
+
+    // Catch up on changes that were made while nothing was watching
+    save_changes(render_depth, workspace).await?;
+
+    let paths = workspace.require_sphere_paths()?.clone();
+    let root = paths.root().to_owned();
+
+    let (tx, mut rx) = unbounded_channel();
+    let mut watcher = notify::recommended_watcher(move |event| {
+        let _ = tx.send(event);
+    })?;
+    watcher.watch(&root, RecursiveMode::Recursive)?;
+
+    info!("Watching {:?} for changes; press Ctrl+C to stop", root);
+
+    let mut stat_cache = StatCache::load(paths.stat_cache()).await;
+    stat_cache.carry_over();
+
+    let mut changed_paths = BTreeSet::<PathBuf>::new();
+    let mut rescan = false;
+    let mut save_at: Option<Instant> = None;
+    let mut settling = Vec::<SettlingFile>::new();
+    let mut settle_at: Option<Instant> = None;
+
+    loop {
+        select! {
+            event = rx.recv() => {
+                let event = match event {
+                    Some(event) => event,
+                    None => return Err(anyhow!("The file system watcher stopped unexpectedly")),
+                };
+
+                match event {
+                    Ok(event) => {
+                        rescan |= event.need_rescan();
+
+                        if !matches!(event.kind, EventKind::Access(_)) {
+                            for path in event.paths {
+                                if let Some(relative_path) = workspace_path(&root, &path) {
+                                    changed_paths.insert(relative_path);
+                                    save_at = Some(Instant::now() + debounce);
+                                }
+                            }
+                        }
+                    }
+                    Err(error) => {
+                        warn!("File system watcher error: {}", error);
+                        rescan = true;
+                    }
+                }
+
+                if rescan && save_at.is_none() {
+                    save_at = Some(Instant::now() + debounce);
+                }
+            },
+            _ = sleep_until(save_at.unwrap_or_else(Instant::now)), if save_at.is_some() => {
+                save_at = None;
+
+                let changed_paths = std::mem::take(&mut changed_paths);
+
+                rescan = rescan || needs_rescan(&root, &changed_paths).await;
+
+                let result = if rescan {
+                    rescan = false;
+                    settling.clear();
+                    save_all(render_depth, workspace, &paths, &mut stat_cache).await
+                } else {
+                    save_changed(
+                        render_depth,
+                        workspace,
+                        &root,
+                        changed_paths,
+                        &mut stat_cache,
+                        &mut settling,
+                    )
+                    .await
+                };
+
+                if let Err(error) = result {
+                    warn!("Could not save changes: {}", error);
+                    rescan = true;
+                    save_at = Some(Instant::now() + debounce);
+                }
+
+                if !settling.is_empty() && settle_at.is_none() {
+                    settle_at = Some(Instant::now() + RACY_MODIFICATION_WINDOW);
+                }
+            },
+            _ = sleep_until(settle_at.unwrap_or_else(Instant::now)), if settle_at.is_some() => {
+                settle_at = None;
+
+                settle(&root, &mut settling, &mut stat_cache).await;
+
+                if let Err(error) = stat_cache.save().await {
+                    warn!("Could not save the workspace stat cache: {}", error);
+                }
+
+                if !settling.is_empty() {
+                    settle_at = Some(Instant::now() + RACY_MODIFICATION_WINDOW);
+                }
+            },
+            _ = tokio::signal::ctrl_c() => {
+                break;
+            }
+        }
+    }
+
+    info!("Stopped watching");
+
+    stat_cache.save().await
+}
+
+/// The path of a file or directory relative to the workspace root, unless it
+/// is outside of the workspace or ignored
+fn workspace_path(root: &Path, path: &Path) -> Option<PathBuf> {
+    let relative_path = path.strip_prefix(root).ok()?;
+
+    match Content::is_ignored(relative_path) {
+        Ok(false) if !relative_path.as_os_str().is_empty() => Some(relative_path.to_owned()),
+        _ => None,
+    }
+}
+
+/// Whether the changed paths include anything that can't be accounted for
+/// file-by-file: a directory that now exists (whose files may never have been
+/// reported individually), or a path without an extension that no longer
+/// exists (which may have been a directory)
+async fn needs_rescan(root: &Path, changed_paths: &BTreeSet<PathBuf>) -> bool {
+    for relative_path in changed_paths {
+        match fs::metadata(root.join(relative_path)).await {
+            Ok(metadata) if metadata.is_dir() => return true,
+            Ok(_) => (),
+            Err(_) if relative_path.extension().is_none() => return true,
+            Err(_) => (),
+        }
+    }
+
+    false
+}
+
+/// Save every change in the workspace after a full scan, and start over with
+/// the stat cache that the scan produced
+async fn save_all(
+    render_depth: Option<u32>,
+    workspace: &Workspace,
+    paths: &SpherePaths,
+    stat_cache: &mut StatCache,
+) -> Result<()> {
+    stat_cache.save().await?;
+
+    info!("Scanning the workspace for changes...");
+
+    save_changes(render_depth, workspace).await?;
+
+    *stat_cache = StatCache::load(paths.stat_cache()).await;
+    stat_cache.carry_over();
+
+    Ok(())
+}
+
+/// Read and chunk the files at `changed_paths`, and save whichever of them
+/// differ from the sphere's latest revision (removing the ones that no longer
+/// exist)
+async fn save_changed(
+    render_depth: Option<u32>,
+    workspace: &Workspace,
+    root: &Path,
+    changed_paths: BTreeSet<PathBuf>,
+    stat_cache: &mut StatCache,
+    settling: &mut Vec<SettlingFile>,
+) -> Result<()> {
+    let db = workspace.db().await?;
+
+    let mut present = BTreeMap::<String, FileReference>::new();
+    let mut missing = BTreeSet::<String>::new();
+
+    for relative_path in changed_paths {
+        let slug = match Content::slug_for(&relative_path) {
+            Some(slug) => slug,
+            None => continue,
+        };
+        let cache_key = relative_path.to_string_lossy().to_string();
+        let path = root.join(&relative_path);
+
+        let metadata = match fs::metadata(&path).await {
+            Ok(metadata) => metadata,
+            Err(error) if error.kind() == std::io::ErrorKind::NotFound => {
+                stat_cache.remove(&cache_key);
+                missing.insert(slug);
+                continue;
+            }
+            Err(error) => return Err(error.into()),
+        };
+
+        let reference = Content::read_file(&path, &db).await?;
+
+        match FileStat::from_metadata(&metadata) {
+            Some(stat) => {
+                stat_cache.insert(&cache_key, stat, &reference.cid, &reference.content_type)
+            }
+            None => {
+                stat_cache.remove(&cache_key);
+
+                if let Some(stat) = FileStat::of(&metadata) {
+                    settling.retain(|file| file.cache_key != cache_key);
+                    settling.push(SettlingFile {
+                        cache_key,
+                        stat,
+                        cid: reference.cid,
+                        content_type: reference.content_type.clone(),
+                    });
+                }
+            }
+        }
+
+        present.insert(slug, reference);
+    }
+
+    let mut sphere_context = workspace.sphere_context().await?;
+    let mut has_changes = false;
+
+    for slug in missing {
+        // A file may have been renamed to another with the same slug (e.g.,
+        // only its extension changed)
+        if present.contains_key(&slug) || !sphere_context.exists(&slug).await? {
+            continue;
+        }
+
+        info!("Removing '{slug}'...");
+        sphere_context.remove(&slug).await?;
+        has_changes = true;
+    }
+
+    for (
+        slug,
+        FileReference {
+            cid,
+            content_type,
+            extension,
+        },
+    ) in present
+    {
+        if let Some(file) = sphere_context.read(&slug).await? {
+            // A rename may only have changed the file's extension
+            if file.memo.body == cid
+                && file.memo.get_first_header(&Header::FileExtension) == extension
+            {
+                continue;
+            }
+        }
+
+        info!("Saving '{slug}'...");
+
+        let headers = extension
+            .as_ref()
+            .map(|extension| vec![(Header::FileExtension.to_string(), extension.clone())]);
+
+        sphere_context
+            .link(&slug, &content_type, &cid, headers)
+            .await?;
+        has_changes = true;
+    }
+
+    if has_changes {
+        let cid = SphereCursor::latest(sphere_context).save(None).await?;
+        info!("The latest sphere revision is {cid}");
+
+        workspace.render(render_depth, false).await?;
+    }
+
+    stat_cache.save().await
+}
+
+/// Cache the stats of the settling files that have now gone unmodified for
+/// long enough; the ones that were modified again are dropped (the watcher
+/// will have reported them)
+async fn settle(root: &Path, settling: &mut Vec<SettlingFile>, stat_cache: &mut StatCache) {
+    let mut still_settling = Vec::new();
+
+    for file in settling.drain(..) {
+        let metadata = match fs::metadata(root.join(&file.cache_key)).await {
+            Ok(metadata) => metadata,
+            Err(_) => continue,
+        };
+
+        match FileStat::from_metadata(&metadata) {
+            Some(stat) if stat == file.stat => {
+                stat_cache.insert(&file.cache_key, stat, &file.cid, &file.content_type)
+            }
+            None if FileStat::of(&metadata).as_ref() == Some(&file.stat) => {
+                still_settling.push(file)
+            }
+            _ => (),
+        }
+    }
+
+    *settling = still_settling;
+}
+
+#[cfg(test)]
+mod tests {
+    use super::save_changed;
+    use crate::native::{
+        commands::{key::key_create, sphere::sphere_create},
+        helpers::temporary_workspace,
+        stat_cache::StatCache,
+    };
+    use anyhow::Result;
+    use noosphere_core::{
+        context::{SphereContentRead, SphereCursor},
+        data::Header,
+    };
+    use std::{collections::BTreeSet, path::PathBuf};
+    use tokio::{fs, io::AsyncReadExt};
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn it_saves_a_batch_of_changed_paths() -> Result<()> {
+        let (mut workspace, _temporary_directories) = temporary_workspace()?;
+
+        key_create("foo", &workspace).await?;
+        sphere_create("foo", &mut workspace).await?;
+
+        let paths = workspace.require_sphere_paths()?.clone();
+        let root = paths.root().to_owned();
+        let mut stat_cache = StatCache::load(paths.stat_cache()).await;
+        let mut settling = Vec::new();
+
+        for (path, content) in [
+            ("changed.subtext", "before"),
+            ("renamed.subtext", "rename me"),
+            ("deleted.txt", "delete me"),
+            ("reformatted.txt", "same slug"),
+        ] {
+            fs::write(root.join(path), content).await?;
+        }
+
+        save_changed(
+            None,
+            &workspace,
+            &root,
+            BTreeSet::from(
+                [
+                    "changed.subtext",
+                    "renamed.subtext",
+                    "deleted.txt",
+                    "reformatted.txt",
+                ]
+                .map(PathBuf::from),
+            ),
+            &mut stat_cache,
+            &mut settling,
+        )
+        .await?;
+
+        fs::write(root.join("changed.subtext"), "after").await?;
+        fs::rename(
+            root.join("renamed.subtext"),
+            root.join("was-renamed.subtext"),
+        )
+        .await?;
+        fs::remove_file(root.join("deleted.txt")).await?;
+        fs::rename(root.join("reformatted.txt"), root.join("reformatted.md")).await?;
+        fs::write(root.join("added.txt"), "new").await?;
+
+        save_changed(
+            None,
+            &workspace,
+            &root,
+            BTreeSet::from(
+                [
+                    "changed.subtext",
+                    "renamed.subtext",
+                    "was-renamed.subtext",
+                    "deleted.txt",
+                    "reformatted.txt",
+                    "reformatted.md",
+                    "added.txt",
+                ]
+                .map(PathBuf::from),
+            ),
+            &mut stat_cache,
+            &mut settling,
+        )
+        .await?;
+
+        let cursor = SphereCursor::latest(workspace.sphere_context().await?);
+        let expected_content = [
+            ("changed", Some("after")),
+            ("renamed", None),
+            ("was-renamed", Some("rename me")),
+            ("deleted", None),
+            ("reformatted", Some("same slug")),
+            ("added", Some("new")),
+        ];
+
+        for (slug, expected) in expected_content {
+            let content = match cursor.read(slug).await? {
+                Some(mut file) => {
+                    let mut content = String::new();
+                    file.contents.read_to_string(&mut content).await?;
+                    Some(content)
+                }
+                None => None,
+            };
+
+            assert_eq!(
+                content.as_deref(),
+                expected,
+                "Unexpected content for '{slug}'"
+            );
+        }
+
+        let reformatted = cursor.read("reformatted").await?.unwrap();
+
+        assert_eq!(
+            reformatted.memo.get_first_header(&Header::FileExtension),
+            Some("md".into())
+        );
+
+        // The changes are rendered back to the workspace as well
+        assert_eq!(
+            fs::read_to_string(root.join("was-renamed.subtext")).await?,
+            "rename me"
+        );
+        assert!(!fs::try_exists(root.join("renamed.subtext")).await?);
+
+        Ok(())
+    }
+}
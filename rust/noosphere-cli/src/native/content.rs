@@ -3,17 +3,33 @@
 use anyhow::{anyhow, Result};
 use cid::Cid;
 use globset::{Glob, GlobSet, GlobSetBuilder};
+use libipld_cbor::DagCborCodec;
 use noosphere_core::data::{BodyChunkIpld, ContentType};
-use noosphere_storage::{BlockStore, MemoryStore};
+use noosphere_storage::BlockStore;
 use pathdiff::diff_paths;
-use std::collections::{BTreeMap, BTreeSet};
+use std::{
+    collections::{BTreeMap, BTreeSet},
+    fs::Metadata,
+    path::{Path, PathBuf},
+    sync::{Arc, OnceLock},
+    thread::available_parallelism,
+};
 use subtext::util::to_slug;
-use tokio::fs;
+use tokio::{
+    fs, select,
+    sync::Semaphore,
+    task::{spawn_blocking, JoinSet},
+};
 use tokio_stream::StreamExt;
 
 use noosphere_core::context::SphereWalker;
 
-use super::{extension::infer_content_type, paths::SpherePaths, workspace::Workspace};
+use super::{
+    extension::infer_content_type,
+    paths::SpherePaths,
+    stat_cache::{FileStat, StatCache},
+    workspace::Workspace,
+};
 
 /// Metadata that identifies some sphere content that is present on the file
 /// system
@@ -54,6 +70,9 @@ pub struct Content {
     pub matched: BTreeMap<String, FileReference>,
     /// Content in the workspace that has been ignored
     pub ignored: BTreeSet<String>,
+    /// The paths of matched content that was recognized as unchanged from
+    /// the stat cache, and so was not chunked into the store
+    pub unread: BTreeMap<String, PathBuf>,
 }
 
 impl Content {
@@ -78,100 +97,221 @@ impl Content {
         Ok(builder.build()?)
     }
 
+    /// Returns true if the file or directory at `relative_path` (relative to
+    /// the workspace root), or any directory that contains it, is ignored
+    /// when considering the files that make up the local workspace
+    pub fn is_ignored(relative_path: &Path) -> Result<bool> {
+        let ignore_patterns = Content::get_ignored_patterns()?;
+
+        Ok(relative_path
+            .ancestors()
+            .filter(|path| !path.as_os_str().is_empty())
+            .any(|path| ignore_patterns.is_match(path)))
+    }
+
+    /// The slug of the workspace file at `relative_path` (relative to the
+    /// workspace root), or `None` if the file's path does not make for a
+    /// valid slug
+    pub fn slug_for(relative_path: &Path) -> Option<String> {
+        let name = relative_path.file_stem()?.to_string_lossy();
+
+        let name = match relative_path
+            .parent()
+            .filter(|prefix| !prefix.as_os_str().is_empty())
+        {
+            Some(prefix) => format!("{}/{name}", prefix.to_string_lossy()),
+            None => name.to_string(),
+        };
+
+        match to_slug(&name) {
+            Ok(slug) if slug == name => Some(slug),
+            _ => None,
+        }
+    }
+
     /// Read the local content of the workspace in its entirety.
-    /// This includes files that have not yet been saved to the sphere. All
-    /// files are chunked into blocks, and those blocks are persisted to the
-    /// provided store.
-    // TODO(#556): This is slow; we could probably do a concurrent traversal
-    // similar to how we traverse when rendering files to disk
-    pub async fn read_all<S: BlockStore>(paths: &SpherePaths, store: &mut S) -> Result<Content> {
-        let root_path = paths.root();
-        let mut directories = vec![(None, tokio::fs::read_dir(root_path).await?)];
+    /// This includes files that have not yet been saved to the sphere. Files
+    /// are chunked into blocks, and those blocks are persisted to the
+    /// provided store; files whose size, modification time and inode match
+    /// the workspace's [StatCache] are not read at all, and are recorded in
+    /// [Content::unread] instead (see [Content::read_unread]).
+    ///
+    /// Directories are enumerated concurrently, up to
+    /// [MAX_CONCURRENT_FILE_READS] files are read at once, and chunking is
+    /// done on blocking threads (see [Content::read_file]).
+    pub async fn read_all<S: BlockStore + 'static>(
+        paths: &SpherePaths,
+        store: &S,
+    ) -> Result<Content> {
+        let root_path = Arc::new(paths.root().to_owned());
+        let ignore_patterns = Arc::new(Content::get_ignored_patterns()?);
+        let readers = Arc::new(Semaphore::new(MAX_CONCURRENT_FILE_READS));
 
-        let ignore_patterns = Content::get_ignored_patterns()?;
         let mut content = Content::default();
+        let mut stat_cache = StatCache::load(paths.stat_cache()).await;
 
-        while let Some((slug_prefix, mut directory)) = directories.pop() {
-            while let Some(entry) = directory.next_entry().await? {
-                let path = entry.path();
-                let relative_path = diff_paths(&path, root_path)
-                    .ok_or_else(|| anyhow!("Could not determine relative path to {:?}", path))?;
-
-                if ignore_patterns.is_match(&relative_path) {
-                    continue;
-                }
+        let mut scans = JoinSet::<Result<ScannedDirectory>>::new();
+        let mut reads = JoinSet::<Result<ReadFile>>::new();
 
-                if path.is_dir() {
-                    let slug_prefix = relative_path.to_string_lossy().to_string();
+        scans.spawn(scan_directory(
+            root_path.clone(),
+            root_path.to_path_buf(),
+            ignore_patterns.clone(),
+        ));
 
-                    directories.push((Some(slug_prefix), tokio::fs::read_dir(path).await?));
+        loop {
+            select! {
+                Some(scanned) = scans.join_next() => {
+                    let ScannedDirectory { directories, files } = scanned??;
 
                     // TODO(#557): Limit the depth of the directory traversal to
                     // some reasonable number
+                    for directory in directories {
+                        scans.spawn(scan_directory(
+                            root_path.clone(),
+                            directory,
+                            ignore_patterns.clone(),
+                        ));
+                    }
 
-                    continue;
+                    for file in files {
+                        let ignored = false;
+
+                        let slug = match Content::slug_for(&file.relative_path) {
+                            Some(slug) => slug,
+                            None => continue,
+                        };
+
+                        if ignored {
+                            content.ignored.insert(slug);
+                            continue;
+                        }
+
+                        let cache_key = file.relative_path.to_string_lossy().to_string();
+                        let stat = FileStat::from_metadata(&file.metadata);
+
+                        if let Some((body_cid, content_type)) = stat
+                            .as_ref()
+                            .and_then(|stat| stat_cache.get(&cache_key, stat))
+                        {
+                            let extension = file
+                                .path
+                                .extension()
+                                .map(|extension| String::from(extension.to_string_lossy()));
+
+                            content.unread.insert(slug.clone(), file.path);
+                            content.matched.insert(
+                                slug,
+                                FileReference {
+                                    cid: body_cid,
+                                    content_type,
+                                    extension,
+                                },
+                            );
+                            continue;
+                        }
+
+                        let store = store.clone();
+                        let readers = readers.clone();
+
+                        reads.spawn(async move {
+                            let _reading = readers.acquire_owned().await?;
+                            let reference = Content::read_file(&file.path, &store).await?;
+
+                            Ok(ReadFile {
+                                slug,
+                                cache_key,
+                                stat,
+                                reference,
+                            })
+                        });
+                    }
                 }
+                Some(read) = reads.join_next() => {
+                    let ReadFile { slug, cache_key, stat, reference } = read??;
+
+                    if let Some(stat) = stat {
+                        stat_cache.insert(
+                            &cache_key,
+                            stat,
+                            &reference.cid,
+                            &reference.content_type,
+                        );
+                    }
 
-                let ignored = false;
-
-                let name = match path.file_stem() {
-                    Some(name) => name.to_string_lossy(),
-                    None => continue,
-                };
-
-                let name = match &slug_prefix {
-                    Some(prefix) => format!("{prefix}/{name}"),
-                    None => name.to_string(),
-                };
+                    content.matched.insert(slug, reference);
+                }
+                else => break
+            }
+        }
 
-                let slug = match to_slug(&name) {
-                    Ok(slug) if slug == name => slug,
-                    _ => continue,
-                };
+        if let Err(error) = stat_cache.save().await {
+            warn!("Could not save the workspace stat cache: {}", error);
+        }
 
-                if ignored {
-                    content.ignored.insert(slug);
-                    continue;
-                }
+        Ok(content)
+    }
 
-                let extension = path
-                    .extension()
-                    .map(|extension| String::from(extension.to_string_lossy()));
-
-                let content_type = match &extension {
-                    Some(extension) => infer_content_type(extension).await?,
-                    None => ContentType::Bytes,
-                };
-
-                let file_bytes = fs::read(path).await?;
-                let body_cid = BodyChunkIpld::store_bytes(&file_bytes, store).await?;
-
-                content.matched.insert(
-                    slug,
-                    FileReference {
-                        cid: body_cid,
-                        content_type,
-                        extension,
-                    },
-                );
+    /// Read and chunk the files in [Content::unread] whose slugs are in
+    /// `slugs`, so that their blocks are in the provided store.
+    pub async fn read_unread<'a, S, I>(&mut self, slugs: I, store: &S) -> Result<()>
+    where
+        S: BlockStore + 'static,
+        I: IntoIterator<Item = &'a String>,
+    {
+        for slug in slugs {
+            let path = match self.unread.remove(slug) {
+                Some(path) => path,
+                None => continue,
+            };
+            let body_cid = chunk_file(&path, store.clone()).await?;
+
+            if let Some(file) = self.matched.get_mut(slug) {
+                // The file changed since it was cached, but within the same
+                // timestamp; the freshly chunked contents win
+                file.cid = body_cid;
             }
         }
 
-        Ok(content)
+        Ok(())
+    }
+
+    /// Read the workspace file at `path` and chunk it into blocks that are
+    /// written to `store`. Chunking is done on a blocking thread; no more
+    /// files are chunked at once (across all callers) than there are
+    /// available cores.
+    pub async fn read_file<S: BlockStore + 'static>(
+        path: &Path,
+        store: &S,
+    ) -> Result<FileReference> {
+        let extension = path
+            .extension()
+            .map(|extension| String::from(extension.to_string_lossy()));
+        let content_type = match &extension {
+            Some(extension) => infer_content_type(extension).await?,
+            None => ContentType::Bytes,
+        };
+        let cid = chunk_file(path, store.clone()).await?;
+
+        Ok(FileReference {
+            cid,
+            content_type,
+            extension,
+        })
     }
 
     /// Read all changed content in the sphere's workspace. Changed content will
     /// include anything that has been modified, moved or deleted. The blocks
-    /// associated with the changed content will be included in the returned
-    /// [MemoryStore].
-    pub async fn read_changes(
+    /// associated with the changed content are written to `store` as they
+    /// are produced; this is the sphere's storage when the changes are about
+    /// to be saved, and a scratch store (e.g. a [noosphere_storage::MemoryStore])
+    /// when they are only being inspected, so that the blocks of unsaved
+    /// files are not left behind in the sphere's storage.
+    pub async fn read_changes<S: BlockStore + 'static>(
         workspace: &Workspace,
-    ) -> Result<Option<(Content, ContentChanges, MemoryStore)>> {
-        // TODO(#556): We need a better strategy than reading all changed
-        // content into memory at once
-        let mut new_blocks = MemoryStore::default();
-        let file_content =
-            Content::read_all(workspace.require_sphere_paths()?, &mut new_blocks).await?;
+        store: &S,
+    ) -> Result<Option<(Content, ContentChanges)>> {
+        let mut file_content = Content::read_all(workspace.require_sphere_paths()?, store).await?;
 
         let sphere_context = workspace.sphere_context().await?;
         let walker = SphereWalker::from(&sphere_context);
@@ -220,10 +360,113 @@ impl Content {
             changes.new.insert(slug.clone(), Some(content_type.clone()));
         }
 
+        // Content that is about to be saved needs its blocks, even if it was
+        // recognized from the stat cache (e.g. because it was new the last
+        // time that the workspace was read)
+        let to_save: Vec<String> = changes
+            .new
+            .keys()
+            .chain(changes.updated.keys())
+            .cloned()
+            .collect();
+        file_content.read_unread(to_save.iter(), store).await?;
+
         if changes.is_empty() {
             Ok(None)
         } else {
-            Ok(Some((file_content, changes, new_blocks)))
+            Ok(Some((file_content, changes)))
         }
     }
 }
+
+/// How many workspace files [Content::read_all] may be reading (and holding
+/// in memory) at once
+const MAX_CONCURRENT_FILE_READS: usize = 64;
+
+/// A file found while scanning a workspace directory
+struct ScannedFile {
+    path: PathBuf,
+    relative_path: PathBuf,
+    metadata: Metadata,
+}
+
+/// The entries of a workspace directory that were not ignored
+#[derive(Default)]
+struct ScannedDirectory {
+    directories: Vec<PathBuf>,
+    files: Vec<ScannedFile>,
+}
+
+/// A file that [Content::read_all] has read and chunked
+struct ReadFile {
+    slug: String,
+    cache_key: String,
+    stat: Option<FileStat>,
+    reference: FileReference,
+}
+
+async fn scan_directory(
+    root_path: Arc<PathBuf>,
+    directory: PathBuf,
+    ignore_patterns: Arc<GlobSet>,
+) -> Result<ScannedDirectory> {
+    let mut entries = fs::read_dir(&directory).await?;
+    let mut scanned = ScannedDirectory::default();
+
+    while let Some(entry) = entries.next_entry().await? {
+        let path = entry.path();
+        let relative_path = diff_paths(&path, root_path.as_path())
+            .ok_or_else(|| anyhow!("Could not determine relative path to {:?}", path))?;
+
+        if ignore_patterns.is_match(&relative_path) {
+            continue;
+        }
+
+        let metadata = fs::metadata(&path).await?;
+
+        if metadata.is_dir() {
+            scanned.directories.push(path);
+            continue;
+        }
+
+        scanned.files.push(ScannedFile {
+            path,
+            relative_path,
+            metadata,
+        });
+    }
+
+    Ok(scanned)
+}
+
+/// Limits how many files are chunked at once (each on a blocking thread) to
+/// the number of available cores
+fn chunking_permits() -> &'static Semaphore {
+    static CHUNKERS: OnceLock<Semaphore> = OnceLock::new();
+
+    CHUNKERS.get_or_init(|| {
+        Semaphore::new(
+            available_parallelism()
+                .map(|parallelism| parallelism.get())
+                .unwrap_or(1),
+        )
+    })
+}
+
+/// Read the file at `path` and chunk it into blocks that are written to
+/// `store`, returning the [Cid] of its body
+async fn chunk_file<S: BlockStore + 'static>(path: &Path, mut store: S) -> Result<Cid> {
+    let bytes = fs::read(path).await?;
+
+    let (body_cid, blocks) = {
+        let _chunking = chunking_permits().acquire().await?;
+        spawn_blocking(move || BodyChunkIpld::encode_bytes(&bytes)).await??
+    };
+
+    for (cid, block) in blocks {
+        store.put_block(&cid, &block).await?;
+        store.put_links::<DagCborCodec>(&cid, &block).await?;
+    }
+
+    Ok(body_cid)
+}
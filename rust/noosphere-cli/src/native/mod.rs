@@ -5,13 +5,18 @@ pub mod commands;
 pub mod content;
 pub mod extension;
 pub mod paths;
+pub mod profile;
 pub mod render;
+pub mod stat_cache;
 pub mod workspace;
 
 #[cfg(any(test, feature = "helpers"))]
 pub mod helpers;
 
-use std::path::{Path, PathBuf};
+use std::{
+    path::{Path, PathBuf},
+    time::Duration,
+};
 
 use self::{
     cli::{AuthCommand, Cli, ConfigCommand, FollowCommand, KeyCommand, OrbCommand, SphereCommand},
@@ -23,11 +28,13 @@ use self::{
             follow_remove, follow_rename, history, save, sphere_create, sphere_join, status, sync,
         },
     },
+    paths::SpherePaths,
+    profile::{Profiler, PROFILES_DIRECTORY},
     workspace::Workspace,
 };
 use anyhow::Result;
 use clap::Parser;
-use noosphere_core::tracing::initialize_tracing;
+use noosphere_core::tracing::{initialize_tracing, initialize_tracing_with_unfiltered_layer};
 use noosphere_storage::StorageConfig;
 use vergen_pretty::{vergen_pretty_env, PrettyBuilder};
 
@@ -42,12 +49,38 @@ pub struct CliContext<'a> {
 #[cfg(not(doc))]
 #[allow(missing_docs)]
 pub async fn main() -> Result<()> {
-    initialize_tracing(None);
+    let cli = Cli::parse();
+    let profiler = if cli.profile {
+        let profiler = Profiler::default();
+        initialize_tracing_with_unfiltered_layer(None, profiler.layer());
+        Some(profiler)
+    } else {
+        initialize_tracing(None);
+        None
+    };
+
     let context = CliContext {
         cwd: std::env::current_dir()?,
         global_config_directory: None,
     };
-    invoke_cli(Cli::parse(), &context).await
+    let result = invoke_cli(cli, &context).await;
+
+    if let Some(profiler) = profiler {
+        // The command may have created or joined a sphere, so look for the
+        // workspace only after it has finished
+        let directory = match SpherePaths::discover(Some(&context.cwd)) {
+            Some(paths) => paths.sphere().join(PROFILES_DIRECTORY),
+            None => context.cwd.clone(),
+        };
+        let command = std::env::args().skip(1).collect::<Vec<_>>().join(" ");
+
+        match profiler.write_report(&directory, &command) {
+            Ok(path) => info!("Wrote profile to {}", path.display()),
+            Err(error) => warn!("Failed to write profile: {}", error),
+        }
+    }
+
+    result
 }
 
 /// Invoke the CLI implementation imperatively.
@@ -136,12 +169,16 @@ pub async fn invoke_cli_with_workspace(cli: Cli, mut workspace: Workspace) -> Re
                 ConfigCommand::Get { command } => config_get(command, &workspace).await?,
             },
 
-            SphereCommand::Status { id } => status(id, &workspace).await?,
+            SphereCommand::Status { id, storage } => status(id, storage, &workspace).await?,
             SphereCommand::Save { render_depth } => save(render_depth, &workspace).await?,
             SphereCommand::Sync {
                 auto_retry,
                 render_depth,
             } => sync(auto_retry, render_depth, &workspace).await?,
+            SphereCommand::Watch {
+                debounce_ms,
+                render_depth,
+            } => watch(Duration::from_millis(debounce_ms), render_depth, &workspace).await?,
             SphereCommand::Follow { command } => match command {
                 FollowCommand::Add { name, sphere_id } => {
                     follow_add(name, sphere_id, &workspace).await?;
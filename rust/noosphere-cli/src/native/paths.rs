@@ -25,6 +25,7 @@ pub(crate) const VERSION_FILE: &str = "version";
 pub(crate) const IDENTITY_FILE: &str = "identity";
 pub(crate) const DEPTH_FILE: &str = "depth";
 pub(crate) const LINK_RECORD_FILE: &str = "link_record";
+pub(crate) const STAT_CACHE_FILE: &str = "stat_cache";
 
 /// [SpherePaths] record the critical paths within a sphere workspace as
 /// rendered to a typical file system. It is used to ensure that we read from
@@ -57,6 +58,7 @@ pub struct SpherePaths {
     version: PathBuf,
     identity: PathBuf,
     depth: PathBuf,
+    stat_cache: PathBuf,
 }
 
 impl Debug for SpherePaths {
@@ -86,6 +88,7 @@ impl SpherePaths {
             version: sphere.join(VERSION_FILE),
             identity: sphere.join(IDENTITY_FILE),
             depth: sphere.join(DEPTH_FILE),
+            stat_cache: sphere.join(STAT_CACHE_FILE),
             sphere,
         }
     }
@@ -145,6 +148,12 @@ impl SpherePaths {
         &self.depth
     }
 
+    /// The path to the cache of workspace file metadata within the local
+    /// [SPHERE_DIRECTORY]; see [crate::stat_cache::StatCache]
+    pub fn stat_cache(&self) -> &Path {
+        &self.stat_cache
+    }
+
     /// The path to the workspace root directory, which contains a
     /// [SPHERE_DIRECTORY]
     pub fn root(&self) -> &Path {
@@ -0,0 +1,290 @@
+//! A built-in profiling mode for orb commands, enabled with the global
+//! `--profile` flag. While profiling, the wall time, busy time and CPU time of
+//! every Noosphere `tracing` span (such as `handshake`, `fetch_remote_changes`,
+//! `hydrate_timeslice`, `rebase`, `push_local_changes` and the render jobs) is
+//! recorded, regardless of the configured log level. When the command
+//! finishes, a report is written to the workspace's `.sphere/profiles`
+//! directory that can be attached to bug reports:
+//!
+//! - `<name>.json`: per-span totals, in milliseconds
+//! - `<name>.folded`: the busy time of each span stack, in microseconds, as
+//!   "folded" stacks that can be rendered with `inferno-flamegraph` or
+//!   `flamegraph.pl`
+
+use anyhow::Result;
+use serde_json::json;
+use std::{
+    collections::BTreeMap,
+    fmt::Write as _,
+    path::{Path, PathBuf},
+    sync::{Arc, Mutex},
+    time::{Duration, Instant, SystemTime, UNIX_EPOCH},
+};
+use tracing::{span, Subscriber};
+use tracing_subscriber::{
+    filter::{LevelFilter, Targets},
+    layer::Context,
+    registry::LookupSpan,
+    Layer, Registry,
+};
+
+/// The directory within the `.sphere` directory that profiles are written to
+pub const PROFILES_DIRECTORY: &str = "profiles";
+
+/// Spans from crates whose names start with this prefix are profiled
+const PROFILED_TARGET: &str = "noosphere";
+
+/// The most verbose spans that are profiled
+const PROFILED_LEVEL: LevelFilter = LevelFilter::DEBUG;
+
+#[derive(Debug, Default, Clone)]
+struct SpanTotals {
+    count: u64,
+    wall: Duration,
+    busy: Duration,
+    cpu: Duration,
+}
+
+#[derive(Debug, Default)]
+struct Recording {
+    spans: BTreeMap<&'static str, SpanTotals>,
+    stacks: BTreeMap<String, Duration>,
+}
+
+/// Timing state that is kept in the extensions of each profiled span
+struct SpanTiming {
+    opened: Instant,
+    entered: Option<(Instant, Option<Duration>)>,
+    busy: Duration,
+    cpu: Duration,
+    children_busy: Duration,
+}
+
+impl SpanTiming {
+    fn new() -> Self {
+        SpanTiming {
+            opened: Instant::now(),
+            entered: None,
+            busy: Duration::ZERO,
+            cpu: Duration::ZERO,
+            children_busy: Duration::ZERO,
+        }
+    }
+}
+
+/// The CPU time consumed so far by the current thread. A span is always
+/// entered and exited on the same thread, so the difference between two
+/// readings is the CPU time spent in the span while it was entered.
+#[cfg(unix)]
+fn thread_cpu_time() -> Option<Duration> {
+    let mut time = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    // SAFETY: `time` is a valid timespec for the duration of the call
+    let result = unsafe { libc::clock_gettime(libc::CLOCK_THREAD_CPUTIME_ID, &mut time) };
+
+    (result == 0).then(|| Duration::new(time.tv_sec as u64, time.tv_nsec as u32))
+}
+
+#[cfg(not(unix))]
+fn thread_cpu_time() -> Option<Duration> {
+    None
+}
+
+/// Records timings for the spans of a single orb command. Use
+/// [Profiler::layer] to install it when tracing is initialized, and
+/// [Profiler::write_report] once the command has finished.
+#[derive(Clone)]
+pub struct Profiler {
+    started: Instant,
+    recording: Arc<Mutex<Recording>>,
+}
+
+impl Default for Profiler {
+    fn default() -> Self {
+        Profiler {
+            started: Instant::now(),
+            recording: Default::default(),
+        }
+    }
+}
+
+impl Profiler {
+    /// A [Layer] that records span timings into this [Profiler]. It applies
+    /// its own filter, so it should be installed with
+    /// `initialize_tracing_with_unfiltered_layer` to observe spans that are
+    /// more verbose than the log level.
+    pub fn layer(&self) -> impl Layer<Registry> + Send + Sync {
+        ProfileLayer {
+            recording: self.recording.clone(),
+        }
+        .with_filter(Targets::new().with_target(PROFILED_TARGET, PROFILED_LEVEL))
+    }
+
+    /// Write the JSON report and folded stacks for `command` to `directory`,
+    /// returning the path of the JSON report
+    pub fn write_report(&self, directory: &Path, command: &str) -> Result<PathBuf> {
+        let recording = self.recording.lock().unwrap();
+        let wall = self.started.elapsed();
+        let timestamp = SystemTime::now().duration_since(UNIX_EPOCH)?.as_millis();
+        let name = format!("orb-{timestamp}");
+
+        let spans = recording
+            .spans
+            .iter()
+            .map(|(name, totals)| {
+                (
+                    *name,
+                    json!({
+                        "count": totals.count,
+                        "wall_ms": totals.wall.as_secs_f64() * 1000.0,
+                        "busy_ms": totals.busy.as_secs_f64() * 1000.0,
+                        "cpu_ms": totals.cpu.as_secs_f64() * 1000.0,
+                    }),
+                )
+            })
+            .collect::<BTreeMap<_, _>>();
+
+        let mut folded = String::new();
+
+        for (stack, busy) in recording.stacks.iter() {
+            writeln!(folded, "{} {}", stack, busy.as_micros())?;
+        }
+
+        std::fs::create_dir_all(directory)?;
+
+        let report_path = directory.join(format!("{name}.json"));
+        let folded_path = directory.join(format!("{name}.folded"));
+
+        std::fs::write(
+            &report_path,
+            serde_json::to_string_pretty(&json!({
+                "command": command,
+                "version": env!("CARGO_PKG_VERSION"),
+                "wall_ms": wall.as_secs_f64() * 1000.0,
+                "spans": spans,
+                "folded_stacks": folded_path.file_name().map(|name| name.to_string_lossy()),
+            }))?,
+        )?;
+        std::fs::write(&folded_path, folded)?;
+
+        Ok(report_path)
+    }
+}
+
+struct ProfileLayer {
+    recording: Arc<Mutex<Recording>>,
+}
+
+impl<S> Layer<S> for ProfileLayer
+where
+    S: Subscriber + for<'a> LookupSpan<'a>,
+{
+    fn on_new_span(&self, _attributes: &span::Attributes<'_>, id: &span::Id, ctx: Context<'_, S>) {
+        if let Some(span) = ctx.span(id) {
+            span.extensions_mut().insert(SpanTiming::new());
+        }
+    }
+
+    fn on_enter(&self, id: &span::Id, ctx: Context<'_, S>) {
+        if let Some(span) = ctx.span(id) {
+            if let Some(timing) = span.extensions_mut().get_mut::<SpanTiming>() {
+                timing.entered = Some((Instant::now(), thread_cpu_time()));
+            }
+        }
+    }
+
+    fn on_exit(&self, id: &span::Id, ctx: Context<'_, S>) {
+        if let Some(span) = ctx.span(id) {
+            if let Some(timing) = span.extensions_mut().get_mut::<SpanTiming>() {
+                if let Some((entered, entered_cpu)) = timing.entered.take() {
+                    timing.busy += entered.elapsed();
+
+                    if let (Some(entered_cpu), Some(exited_cpu)) = (entered_cpu, thread_cpu_time())
+                    {
+                        timing.cpu += exited_cpu.saturating_sub(entered_cpu);
+                    }
+                }
+            }
+        }
+    }
+
+    fn on_close(&self, id: span::Id, ctx: Context<'_, S>) {
+        let Some(span) = ctx.span(&id) else {
+            return;
+        };
+        let Some(timing) = span.extensions_mut().remove::<SpanTiming>() else {
+            return;
+        };
+
+        if let Some(parent) = span.parent() {
+            if let Some(parent_timing) = parent.extensions_mut().get_mut::<SpanTiming>() {
+                parent_timing.children_busy += timing.busy;
+            }
+        }
+
+        let stack = span
+            .scope()
+            .from_root()
+            .map(|span| span.name())
+            .collect::<Vec<_>>()
+            .join(";");
+
+        let mut recording = self.recording.lock().unwrap();
+        let totals = recording.spans.entry(span.name()).or_default();
+
+        totals.count += 1;
+        totals.wall += timing.opened.elapsed();
+        totals.busy += timing.busy;
+        totals.cpu += timing.cpu;
+
+        *recording.stacks.entry(stack).or_default() +=
+            timing.busy.saturating_sub(timing.children_busy);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::Profiler;
+    use tracing_subscriber::layer::SubscriberExt;
+
+    #[test]
+    fn it_records_span_timings_and_folded_stacks() {
+        let profiler = Profiler::default();
+        let subscriber = tracing_subscriber::registry().with(profiler.layer());
+
+        tracing::subscriber::with_default(subscriber, || {
+            let outer = tracing::debug_span!(target: "noosphere_cli::test", "sync");
+            let _outer = outer.enter();
+
+            for _ in 0..2 {
+                let inner = tracing::debug_span!(target: "noosphere_cli::test", "handshake");
+                let _inner = inner.enter();
+            }
+
+            let ignored = tracing::debug_span!(target: "hyper", "ignored");
+            let _ignored = ignored.enter();
+        });
+
+        let directory = tempfile::TempDir::new().unwrap();
+        let report_path = profiler
+            .write_report(directory.path(), "sphere sync")
+            .unwrap();
+        let report: serde_json::Value =
+            serde_json::from_str(&std::fs::read_to_string(&report_path).unwrap()).unwrap();
+
+        assert_eq!(report["command"], "sphere sync");
+        assert_eq!(report["spans"]["sync"]["count"], 1);
+        assert_eq!(report["spans"]["handshake"]["count"], 2);
+        assert!(report["spans"].get("ignored").is_none());
+
+        let folded = std::fs::read_to_string(report_path.with_extension("folded")).unwrap();
+        let stacks = folded
+            .lines()
+            .filter_map(|line| line.rsplit_once(' ').map(|(stack, _)| stack))
+            .collect::<Vec<_>>();
+
+        assert_eq!(stacks, vec!["sync", "sync;handshake"]);
+    }
+}
@@ -0,0 +1,233 @@
+use anyhow::{anyhow, Result};
+use std::{
+    collections::HashMap,
+    path::{Path, PathBuf},
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc, Mutex,
+    },
+};
+use tokio::{
+    fs::File,
+    io::{copy, AsyncRead},
+    sync::{OnceCell, Semaphore},
+};
+
+/// How many content files may be written (or synced) at once
+const MAX_CONCURRENT_CONTENT_WRITES: usize = 64;
+
+/// A [RenderIo] schedules the content writes of every [super::SphereRenderJob]
+/// that is part of a single render, so that they can be issued concurrently
+/// without ever writing the same file twice:
+///
+/// - Content is materialized at most once per path (and so, per content
+///   [cid::Cid] for peers), no matter how many jobs ask for it at once; later
+///   requests wait on the write that is in flight
+/// - Up to [MAX_CONCURRENT_CONTENT_WRITES] files are written at once
+/// - Each file is written to a staging file that is then renamed into place,
+///   so a file that exists is always complete
+/// - Written files are made durable in one batch by [RenderIo::flush], rather
+///   than one `fsync` at a time
+#[derive(Debug)]
+pub struct RenderIo {
+    writes: Semaphore,
+    in_flight: Mutex<HashMap<PathBuf, Arc<OnceCell<()>>>>,
+    written: Mutex<Vec<PathBuf>>,
+    staging_counter: AtomicU64,
+}
+
+impl Default for RenderIo {
+    fn default() -> Self {
+        RenderIo {
+            writes: Semaphore::new(MAX_CONCURRENT_CONTENT_WRITES),
+            in_flight: Default::default(),
+            written: Default::default(),
+            staging_counter: Default::default(),
+        }
+    }
+}
+
+impl RenderIo {
+    /// Write `contents` to a file at `path`, unless a file already exists
+    /// there (or is being written there by another job). Returns true if the
+    /// file was written by this call.
+    pub async fn materialize<R>(&self, path: &Path, contents: &mut R) -> Result<bool>
+    where
+        R: AsyncRead + Unpin,
+    {
+        if tokio::fs::try_exists(path).await? {
+            return Ok(false);
+        }
+
+        let write = self
+            .in_flight
+            .lock()
+            .map_err(|_| anyhow!("Render I/O state is poisoned"))?
+            .entry(path.to_owned())
+            .or_default()
+            .clone();
+
+        let mut written = false;
+        let written_ref = &mut written;
+        let result = write
+            .get_or_try_init(move || async move {
+                if tokio::fs::try_exists(path).await? {
+                    return Ok(());
+                }
+
+                let _permit = self.writes.acquire().await?;
+                self.write_file(path, contents).await?;
+                *written_ref = true;
+
+                Ok::<_, anyhow::Error>(())
+            })
+            .await
+            .map(|_| ());
+
+        if let Ok(mut in_flight) = self.in_flight.lock() {
+            if in_flight
+                .get(path)
+                .map(|entry| Arc::ptr_eq(entry, &write))
+                .unwrap_or(false)
+            {
+                in_flight.remove(path);
+            }
+        }
+
+        result?;
+
+        Ok(written)
+    }
+
+    async fn write_file<R>(&self, path: &Path, contents: &mut R) -> Result<()>
+    where
+        R: AsyncRead + Unpin,
+    {
+        let file_name = path
+            .file_name()
+            .map(|name| name.to_string_lossy().to_string())
+            .unwrap_or_default();
+        let staging_path = path.with_file_name(format!(
+            ".{file_name}.{}.render",
+            self.staging_counter.fetch_add(1, Ordering::Relaxed)
+        ));
+
+        let result = async {
+            let mut file = File::create(&staging_path).await?;
+            copy(contents, &mut file).await?;
+            tokio::fs::rename(&staging_path, path).await?;
+            Ok::<_, anyhow::Error>(())
+        }
+        .await;
+
+        if result.is_err() {
+            let _ = tokio::fs::remove_file(&staging_path).await;
+        }
+
+        result?;
+
+        if let Ok(mut written) = self.written.lock() {
+            written.push(path.to_owned());
+        }
+
+        Ok(())
+    }
+
+    /// Make every file written so far durable. On Linux this is a single
+    /// `syncfs` of the file system that holds them; elsewhere the files are
+    /// synced concurrently.
+    pub async fn flush(&self) -> Result<()> {
+        let written = match self.written.lock() {
+            Ok(mut written) => std::mem::take(&mut *written),
+            Err(_) => return Ok(()),
+        };
+
+        if written.is_empty() {
+            return Ok(());
+        }
+
+        debug!("Syncing {} rendered files...", written.len());
+
+        #[cfg(target_os = "linux")]
+        {
+            use std::os::fd::AsRawFd;
+
+            let file = File::open(&written[0]).await?.into_std().await;
+
+            tokio::task::spawn_blocking(move || {
+                // SAFETY: the file descriptor is open for the duration of the call
+                match unsafe { libc::syncfs(file.as_raw_fd()) } {
+                    0 => Ok(()),
+                    _ => Err(std::io::Error::last_os_error()),
+                }
+            })
+            .await??;
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        {
+            use tokio::task::JoinSet;
+
+            let permits = Arc::new(Semaphore::new(MAX_CONCURRENT_CONTENT_WRITES));
+            let mut syncs = JoinSet::<Result<()>>::new();
+
+            for path in written {
+                let permits = permits.clone();
+                syncs.spawn(async move {
+                    let _permit = permits.acquire().await?;
+                    File::open(&path).await?.sync_all().await?;
+                    Ok(())
+                });
+            }
+
+            while let Some(result) = syncs.join_next().await {
+                result??;
+            }
+        }
+
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::RenderIo;
+    use anyhow::Result;
+    use std::sync::Arc;
+    use tokio::task::JoinSet;
+
+    #[tokio::test]
+    async fn it_writes_each_path_once() -> Result<()> {
+        let directory = tempfile::tempdir()?;
+        let path = directory.path().join("content");
+        let io = Arc::new(RenderIo::default());
+        let mut writes = JoinSet::new();
+
+        for index in 0..16u8 {
+            let io = io.clone();
+            let path = path.clone();
+            writes.spawn(async move {
+                let contents = vec![index; 4096];
+                io.materialize(&path, &mut contents.as_slice()).await
+            });
+        }
+
+        let mut written = 0;
+        while let Some(result) = writes.join_next().await {
+            if result?? {
+                written += 1;
+            }
+        }
+
+        assert_eq!(written, 1);
+
+        let contents = tokio::fs::read(&path).await?;
+        assert_eq!(contents.len(), 4096);
+        assert!(contents.iter().all(|byte| *byte == contents[0]));
+        assert_eq!(std::fs::read_dir(directory.path())?.count(), 1);
+
+        io.flush().await?;
+
+        Ok(())
+    }
+}
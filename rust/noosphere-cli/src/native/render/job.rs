@@ -7,12 +7,15 @@ use noosphere_core::context::{
     SphereWalker,
 };
 use noosphere_core::data::{Did, Link, LinkRecord, MemoIpld};
-use noosphere_storage::Storage;
-use std::{marker::PhantomData, sync::Arc};
+use noosphere_storage::{with_io_operation, Storage};
+use std::{collections::BTreeSet, marker::PhantomData, sync::Arc};
 use tokio::sync::mpsc::Sender;
 use tokio_stream::StreamExt;
 
-use crate::native::{paths::SpherePaths, render::ChangeBuffer};
+use crate::native::{
+    paths::SpherePaths,
+    render::{ChangeBuffer, RenderIo},
+};
 
 use super::writer::SphereWriter;
 
@@ -75,18 +78,20 @@ where
     S: Storage + 'static,
 {
     /// Construct a new render job of [JobKind], using the given [HasSphereContext] and
-    /// [SpherePaths] to perform rendering.
+    /// [SpherePaths] to perform rendering, and the [RenderIo] that is shared by
+    /// all of the render's jobs to write content.
     pub fn new(
         context: C,
         kind: JobKind,
         paths: Arc<SpherePaths>,
+        io: Arc<RenderIo>,
         petname_path: Vec<String>,
         job_queue: Sender<SphereRenderRequest>,
     ) -> Self {
         SphereRenderJob {
             context,
             petname_path,
-            writer: SphereWriter::new(kind.clone(), paths),
+            writer: SphereWriter::new(kind.clone(), paths, io),
             kind,
             storage_type: PhantomData,
             job_queue,
@@ -96,6 +101,22 @@ where
     /// Entrypoint to render based on the [SphereRenderJob] configuration
     #[instrument(level = "debug", skip(self))]
     pub async fn render(self) -> Result<()> {
+        self.run(false).await
+    }
+
+    /// Run the job, attributing all of its block I/O to rendering
+    async fn run(self, only_peers: bool) -> Result<()> {
+        with_io_operation("render", async move {
+            if only_peers {
+                self.render_only_peers().await
+            } else {
+                self.render_kind().await
+            }
+        })
+        .await
+    }
+
+    async fn render_kind(self) -> Result<()> {
         match self.kind {
             JobKind::Root { force_full_render } => {
                 info!("Rendering this sphere...");
@@ -142,6 +163,31 @@ where
         Ok(())
     }
 
+    /// Entrypoint to render just the peers of an already-rendered peer (for
+    /// example, because the render depth has increased since it was
+    /// rendered); its content, which cannot have changed at its version, is
+    /// left as it is
+    #[instrument(level = "debug", skip(self))]
+    pub async fn render_peers(self) -> Result<()> {
+        if !matches!(self.kind, JobKind::Peer(_, _, _)) {
+            return Err(anyhow!("Only peer render jobs can render just their peers"));
+        }
+
+        self.run(true).await
+    }
+
+    async fn render_only_peers(self) -> Result<()> {
+        debug!("Rendering peers of @{}...", self.petname_path.join("."));
+
+        match SphereCursor::latest(self.context.clone())
+            .traverse_by_petnames(&self.petname_path)
+            .await?
+        {
+            Some(context) => self.refresh_peers(context).await,
+            None => Err(anyhow!("No peer found at {}", self.petname_path.join("."))),
+        }
+    }
+
     fn paths(&self) -> &SpherePaths {
         self.writer.paths()
     }
@@ -237,80 +283,104 @@ where
         Ok(())
     }
 
+    /// Render only the net difference between the version of the root sphere
+    /// that was last rendered (`since`) and its latest version: slugs and
+    /// petnames that changed in between but ended up as they were are not
+    /// touched, and those that changed more than once are written once
     #[instrument(level = "debug", skip(self))]
     async fn incremental_render(&self, since: &Link<MemoIpld>) -> Result<()> {
+        let latest = SphereCursor::latest(self.context.clone());
+        let mut previous = SphereCursor::latest(self.context.clone());
+        previous.mount_at(since).await?;
+
+        let mut changed_slugs = BTreeSet::new();
         let content_change_stream =
             SphereWalker::from(&self.context).into_content_change_stream(Some(since));
-        let mut cursor = SphereCursor::latest(self.context.clone());
-        let mut content_change_buffer = ChangeBuffer::new(CONTENT_CHANGE_BUFFER_CAPACITY);
 
         tokio::pin!(content_change_stream);
 
-        while let Some((version, changes)) = content_change_stream.try_next().await? {
-            cursor.mount_at(&version).await?;
+        while let Some((_, mut changes)) = content_change_stream.try_next().await? {
+            changed_slugs.append(&mut changes);
+        }
+
+        let mut content_change_buffer = ChangeBuffer::new(CONTENT_CHANGE_BUFFER_CAPACITY);
 
-            for slug in changes {
-                trace!(version = ?version, slug = ?slug, "Buffering change...");
-                match cursor.read(&slug).await? {
-                    Some(file) => content_change_buffer.add(slug, file)?,
-                    None => content_change_buffer.remove(&slug)?,
-                }
+        for slug in changed_slugs {
+            let before = previous.read(&slug).await?.map(|file| file.memo_version);
 
-                if content_change_buffer.is_full() {
-                    content_change_buffer.flush_to_writer(&self.writer).await?;
+            match latest.read(&slug).await? {
+                Some(file) if Some(&file.memo_version) == before.as_ref() => {
+                    trace!(slug = ?slug, "Content is unchanged, skipping...");
+                    continue;
                 }
+                Some(file) => {
+                    trace!(slug = ?slug, "Buffering change...");
+                    content_change_buffer.add(slug, file)?
+                }
+                None if before.is_some() => content_change_buffer.remove(&slug)?,
+                None => continue,
+            }
+
+            if content_change_buffer.is_full() {
+                content_change_buffer.flush_to_writer(&self.writer).await?;
             }
         }
 
         content_change_buffer.flush_to_writer(&self.writer).await?;
 
+        let mut changed_petnames = BTreeSet::new();
         let petname_change_stream =
             SphereWalker::from(&self.context).into_petname_change_stream(Some(since));
-        let mut petname_change_buffer = ChangeBuffer::new(PETNAME_CHANGE_BUFFER_CAPACITY);
 
         tokio::pin!(petname_change_stream);
 
-        while let Some((version, changes)) = petname_change_stream.try_next().await? {
-            cursor.mount_at(&version).await?;
-
-            for petname in changes {
-                match cursor.get_petname(&petname).await? {
-                    Some(identity) => match cursor.get_petname_record(&petname).await? {
-                        Some(link_record) => {
-                            if let Some(version) = link_record.get_link() {
-                                petname_change_buffer
-                                    .add(petname.clone(), (identity.clone(), Cid::from(version)))?;
-
-                                let mut petname_path = self.petname_path.clone();
-                                petname_path.push(petname);
-                                self.job_queue
-                                    .send(SphereRenderRequest(
-                                        petname_path,
-                                        identity,
-                                        Cid::from(version),
-                                        link_record,
-                                    ))
-                                    .await?;
-                            } else {
-                                petname_change_buffer.remove(&petname)?;
-                            }
-                        }
-                        None => petname_change_buffer.remove(&petname)?,
-                    },
-                    None => petname_change_buffer.remove(&petname)?,
-                }
+        while let Some((_, mut changes)) = petname_change_stream.try_next().await? {
+            changed_petnames.append(&mut changes);
+        }
 
-                if petname_change_buffer.is_full() {
-                    petname_change_buffer.flush_to_writer(&self.writer).await?;
+        let mut petname_change_buffer = ChangeBuffer::new(PETNAME_CHANGE_BUFFER_CAPACITY);
+
+        for petname in changed_petnames {
+            let before = resolve_petname(&previous, &petname).await?;
+
+            match resolve_petname(&latest, &petname).await? {
+                Some((identity, version, _))
+                    if before
+                        .as_ref()
+                        .map(|(identity, version, _)| (identity, version))
+                        == Some((&identity, &version)) =>
+                {
+                    trace!(petname = ?petname, "Peer is unchanged, skipping...");
+                    continue;
+                }
+                Some((identity, version, link_record)) => {
+                    petname_change_buffer.add(petname.clone(), (identity.clone(), version))?;
+
+                    let mut petname_path = self.petname_path.clone();
+                    petname_path.push(petname);
+                    self.job_queue
+                        .send(SphereRenderRequest(
+                            petname_path,
+                            identity,
+                            version,
+                            link_record,
+                        ))
+                        .await?;
                 }
+                None if before.is_some() => petname_change_buffer.remove(&petname)?,
+                None => continue,
+            }
+
+            if petname_change_buffer.is_full() {
+                petname_change_buffer.flush_to_writer(&self.writer).await?;
             }
         }
 
         petname_change_buffer.flush_to_writer(&self.writer).await?;
 
         // Write out the latest version that was rendered
-        let identity = cursor.identity().await?;
-        let version = cursor.version().await?;
+        let identity = latest.identity().await?;
+        let version = latest.version().await?;
 
         self.writer
             .write_identity_and_version(&identity, &version)
@@ -319,3 +389,27 @@ where
         Ok(())
     }
 }
+
+/// The identity and resolved version of the peer at `petname` as of the
+/// cursor's version, along with the [LinkRecord] that the version was
+/// resolved from; `None` if there is no such peer or no version is resolved
+async fn resolve_petname<C, S>(
+    cursor: &SphereCursor<C, S>,
+    petname: &str,
+) -> Result<Option<(Did, Cid, LinkRecord)>>
+where
+    C: HasSphereContext<S> + 'static,
+    S: Storage + 'static,
+{
+    let identity = match cursor.get_petname(petname).await? {
+        Some(identity) => identity,
+        None => return Ok(None),
+    };
+
+    Ok(match cursor.get_petname_record(petname).await? {
+        Some(link_record) => link_record
+            .get_link()
+            .map(|version| (identity, Cid::from(version), link_record)),
+        None => None,
+    })
+}
@@ -2,11 +2,13 @@
 //! workspace on a file system.
 
 mod buffer;
+mod io;
 mod job;
 mod renderer;
 mod writer;
 
 pub use buffer::*;
+pub use io::*;
 pub use job::*;
 pub use renderer::*;
 pub use writer::*;
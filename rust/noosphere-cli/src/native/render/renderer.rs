@@ -5,7 +5,7 @@ use std::{collections::BTreeSet, marker::PhantomData, sync::Arc, thread::availab
 
 use tokio::{select, task::JoinSet};
 
-use super::{SphereRenderJob, SphereRenderRequest};
+use super::{RenderIo, SphereRenderJob, SphereRenderRequest};
 use crate::native::{
     paths::SpherePaths,
     render::{JobKind, SphereRenderJobId},
@@ -108,13 +108,16 @@ where
     /// Render the sphere graph up to the given depth; the renderer will attempt
     /// to render different edges from the root concurrently, efficiently and
     /// idempotently. If the specified render depth increases for a subsequent
-    /// render, all rendered peers will be reset and rendered again (although
-    /// the hard links to their content will remain unchanged).
+    /// render, peers that are already rendered keep their content as it is
+    /// (a peer's version never changes), and only have their own peers
+    /// rendered out to the new depth. Rendered peers are only reset and
+    /// rendered again when a full render is forced.
     #[instrument(level = "debug", skip(self))]
     pub async fn render(&self, depth: Option<u32>, force_full_render: bool) -> Result<()> {
         std::env::set_current_dir(self.paths.root())?;
 
         let mut render_jobs = JoinSet::<Result<()>>::new();
+        let io = Arc::new(RenderIo::default());
         let mut started_jobs = BTreeSet::<SphereRenderJobId>::new();
 
         let max_parallel_jobs = available_parallelism()?.get();
@@ -146,8 +149,14 @@ where
             // by the renderer in advance of queuing any work because we
             // cannot guarantee the order in which requests to render peers
             // may come in, and it could happen out-of-order with a "refresh
-            // peers" job that is running concurrently.
-            self.reset_peers().await?;
+            // peers" job that is running concurrently. A peer's rendered
+            // version never changes, so the reset is only needed when a full
+            // render is forced; if the render depth has increased, peers that
+            // are already rendered just have their own peers rendered (see
+            // below).
+            if force_full_render {
+                self.reset_peers().await?;
+            }
 
             debug!(
                 ?max_parallel_jobs,
@@ -161,6 +170,7 @@ where
                     self.context.clone(),
                     JobKind::RefreshPeers,
                     self.paths.clone(),
+                    io.clone(),
                     Vec::new(),
                     tx.clone(),
                 )
@@ -181,6 +191,7 @@ where
                 self.context.clone(),
                 JobKind::Root { force_full_render },
                 self.paths.clone(),
+                io.clone(),
                 Vec::new(),
                 tx.clone(),
             )
@@ -234,10 +245,25 @@ where
                             if self.paths.peer(&peer, &version).exists() {
                                 // TODO(#559): We may need to re-render if a previous
                                 // render was incomplete for some reason
-                                debug!(
-                                    "Content for {} @ {} is already rendered, skipping...",
-                                    peer, version
-                                );
+                                if force_render_peers {
+                                    debug!("Content for {peer} @ {version} is already rendered, rendering its peers...");
+
+                                    render_jobs.spawn(
+                                        SphereRenderJob::new(
+                                            self.context.clone(),
+                                            JobKind::Peer(peer, version, link_record),
+                                            self.paths.clone(),
+                                            io.clone(),
+                                            petname_path,
+                                            tx.clone()
+                                        ).render_peers()
+                                    );
+                                } else {
+                                    debug!(
+                                        "Content for {} @ {} is already rendered, skipping...",
+                                        peer, version
+                                    );
+                                }
                                 continue;
                             }
 
@@ -248,6 +274,7 @@ where
                                     self.context.clone(),
                                     JobKind::Peer(peer, version, link_record),
                                     self.paths.clone(),
+                                    io.clone(),
                                     petname_path,
                                     tx.clone()
                                 ).render()
@@ -258,6 +285,8 @@ where
             }
         }
 
+        io.flush().await?;
+
         tokio::fs::write(self.paths.depth(), render_depth.to_string()).await?;
 
         Ok(())
@@ -276,3 +305,151 @@ where
         Ok(())
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::SphereRenderer;
+    use crate::native::paths::SpherePaths;
+    use anyhow::Result;
+    use noosphere_core::{
+        authority::Access,
+        context::{HasMutableSphereContext, SphereContentWrite},
+        data::ContentType,
+        helpers::{make_sphere_context_with_peer_chain, simulated_sphere_context},
+    };
+    use std::{path::Path, sync::Arc};
+
+    async fn read_rendered(root: &Path, path: &str) -> Result<Option<String>> {
+        let path = root.join(path);
+
+        Ok(if tokio::fs::try_exists(&path).await? {
+            Some(tokio::fs::read_to_string(&path).await?)
+        } else {
+            None
+        })
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn it_renders_the_net_changes_of_several_revisions() -> Result<()> {
+        let root = tempfile::tempdir()?;
+        let paths = Arc::new(SpherePaths::initialize(root.path()).await?);
+        let (mut context, _) = simulated_sphere_context(Access::ReadWrite, None).await?;
+        let renderer = SphereRenderer::new(context.clone(), paths);
+
+        for (slug, content) in [("changed", "one"), ("removed", "two"), ("moved", "three")] {
+            context
+                .write(slug, &ContentType::Subtext, content.as_bytes(), None)
+                .await?;
+        }
+        context.save(None).await?;
+
+        renderer.render(None, false).await?;
+
+        assert_eq!(
+            read_rendered(root.path(), "changed.subtext").await?,
+            Some("one".into())
+        );
+
+        // Change and remove some content...
+        context
+            .write("changed", &ContentType::Subtext, "four".as_bytes(), None)
+            .await?;
+        context.remove("removed").await?;
+        context.save(None).await?;
+
+        // ...then move some content, and add content that is later removed
+        context.remove("moved").await?;
+        context
+            .write(
+                "moved-here",
+                &ContentType::Subtext,
+                "three".as_bytes(),
+                None,
+            )
+            .await?;
+        context
+            .write("transient", &ContentType::Subtext, "five".as_bytes(), None)
+            .await?;
+        context.save(None).await?;
+
+        // ...and change the changed content once more
+        context.remove("transient").await?;
+        context
+            .write("changed", &ContentType::Subtext, "six".as_bytes(), None)
+            .await?;
+        let version = context.save(None).await?.to_string();
+
+        renderer.render(None, false).await?;
+
+        let expected_content = [
+            ("changed.subtext", Some("six")),
+            ("removed.subtext", None),
+            ("moved.subtext", None),
+            ("moved-here.subtext", Some("three")),
+            ("transient.subtext", None),
+            (".sphere/version", Some(version.as_str())),
+        ];
+
+        for (path, content) in expected_content {
+            assert_eq!(
+                read_rendered(root.path(), path).await?.as_deref(),
+                content,
+                "Unexpected content at '{path}'"
+            );
+        }
+
+        Ok(())
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn it_renders_peers_of_rendered_peers_when_the_depth_increases() -> Result<()> {
+        let root = tempfile::tempdir()?;
+        let paths = Arc::new(SpherePaths::initialize(root.path()).await?);
+        let (context, _) =
+            make_sphere_context_with_peer_chain(&["peer1".into(), "peer2".into(), "peer3".into()])
+                .await?;
+        let renderer = SphereRenderer::new(context, paths);
+
+        renderer.render(Some(1), false).await?;
+
+        assert_eq!(
+            read_rendered(root.path(), "@peer1/my-name.subtext").await?,
+            Some("peer1".into())
+        );
+        assert_eq!(
+            read_rendered(root.path(), "@peer1/@peer2/my-name.subtext").await?,
+            None
+        );
+
+        // Mark the rendered peer, so that we can tell whether it is rendered
+        // again from scratch
+        let peer_1_mount = tokio::fs::read_link(root.path().join("@peer1")).await?;
+        let peer_1_marker = root
+            .path()
+            .join(peer_1_mount)
+            .parent()
+            .unwrap()
+            .join("marker");
+        tokio::fs::write(&peer_1_marker, "").await?;
+
+        renderer.render(Some(3), false).await?;
+
+        let expected_content = [
+            ("@peer1/my-name.subtext", "peer1"),
+            ("@peer1/@peer2/my-name.subtext", "peer2"),
+            ("@peer1/@peer2/@peer3/my-name.subtext", "peer3"),
+        ];
+
+        for (path, content) in expected_content {
+            assert_eq!(
+                read_rendered(root.path(), path).await?.as_deref(),
+                Some(content),
+                "Unexpected content at '{path}'"
+            );
+        }
+
+        assert!(tokio::fs::try_exists(&peer_1_marker).await?);
+
+        Ok(())
+    }
+}
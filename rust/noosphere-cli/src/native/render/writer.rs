@@ -8,13 +8,12 @@ use std::{
     sync::{Arc, OnceLock},
 };
 use symlink::{remove_symlink_dir, remove_symlink_file, symlink_dir, symlink_file};
-use tokio::{fs::File, io::copy};
 
 use crate::native::paths::{
     SpherePaths, IDENTITY_FILE, LINK_RECORD_FILE, MOUNT_DIRECTORY, VERSION_FILE,
 };
 
-use super::JobKind;
+use super::{JobKind, RenderIo};
 
 /// A [SphereWriter] encapsulates most file system operations to a workspace. It
 /// enables batch operations to be performed via domain-specific verbs. Some of
@@ -25,6 +24,7 @@ use super::JobKind;
 pub struct SphereWriter {
     kind: JobKind,
     paths: Arc<SpherePaths>,
+    io: Arc<RenderIo>,
     base: OnceLock<PathBuf>,
     mount: OnceLock<PathBuf>,
     private: OnceLock<PathBuf>,
@@ -32,11 +32,12 @@ pub struct SphereWriter {
 
 impl SphereWriter {
     /// Construct a [SphereWriter] with the given [JobKind] and initialized
-    /// [SpherePaths].
-    pub fn new(kind: JobKind, paths: Arc<SpherePaths>) -> Self {
+    /// [SpherePaths], writing content through the given [RenderIo].
+    pub fn new(kind: JobKind, paths: Arc<SpherePaths>, io: Arc<RenderIo>) -> Self {
         SphereWriter {
             kind,
             paths,
+            io,
             base: Default::default(),
             mount: Default::default(),
             private: Default::default(),
@@ -159,19 +160,11 @@ impl SphereWriter {
 
         tokio::fs::create_dir_all(file_directory).await?;
 
-        match tokio::fs::try_exists(&file_path).await {
-            Ok(true) => {
-                trace!("'{}' content already exists, not re-rendering...", slug);
-            }
-            Err(error) => {
-                warn!("Error checking for existing file: {}", error);
-            }
-            _ => {
-                debug!("Rendering content for '{}'...", slug);
-                let mut fs_file = File::create(&file_path).await?;
-                copy(&mut file.contents, &mut fs_file).await?;
-            }
-        };
+        if self.io.materialize(&file_path, &mut file.contents).await? {
+            debug!("Rendered content for '{}'", slug);
+        } else {
+            trace!("'{}' content already exists, not re-rendering...", slug);
+        }
 
         // If we are writing root, we need to symlink from inside .sphere to the
         // rendered file (we use this backlink to determine how moves / deletes
@@ -0,0 +1,254 @@
+//! A persisted cache of the file system metadata of workspace files, used to
+//! tell which files have changed without reading (and chunking) every one of
+//! them
+
+use anyhow::Result;
+use cid::Cid;
+use noosphere_core::data::ContentType;
+use serde::{Deserialize, Serialize};
+use std::{
+    collections::BTreeMap,
+    fs::Metadata,
+    path::{Path, PathBuf},
+    str::FromStr,
+    time::{Duration, SystemTime, UNIX_EPOCH},
+};
+
+/// Files modified more recently than this (relative to when they are looked
+/// at) are not cached, because a change made within the resolution of the
+/// file system's timestamps could otherwise go unnoticed later on
+pub const RACY_MODIFICATION_WINDOW: Duration = Duration::from_secs(2);
+
+/// The file system metadata that is taken to identify a file's contents:
+/// if none of it has changed, the contents are assumed not to have changed
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct FileStat {
+    size: u64,
+    modified_nanos: u128,
+    inode: u64,
+}
+
+impl FileStat {
+    /// The [FileStat] for some [Metadata], or `None` if it should not be
+    /// cached (for example, because the file was modified very recently)
+    pub fn from_metadata(metadata: &Metadata) -> Option<Self> {
+        let modified = metadata.modified().ok()?;
+        if SystemTime::now()
+            .duration_since(modified)
+            .map(|age| age < RACY_MODIFICATION_WINDOW)
+            .unwrap_or(true)
+        {
+            return None;
+        }
+
+        FileStat::of(metadata)
+    }
+
+    /// The [FileStat] for some [Metadata], however recently the file was
+    /// modified. It may be cached only once [FileStat::from_metadata] agrees
+    /// with it.
+    pub fn of(metadata: &Metadata) -> Option<Self> {
+        let modified = metadata.modified().ok()?;
+
+        Some(FileStat {
+            size: metadata.len(),
+            modified_nanos: modified.duration_since(UNIX_EPOCH).ok()?.as_nanos(),
+            inode: inode(metadata),
+        })
+    }
+}
+
+#[cfg(unix)]
+fn inode(metadata: &Metadata) -> u64 {
+    std::os::unix::fs::MetadataExt::ino(metadata)
+}
+
+#[cfg(not(unix))]
+fn inode(_metadata: &Metadata) -> u64 {
+    0
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+struct StatCacheEntry {
+    stat: FileStat,
+    body: String,
+    content_type: String,
+}
+
+/// Maps the paths of workspace files (relative to the workspace root) to the
+/// body [Cid] and [ContentType] they had when their [FileStat] was recorded.
+///
+/// The cache is a JSON file that is rewritten after each full read of the
+/// workspace, and only remembers the files seen during that read. A missing
+/// or unreadable cache is treated as empty.
+pub struct StatCache {
+    path: PathBuf,
+    previous: BTreeMap<String, StatCacheEntry>,
+    next: BTreeMap<String, StatCacheEntry>,
+    changed: bool,
+}
+
+impl StatCache {
+    /// Load the cache persisted at `path`
+    pub async fn load(path: &Path) -> Self {
+        let previous = match tokio::fs::read(path).await {
+            Ok(bytes) => serde_json::from_slice(&bytes).unwrap_or_else(|error| {
+                warn!("Ignoring unreadable stat cache at {:?}: {}", path, error);
+                BTreeMap::new()
+            }),
+            Err(_) => BTreeMap::new(),
+        };
+
+        StatCache {
+            path: path.to_owned(),
+            previous,
+            next: BTreeMap::new(),
+            changed: false,
+        }
+    }
+
+    /// The body [Cid] and [ContentType] of the file at `relative_path`, if it
+    /// was cached with the same `stat`. A hit is carried over to the next
+    /// version of the cache.
+    pub fn get(&mut self, relative_path: &str, stat: &FileStat) -> Option<(Cid, ContentType)> {
+        let entry = self.previous.get(relative_path)?;
+        if &entry.stat != stat {
+            return None;
+        }
+
+        let body = Cid::from_str(&entry.body).ok()?;
+        let content_type = ContentType::from_str(&entry.content_type).ok()?;
+
+        self.next.insert(relative_path.to_owned(), entry.to_owned());
+
+        Some((body, content_type))
+    }
+
+    /// Record the body [Cid] and [ContentType] of the file at
+    /// `relative_path`, as of `stat`
+    pub fn insert(
+        &mut self,
+        relative_path: &str,
+        stat: FileStat,
+        body: &Cid,
+        content_type: &ContentType,
+    ) {
+        self.changed = true;
+        self.next.insert(
+            relative_path.to_owned(),
+            StatCacheEntry {
+                stat,
+                body: body.to_string(),
+                content_type: content_type.to_string(),
+            },
+        );
+    }
+
+    /// Forget the file at `relative_path`
+    pub fn remove(&mut self, relative_path: &str) {
+        self.previous.remove(relative_path);
+        if self.next.remove(relative_path).is_some() {
+            self.changed = true;
+        }
+    }
+
+    /// Carry every cached file over to the next version of the cache, for
+    /// callers that only look up the files that changed (rather than every
+    /// file in the workspace)
+    pub fn carry_over(&mut self) {
+        for (relative_path, entry) in &self.previous {
+            self.next
+                .entry(relative_path.clone())
+                .or_insert_with(|| entry.clone());
+        }
+    }
+
+    /// Persist the files that were looked up or recorded since the cache was
+    /// loaded (or last saved), if anything changed
+    pub async fn save(&mut self) -> Result<()> {
+        if !self.changed && self.next.len() == self.previous.len() {
+            return Ok(());
+        }
+
+        let bytes = serde_json::to_vec(&self.next)?;
+        let staging = self.path.with_extension("tmp");
+
+        tokio::fs::write(&staging, bytes).await?;
+        tokio::fs::rename(&staging, &self.path).await?;
+
+        self.previous.clone_from(&self.next);
+        self.changed = false;
+
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{FileStat, StatCache};
+    use anyhow::Result;
+    use cid::Cid;
+    use noosphere_core::data::ContentType;
+    use std::str::FromStr;
+
+    fn stat(size: u64) -> FileStat {
+        FileStat {
+            size,
+            modified_nanos: 1,
+            inode: 2,
+        }
+    }
+
+    #[tokio::test]
+    async fn it_remembers_files_until_their_stat_changes() -> Result<()> {
+        let directory = tempfile::tempdir()?;
+        let path = directory.path().join("stat_cache");
+        let body = Cid::from_str("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i")?;
+
+        let mut cache = StatCache::load(&path).await;
+        assert!(cache.get("foo.subtext", &stat(10)).is_none());
+        cache.insert("foo.subtext", stat(10), &body, &ContentType::Subtext);
+        cache.insert("bar.txt", stat(3), &body, &ContentType::Text);
+        cache.save().await?;
+
+        let mut cache = StatCache::load(&path).await;
+        assert_eq!(
+            cache.get("foo.subtext", &stat(10)),
+            Some((body, ContentType::Subtext))
+        );
+        assert_eq!(cache.get("foo.subtext", &stat(11)), None);
+        cache.save().await?;
+
+        // Files that were not seen are forgotten
+        let mut cache = StatCache::load(&path).await;
+        assert!(cache.get("bar.txt", &stat(3)).is_none());
+        assert!(cache.get("foo.subtext", &stat(10)).is_some());
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_can_be_updated_incrementally() -> Result<()> {
+        let directory = tempfile::tempdir()?;
+        let path = directory.path().join("stat_cache");
+        let body = Cid::from_str("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i")?;
+
+        let mut cache = StatCache::load(&path).await;
+        cache.insert("foo.subtext", stat(10), &body, &ContentType::Subtext);
+        cache.insert("bar.txt", stat(3), &body, &ContentType::Text);
+        cache.save().await?;
+
+        let mut cache = StatCache::load(&path).await;
+        cache.carry_over();
+        cache.remove("bar.txt");
+        cache.insert("baz.txt", stat(4), &body, &ContentType::Text);
+        cache.save().await?;
+
+        let mut cache = StatCache::load(&path).await;
+        assert!(cache.get("foo.subtext", &stat(10)).is_some());
+        assert!(cache.get("bar.txt", &stat(3)).is_none());
+        assert!(cache.get("baz.txt", &stat(4)).is_some());
+
+        Ok(())
+    }
+}
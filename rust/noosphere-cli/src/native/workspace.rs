@@ -9,7 +9,7 @@ use noosphere_core::context::{
     SphereContentRead, SphereContext, SphereCursor, COUNTERPART, GATEWAY_URL,
 };
 use noosphere_core::data::{Did, Link, LinkRecord, MemoIpld};
-use noosphere_storage::{KeyValueStore, SphereDb, StorageConfig};
+use noosphere_storage::{IoMeter, KeyValueStore, MeteredStorage, SphereDb, StorageConfig};
 use noosphere_ucan::crypto::KeyMaterial;
 use serde_json::Value;
 use std::path::{Path, PathBuf};
@@ -25,8 +25,12 @@ use crate::native::paths::{IDENTITY_FILE, LINK_RECORD_FILE, VERSION_FILE};
 use super::paths::SpherePaths;
 use super::render::SphereRenderer;
 
+/// The storage used through the CLI; its block I/O is metered, so that it can
+/// be reported (e.g., in the metrics of a gateway served from the workspace)
+pub type CliStorage = MeteredStorage<PlatformStorage>;
+
 /// The flavor of [SphereContext] used through the CLI
-pub type CliSphereContext = SphereContext<PlatformStorage>;
+pub type CliSphereContext = SphereContext<CliStorage>;
 
 /// Metadata about a given sphere, including the sphere ID, a [Link]
 /// to it and a corresponding [LinkRecord] (if one is available).
@@ -63,7 +67,21 @@ impl Workspace {
                     builder = builder.with_storage_config(storage_config);
                 }
 
-                Ok(Arc::new(Mutex::new(builder.build().await?.into())))
+                let context: SphereContext<PlatformStorage> = builder.build().await?.into();
+                let db = SphereDb::new(&MeteredStorage::new(
+                    context.db().storage().clone(),
+                    IoMeter::default(),
+                ))
+                .await?;
+                let context = SphereContext::new(
+                    context.identity().clone(),
+                    context.author().clone(),
+                    db,
+                    None,
+                )
+                .await?;
+
+                Ok(Arc::new(Mutex::new(context)))
                     as Result<Arc<Mutex<CliSphereContext>>, anyhow::Error>
             })
             .await?
@@ -80,7 +98,7 @@ impl Workspace {
     /// Get an owned referenced to the [SphereDb] that backs the local sphere.
     /// Note that this will initialize the [SphereContext] if it has not been
     /// already.
-    pub async fn db(&self) -> Result<SphereDb<PlatformStorage>> {
+    pub async fn db(&self) -> Result<SphereDb<CliStorage>> {
         let context = self.sphere_context().await?;
         let context = context.lock().await;
         Ok(context.db().clone())
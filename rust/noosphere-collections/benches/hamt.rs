@@ -0,0 +1,158 @@
+//! Micro-benchmarks for the hot paths of [Hamt], measured against both an
+//! in-memory and a sled-backed [BlockStore] at a range of map sizes.
+//!
+//! Run all of them:
+//! `cargo bench -p noosphere-collections --bench hamt`
+//! Run only a subset (e.g., in-memory lookups):
+//! `cargo bench -p noosphere-collections --bench hamt -- memory/get`
+
+use std::{
+    hint::black_box,
+    time::{Duration, Instant},
+};
+
+use anyhow::Result;
+use cid::Cid;
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use noosphere_collections::hamt::Hamt;
+use noosphere_storage::{BlockStore, MemoryStore, SledStorage, Storage};
+use tokio::runtime::Runtime;
+
+/// The sizes of the maps that each operation is measured against
+const ENTRY_COUNTS: &[usize] = &[1_000, 10_000, 100_000, 1_000_000];
+
+type BenchHamt<S> = Hamt<S, u64, String>;
+
+fn existing_key(iteration: u64, count: usize) -> String {
+    // Stride through the key space so that successive iterations touch
+    // different branches of the HAMT
+    format!("key-{}", (iteration as usize).wrapping_mul(7919) % count)
+}
+
+fn absent_key(iteration: u64) -> String {
+    format!("absent-key-{iteration}")
+}
+
+async fn populate<S: BlockStore>(store: S, count: usize) -> Result<Cid> {
+    let mut hamt = BenchHamt::new(store);
+
+    for i in 0..count {
+        hamt.set(format!("key-{i}"), i as u64).await?;
+    }
+
+    hamt.flush().await
+}
+
+/// Measures `get`, `set`, `delete` and `flush` against a HAMT of each size in
+/// [ENTRY_COUNTS]. Every iteration loads the HAMT fresh from its root so that
+/// node loading (and therefore the backing store) is part of what is
+/// measured; loading the root itself is excluded from the timings.
+fn bench_hamt_operations<S>(c: &mut Criterion, runtime: &Runtime, store_name: &str, store: S)
+where
+    S: BlockStore + 'static,
+{
+    let mut group = c.benchmark_group(format!("hamt/{store_name}"));
+    group.sample_size(20);
+
+    for &count in ENTRY_COUNTS {
+        let root = runtime
+            .block_on(populate(store.clone(), count))
+            .expect("Failed to populate HAMT");
+
+        group.bench_with_input(BenchmarkId::new("get", count), &root, |b, root| {
+            b.to_async(runtime).iter_custom(|iterations| {
+                let store = store.clone();
+                async move {
+                    let mut elapsed = Duration::ZERO;
+                    for i in 0..iterations {
+                        let hamt = BenchHamt::load(root, store.clone()).await.unwrap();
+                        let key = existing_key(i, count);
+
+                        let start = Instant::now();
+                        black_box(hamt.get(&key).await.unwrap());
+                        elapsed += start.elapsed();
+                    }
+                    elapsed
+                }
+            })
+        });
+
+        group.bench_with_input(BenchmarkId::new("set", count), &root, |b, root| {
+            b.to_async(runtime).iter_custom(|iterations| {
+                let store = store.clone();
+                async move {
+                    let mut elapsed = Duration::ZERO;
+                    for i in 0..iterations {
+                        let mut hamt = BenchHamt::load(root, store.clone()).await.unwrap();
+                        let key = absent_key(i);
+
+                        let start = Instant::now();
+                        black_box(hamt.set(key, i).await.unwrap());
+                        elapsed += start.elapsed();
+                    }
+                    elapsed
+                }
+            })
+        });
+
+        group.bench_with_input(BenchmarkId::new("delete", count), &root, |b, root| {
+            b.to_async(runtime).iter_custom(|iterations| {
+                let store = store.clone();
+                async move {
+                    let mut elapsed = Duration::ZERO;
+                    for i in 0..iterations {
+                        let mut hamt = BenchHamt::load(root, store.clone()).await.unwrap();
+                        let key = existing_key(i, count);
+
+                        let start = Instant::now();
+                        black_box(hamt.delete(&key).await.unwrap());
+                        elapsed += start.elapsed();
+                    }
+                    elapsed
+                }
+            })
+        });
+
+        group.bench_with_input(BenchmarkId::new("flush", count), &root, |b, root| {
+            b.to_async(runtime).iter_custom(|iterations| {
+                let store = store.clone();
+                async move {
+                    let mut elapsed = Duration::ZERO;
+                    for i in 0..iterations {
+                        let mut hamt = BenchHamt::load(root, store.clone()).await.unwrap();
+                        hamt.set(absent_key(i), i).await.unwrap();
+
+                        let start = Instant::now();
+                        black_box(hamt.flush().await.unwrap());
+                        elapsed += start.elapsed();
+                    }
+                    elapsed
+                }
+            })
+        });
+    }
+
+    group.finish();
+}
+
+fn bench_memory_store(c: &mut Criterion) {
+    let runtime = Runtime::new().unwrap();
+    bench_hamt_operations(c, &runtime, "memory", MemoryStore::default());
+}
+
+fn bench_sled_store(c: &mut Criterion) {
+    let runtime = Runtime::new().unwrap();
+    let temp_dir = tempfile::TempDir::new().unwrap();
+    let store = runtime
+        .block_on(async {
+            SledStorage::new(temp_dir.path())?
+                .get_block_store("hamt")
+                .await
+        })
+        .unwrap();
+
+    bench_hamt_operations(c, &runtime, "sled", store);
+}
+
+criterion_group!(benches, bench_memory_store, bench_sled_store);
+criterion_main!(benches);
@@ -2,10 +2,13 @@ use instant::{Duration, Instant};
 
 use futures_util::Stream;
 use tokio::sync::mpsc::{UnboundedReceiver, UnboundedSender};
+use tracing::Span;
 
-use crate::ConditionalSend;
+use crate::{metrics::metrics, stall::span_name, stall_detection_enabled, ConditionalSend};
 
-/// A helper for observing when [Stream] throughput appears to have stalled
+/// A helper for observing when [Stream] throughput appears to have stalled.
+/// A guard created with [StreamLatencyGuard::wrap_named] also reports each
+/// stall while stall detection is enabled (see [crate::enable_stall_detection]).
 pub struct StreamLatencyGuard<S>
 where
     S: Stream + Unpin,
@@ -15,6 +18,9 @@ where
     threshold: Duration,
     last_ready_time: Instant,
     tx: UnboundedSender<()>,
+    name: Option<&'static str>,
+    span: Span,
+    reported_stall: bool,
 }
 
 impl<S> StreamLatencyGuard<S>
@@ -33,10 +39,47 @@ where
                 threshold,
                 last_ready_time: Instant::now(),
                 tx,
+                name: None,
+                span: Span::current(),
+                reported_stall: false,
             },
             rx,
         )
     }
+
+    /// Same as [StreamLatencyGuard::wrap], but stalls are also reported under
+    /// `name` (one of [crate::metrics::GUARDED_STREAMS]) and attributed to the
+    /// `tracing` span that is current when the stream is wrapped
+    pub fn wrap_named(
+        stream: S,
+        threshold: Duration,
+        name: &'static str,
+    ) -> (Self, UnboundedReceiver<()>) {
+        let (mut guard, rx) = Self::wrap(stream, threshold);
+        guard.name = Some(name);
+        (guard, rx)
+    }
+
+    fn report_stall(&mut self, pending_for: Duration) {
+        let Some(name) = self.name else {
+            return;
+        };
+
+        if self.reported_stall || !stall_detection_enabled() {
+            return;
+        }
+
+        self.reported_stall = true;
+        metrics().runtime.stream_stalls.get(name).inc();
+
+        warn!(
+            parent: &self.span,
+            "Stream '{}' has been pending for {:?} (created in '{}')",
+            name,
+            pending_for,
+            span_name(&self.span)
+        );
+    }
 }
 
 impl<S> Stream for StreamLatencyGuard<S>
@@ -53,11 +96,15 @@ where
         let result = std::pin::pin!(&mut self.inner).poll_next(cx);
 
         if result.is_pending() {
-            if Instant::now() - self.last_ready_time > self.threshold {
+            let pending_for = Instant::now() - self.last_ready_time;
+
+            if pending_for > self.threshold {
                 let _ = self.tx.send(());
+                self.report_stall(pending_for);
             }
         } else if result.is_ready() {
             self.last_ready_time = Instant::now();
+            self.reported_stall = false;
         }
 
         result
@@ -6,11 +6,14 @@ extern crate tracing;
 
 pub mod channel;
 mod latency;
+pub mod metrics;
+mod stall;
 mod sync;
 mod task;
 mod unshared;
 
 pub use latency::*;
+pub use stall::*;
 pub use sync::*;
 pub use task::*;
 pub use unshared::*;
@@ -0,0 +1,725 @@
+//! A small, lock-free metrics registry that can be rendered in the Prometheus
+//! text exposition format.
+//!
+//! Every metric that Noosphere records is declared up front on [Metrics], and
+//! labelled metrics only accept a fixed set of label values. Recording a value
+//! amounts to a few relaxed atomic operations, with no locking or allocation,
+//! so metrics are always on. Use [metrics] to access the process-wide
+//! registry, and [Metrics::encode] to render it when it is scraped.
+
+use instant::{Duration, Instant};
+use std::{
+    fmt::Write,
+    sync::{
+        atomic::{AtomicI64, AtomicU64, Ordering},
+        OnceLock,
+    },
+};
+
+/// The content type of the output of [Metrics::encode]
+pub const PROMETHEUS_CONTENT_TYPE: &str = "text/plain; version=0.0.4";
+
+/// Upper bounds, in seconds, of the buckets of every latency [Histogram]
+pub const LATENCY_BUCKETS: &[f64] = &[
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0,
+    60.0,
+];
+
+/// The label value that observations are recorded under when they are made
+/// with a label value that a [Family] was not declared with
+pub const OTHER_LABEL_VALUE: &str = "other";
+
+/// Routes of the gateway API that are measured
+pub const GATEWAY_ROUTES: &[&str] = &["did", "identify", "fetch", "push", "replicate"];
+
+/// Kinds of jobs run by the gateway's worker queue
+pub const GATEWAY_JOBS: &[&str] = &[
+    "compact_history",
+    "ipfs_syndication",
+    "name_system_resolve_all",
+    "name_system_resolve_since",
+    "name_system_publish",
+    "name_system_republish",
+];
+
+/// Calls made to the IPFS Kubo RPC API
+pub const IPFS_CALLS: &[&str] = &[
+    "pin_blocks",
+    "block_is_pinned",
+    "server_identity",
+    "syndicate_blocks",
+    "get_block",
+];
+
+/// Queries made to the name system
+pub const NAME_SYSTEM_QUERIES: &[&str] =
+    &["get_record", "put_record", "get_records", "put_records"];
+
+/// Outcomes of looking up a name in a name resolution cache
+pub const NAME_CACHE_RESULTS: &[&str] = &["hit", "stale", "miss"];
+
+/// Operations performed on a `SphereDb`
+pub const STORAGE_OPERATIONS: &[&str] = &[
+    "get_block",
+    "put_block",
+    "put_links",
+    "get_key",
+    "set_key",
+    "unset_key",
+    "flush",
+];
+
+/// Logical operations that block I/O is attributed to by a metered
+/// `SphereDb`
+pub const IO_OPERATIONS: &[&str] = &["hydrate", "traverse", "replicate", "render"];
+
+/// The stores that make up a `SphereDb`
+pub const SPHERE_DB_STORES: &[&str] = &["blocks", "links", "versions", "metadata"];
+
+/// Directions in which bytes move through a store or stream
+pub const BYTE_DIRECTIONS: &[&str] = &["read", "written"];
+
+/// Upper bounds, in seconds, of the buckets of the task poll [Histogram]
+pub const POLL_BUCKETS: &[f64] = &[
+    0.00001, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25,
+    1.0,
+];
+
+/// Sections of synchronous work that are timed while stall detection is
+/// enabled
+pub const SYNCHRONOUS_SECTIONS: &[&str] = &["block_decode", "signature_verification"];
+
+/// Streams whose stalls are reported while stall detection is enabled
+pub const GUARDED_STREAMS: &[&str] = &["car", "replicate", "push"];
+
+/// A monotonically increasing count
+#[derive(Debug, Default)]
+pub struct Counter(AtomicU64);
+
+impl Counter {
+    /// Increment the count by one
+    pub fn inc(&self) {
+        self.inc_by(1);
+    }
+
+    /// Increment the count by `value`
+    pub fn inc_by(&self, value: u64) {
+        self.0.fetch_add(value, Ordering::Relaxed);
+    }
+
+    /// The current count
+    pub fn get(&self) -> u64 {
+        self.0.load(Ordering::Relaxed)
+    }
+}
+
+/// A value that can go up and down
+#[derive(Debug, Default)]
+pub struct Gauge(AtomicI64);
+
+impl Gauge {
+    /// Set the value
+    pub fn set(&self, value: i64) {
+        self.0.store(value, Ordering::Relaxed);
+    }
+
+    /// Add `value` (which may be negative) to the current value
+    pub fn add(&self, value: i64) {
+        self.0.fetch_add(value, Ordering::Relaxed);
+    }
+
+    /// The current value
+    pub fn get(&self) -> i64 {
+        self.0.load(Ordering::Relaxed)
+    }
+}
+
+/// A distribution of durations, counted into fixed buckets
+#[derive(Debug)]
+pub struct Histogram {
+    bounds: &'static [f64],
+    bounds_micros: Box<[u64]>,
+    // One more bucket than there are bounds, for observations above the
+    // highest bound
+    buckets: Box<[AtomicU64]>,
+    sum_micros: AtomicU64,
+    count: AtomicU64,
+}
+
+impl Histogram {
+    /// Create a [Histogram] with buckets whose upper bounds are `bounds`,
+    /// given in seconds in ascending order
+    pub fn new(bounds: &'static [f64]) -> Self {
+        Histogram {
+            bounds,
+            bounds_micros: bounds
+                .iter()
+                .map(|bound| (bound * 1_000_000.0) as u64)
+                .collect(),
+            buckets: (0..=bounds.len()).map(|_| AtomicU64::new(0)).collect(),
+            sum_micros: AtomicU64::new(0),
+            count: AtomicU64::new(0),
+        }
+    }
+
+    /// Record one observation of `duration`
+    pub fn observe(&self, duration: Duration) {
+        let micros = u64::try_from(duration.as_micros()).unwrap_or(u64::MAX);
+        let index = self.bounds_micros.partition_point(|bound| *bound < micros);
+
+        self.buckets[index].fetch_add(1, Ordering::Relaxed);
+        self.sum_micros.fetch_add(micros, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Start timing an operation; the elapsed time is observed when the
+    /// returned [HistogramTimer] is dropped
+    pub fn start_timer(&self) -> HistogramTimer<'_> {
+        HistogramTimer {
+            histogram: self,
+            start: Instant::now(),
+        }
+    }
+
+    /// The number of observations made so far
+    pub fn count(&self) -> u64 {
+        self.count.load(Ordering::Relaxed)
+    }
+}
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Histogram::new(LATENCY_BUCKETS)
+    }
+}
+
+/// Observes the time since it was created on its [Histogram] when dropped
+pub struct HistogramTimer<'a> {
+    histogram: &'a Histogram,
+    start: Instant,
+}
+
+impl<'a> Drop for HistogramTimer<'a> {
+    fn drop(&mut self) {
+        self.histogram.observe(self.start.elapsed());
+    }
+}
+
+/// A set of metrics of the same kind that are distinguished by the value of a
+/// single label. The label values are fixed when the [Family] is created, so
+/// that looking up a metric never allocates or locks.
+#[derive(Debug)]
+pub struct Family<M> {
+    label: &'static str,
+    values: &'static [&'static str],
+    // The last metric is recorded under [OTHER_LABEL_VALUE]
+    metrics: Box<[M]>,
+}
+
+impl<M: Default> Family<M> {
+    /// Create a [Family] of metrics labelled `label`, one for each of the
+    /// given `values`
+    pub fn new(label: &'static str, values: &'static [&'static str]) -> Self {
+        Family {
+            label,
+            values,
+            metrics: (0..=values.len()).map(|_| M::default()).collect(),
+        }
+    }
+}
+
+impl<M> Family<M> {
+    /// Get the metric for the given label `value`; values that were not
+    /// declared when the [Family] was created are recorded under
+    /// [OTHER_LABEL_VALUE]
+    pub fn get(&self, value: &str) -> &M {
+        let index = self
+            .values
+            .iter()
+            .position(|candidate| *candidate == value)
+            .unwrap_or(self.values.len());
+
+        &self.metrics[index]
+    }
+
+    fn iter(&self) -> impl Iterator<Item = (&'static str, &M)> {
+        self.values
+            .iter()
+            .copied()
+            .chain(std::iter::once(OTHER_LABEL_VALUE))
+            .zip(self.metrics.iter())
+    }
+}
+
+impl Family<Histogram> {
+    /// Shorthand for starting a timer on the [Histogram] for `value`
+    pub fn start_timer(&self, value: &str) -> HistogramTimer<'_> {
+        self.get(value).start_timer()
+    }
+}
+
+/// Metrics recorded by the gateway's API and job processors
+#[derive(Debug)]
+pub struct GatewayMetrics {
+    /// Time until a response to a request is ready, by route
+    pub request_duration: Family<Histogram>,
+    /// Blocks streamed to or from clients, by route
+    pub streamed_blocks: Family<Counter>,
+    /// Bytes of block data streamed to or from clients, by route
+    pub streamed_bytes: Family<Counter>,
+    /// Jobs that are waiting for a worker to become available
+    pub job_queue_depth: Gauge,
+    /// Time spent running each job, by kind of job
+    pub job_duration: Family<Histogram>,
+    /// Jobs that ended in an error, by kind of job
+    pub job_failures: Family<Counter>,
+}
+
+/// Metrics recorded by clients of the IPFS Kubo RPC API
+#[derive(Debug)]
+pub struct IpfsMetrics {
+    /// Time spent waiting on Kubo, by API call
+    pub request_duration: Family<Histogram>,
+}
+
+/// Metrics recorded by name system clients and nodes
+#[derive(Debug)]
+pub struct NameSystemMetrics {
+    /// Time spent on a name system query, by kind of query
+    pub query_duration: Family<Histogram>,
+    /// Lookups in a name resolution cache, by outcome
+    pub cache_lookups: Family<Counter>,
+}
+
+/// Metrics recorded by `SphereDb`
+#[derive(Debug)]
+pub struct StorageMetrics {
+    /// Time spent on an operation, by kind of operation
+    pub operation_duration: Family<Histogram>,
+    /// Bytes of blocks read from or written to block storage
+    pub block_bytes: Family<Counter>,
+    /// The underlying (e.g. disk) space usage of the storage provider, as of
+    /// the last time storage stats were recorded
+    pub space_usage_bytes: Gauge,
+    /// Bytes of live data, by store
+    pub live_bytes: Family<Gauge>,
+    /// Bytes occupied on disk, by store
+    pub on_disk_bytes: Family<Gauge>,
+    /// Entries (possibly estimated), by store
+    pub entries: Family<Gauge>,
+    /// Bytes due to be rewritten by pending compactions
+    pub pending_compaction_bytes: Gauge,
+    /// Blocks looked up in metered block storage, by operation
+    pub io_reads: Family<Counter>,
+    /// Lookups in metered block storage that found no block, by operation
+    pub io_misses: Family<Counter>,
+    /// Bytes of blocks read from metered block storage, by operation
+    pub io_bytes_read: Family<Counter>,
+    /// Blocks written to metered block storage, by operation
+    pub io_writes: Family<Counter>,
+    /// Bytes of blocks written to metered block storage, by operation
+    pub io_bytes_written: Family<Counter>,
+}
+
+/// Metrics recorded by the stall detector (only while it is enabled)
+#[derive(Debug)]
+pub struct RuntimeMetrics {
+    /// Time spent in each poll of a monitored task
+    pub task_poll_duration: Histogram,
+    /// Polls of monitored tasks that exceeded the long poll threshold
+    pub long_polls: Counter,
+    /// Time spent in a section of synchronous work, by kind of section
+    pub synchronous_duration: Family<Histogram>,
+    /// Stalls of guarded streams, by stream
+    pub stream_stalls: Family<Counter>,
+}
+
+/// The registry of all metrics recorded by Noosphere
+#[derive(Debug)]
+pub struct Metrics {
+    /// See [GatewayMetrics]
+    pub gateway: GatewayMetrics,
+    /// See [IpfsMetrics]
+    pub ipfs: IpfsMetrics,
+    /// See [NameSystemMetrics]
+    pub name_system: NameSystemMetrics,
+    /// See [StorageMetrics]
+    pub storage: StorageMetrics,
+    /// See [RuntimeMetrics]
+    pub runtime: RuntimeMetrics,
+}
+
+impl Default for Metrics {
+    fn default() -> Self {
+        Metrics {
+            gateway: GatewayMetrics {
+                request_duration: Family::new("route", GATEWAY_ROUTES),
+                streamed_blocks: Family::new("route", GATEWAY_ROUTES),
+                streamed_bytes: Family::new("route", GATEWAY_ROUTES),
+                job_queue_depth: Gauge::default(),
+                job_duration: Family::new("job", GATEWAY_JOBS),
+                job_failures: Family::new("job", GATEWAY_JOBS),
+            },
+            ipfs: IpfsMetrics {
+                request_duration: Family::new("call", IPFS_CALLS),
+            },
+            name_system: NameSystemMetrics {
+                query_duration: Family::new("query", NAME_SYSTEM_QUERIES),
+                cache_lookups: Family::new("result", NAME_CACHE_RESULTS),
+            },
+            storage: StorageMetrics {
+                operation_duration: Family::new("operation", STORAGE_OPERATIONS),
+                block_bytes: Family::new("direction", BYTE_DIRECTIONS),
+                space_usage_bytes: Gauge::default(),
+                live_bytes: Family::new("store", SPHERE_DB_STORES),
+                on_disk_bytes: Family::new("store", SPHERE_DB_STORES),
+                entries: Family::new("store", SPHERE_DB_STORES),
+                pending_compaction_bytes: Gauge::default(),
+                io_reads: Family::new("operation", IO_OPERATIONS),
+                io_misses: Family::new("operation", IO_OPERATIONS),
+                io_bytes_read: Family::new("operation", IO_OPERATIONS),
+                io_writes: Family::new("operation", IO_OPERATIONS),
+                io_bytes_written: Family::new("operation", IO_OPERATIONS),
+            },
+            runtime: RuntimeMetrics {
+                task_poll_duration: Histogram::new(POLL_BUCKETS),
+                long_polls: Counter::default(),
+                synchronous_duration: Family::new("section", SYNCHRONOUS_SECTIONS),
+                stream_stalls: Family::new("stream", GUARDED_STREAMS),
+            },
+        }
+    }
+}
+
+impl Metrics {
+    /// Render all metrics in the Prometheus text exposition format (see
+    /// [PROMETHEUS_CONTENT_TYPE])
+    pub fn encode(&self) -> String {
+        let mut output = String::new();
+
+        encode_histograms(
+            &mut output,
+            "noosphere_gateway_request_duration_seconds",
+            "Time until a gateway response is ready",
+            &self.gateway.request_duration,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_gateway_streamed_blocks_total",
+            "Blocks streamed to or from gateway clients",
+            &self.gateway.streamed_blocks,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_gateway_streamed_bytes_total",
+            "Bytes of blocks streamed to or from gateway clients",
+            &self.gateway.streamed_bytes,
+        );
+        encode_gauge(
+            &mut output,
+            "noosphere_gateway_job_queue_depth",
+            "Gateway jobs waiting for an available worker",
+            &self.gateway.job_queue_depth,
+        );
+        encode_histograms(
+            &mut output,
+            "noosphere_gateway_job_duration_seconds",
+            "Time spent running a gateway job",
+            &self.gateway.job_duration,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_gateway_job_failures_total",
+            "Gateway jobs that ended in an error",
+            &self.gateway.job_failures,
+        );
+        encode_histograms(
+            &mut output,
+            "noosphere_ipfs_request_duration_seconds",
+            "Time spent waiting on the IPFS Kubo RPC API",
+            &self.ipfs.request_duration,
+        );
+        encode_histograms(
+            &mut output,
+            "noosphere_name_system_query_duration_seconds",
+            "Time spent on a name system query",
+            &self.name_system.query_duration,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_name_system_cache_lookups_total",
+            "Lookups in a name resolution cache",
+            &self.name_system.cache_lookups,
+        );
+        encode_histograms(
+            &mut output,
+            "noosphere_storage_operation_duration_seconds",
+            "Time spent on a sphere storage operation",
+            &self.storage.operation_duration,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_block_bytes_total",
+            "Bytes of blocks read from or written to sphere storage",
+            &self.storage.block_bytes,
+        );
+        encode_gauge(
+            &mut output,
+            "noosphere_storage_space_usage_bytes",
+            "Underlying space used by sphere storage",
+            &self.storage.space_usage_bytes,
+        );
+        encode_gauges(
+            &mut output,
+            "noosphere_storage_live_bytes",
+            "Bytes of live data in a sphere storage store",
+            &self.storage.live_bytes,
+        );
+        encode_gauges(
+            &mut output,
+            "noosphere_storage_on_disk_bytes",
+            "Bytes occupied on disk by a sphere storage store",
+            &self.storage.on_disk_bytes,
+        );
+        encode_gauges(
+            &mut output,
+            "noosphere_storage_entries",
+            "Entries in a sphere storage store",
+            &self.storage.entries,
+        );
+        encode_gauge(
+            &mut output,
+            "noosphere_storage_pending_compaction_bytes",
+            "Bytes of sphere storage due to be rewritten by compaction",
+            &self.storage.pending_compaction_bytes,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_io_reads_total",
+            "Blocks looked up in sphere storage, by the operation that read them",
+            &self.storage.io_reads,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_io_misses_total",
+            "Sphere storage lookups that found no block, by operation",
+            &self.storage.io_misses,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_io_read_bytes_total",
+            "Bytes of blocks read from sphere storage, by operation",
+            &self.storage.io_bytes_read,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_io_writes_total",
+            "Blocks written to sphere storage, by the operation that wrote them",
+            &self.storage.io_writes,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_storage_io_written_bytes_total",
+            "Bytes of blocks written to sphere storage, by operation",
+            &self.storage.io_bytes_written,
+        );
+        encode_histogram(
+            &mut output,
+            "noosphere_runtime_task_poll_duration_seconds",
+            "Time spent in a single poll of a monitored task",
+            &self.runtime.task_poll_duration,
+        );
+        encode_counter(
+            &mut output,
+            "noosphere_runtime_long_polls_total",
+            "Polls of monitored tasks that held up the executor",
+            &self.runtime.long_polls,
+        );
+        encode_histograms(
+            &mut output,
+            "noosphere_runtime_synchronous_duration_seconds",
+            "Time spent in a section of synchronous work",
+            &self.runtime.synchronous_duration,
+        );
+        encode_counters(
+            &mut output,
+            "noosphere_runtime_stream_stalls_total",
+            "Stalls of guarded streams",
+            &self.runtime.stream_stalls,
+        );
+
+        output
+    }
+}
+
+fn encode_header(output: &mut String, name: &str, help: &str, kind: &str) {
+    let _ = writeln!(output, "# HELP {name} {help}");
+    let _ = writeln!(output, "# TYPE {name} {kind}");
+}
+
+fn encode_gauge(output: &mut String, name: &str, help: &str, gauge: &Gauge) {
+    encode_header(output, name, help, "gauge");
+    let _ = writeln!(output, "{name} {}", gauge.get());
+}
+
+fn encode_gauges(output: &mut String, name: &str, help: &str, family: &Family<Gauge>) {
+    encode_header(output, name, help, "gauge");
+
+    for (value, gauge) in family.iter() {
+        let _ = writeln!(
+            output,
+            "{name}{{{}=\"{value}\"}} {}",
+            family.label,
+            gauge.get()
+        );
+    }
+}
+
+fn encode_counter(output: &mut String, name: &str, help: &str, counter: &Counter) {
+    encode_header(output, name, help, "counter");
+    let _ = writeln!(output, "{name} {}", counter.get());
+}
+
+fn encode_counters(output: &mut String, name: &str, help: &str, family: &Family<Counter>) {
+    encode_header(output, name, help, "counter");
+
+    for (value, counter) in family.iter() {
+        let _ = writeln!(
+            output,
+            "{name}{{{}=\"{value}\"}} {}",
+            family.label,
+            counter.get()
+        );
+    }
+}
+
+fn encode_histogram(output: &mut String, name: &str, help: &str, histogram: &Histogram) {
+    encode_header(output, name, help, "histogram");
+    encode_histogram_series(output, name, None, histogram);
+}
+
+fn encode_histograms(output: &mut String, name: &str, help: &str, family: &Family<Histogram>) {
+    encode_header(output, name, help, "histogram");
+
+    for (value, histogram) in family.iter() {
+        encode_histogram_series(output, name, Some((family.label, value)), histogram);
+    }
+}
+
+/// Write the buckets, sum and count of one [Histogram], optionally labelled
+/// with a single `(label, value)` pair
+fn encode_histogram_series(
+    output: &mut String,
+    name: &str,
+    label: Option<(&str, &str)>,
+    histogram: &Histogram,
+) {
+    let (bucket_labels, labels) = match label {
+        Some((label, value)) => (
+            format!("{label}=\"{value}\","),
+            format!("{{{label}=\"{value}\"}}"),
+        ),
+        None => (String::new(), String::new()),
+    };
+    let mut cumulative_count = 0;
+
+    for (bound, bucket) in histogram.bounds.iter().zip(histogram.buckets.iter()) {
+        cumulative_count += bucket.load(Ordering::Relaxed);
+        let _ = writeln!(
+            output,
+            "{name}_bucket{{{bucket_labels}le=\"{bound}\"}} {cumulative_count}"
+        );
+    }
+
+    if let Some(overflow) = histogram.buckets.last() {
+        cumulative_count += overflow.load(Ordering::Relaxed);
+    }
+
+    let sum_seconds = histogram.sum_micros.load(Ordering::Relaxed) as f64 / 1_000_000.0;
+
+    let _ = writeln!(
+        output,
+        "{name}_bucket{{{bucket_labels}le=\"+Inf\"}} {cumulative_count}"
+    );
+    let _ = writeln!(output, "{name}_sum{labels} {sum_seconds}");
+    let _ = writeln!(output, "{name}_count{labels} {cumulative_count}");
+}
+
+/// The process-wide [Metrics] registry
+pub fn metrics() -> &'static Metrics {
+    static METRICS: OnceLock<Metrics> = OnceLock::new();
+    METRICS.get_or_init(Metrics::default)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), test)]
+    fn it_counts_histogram_observations_into_cumulative_buckets() {
+        let histogram = Histogram::new(&[0.001, 0.01]);
+
+        histogram.observe(Duration::from_micros(500));
+        histogram.observe(Duration::from_millis(1));
+        histogram.observe(Duration::from_millis(5));
+        histogram.observe(Duration::from_secs(1));
+
+        let family = Family::<Histogram> {
+            label: "operation",
+            values: &["test"],
+            metrics: vec![histogram, Histogram::new(&[0.001, 0.01])].into_boxed_slice(),
+        };
+        let mut output = String::new();
+
+        encode_histograms(&mut output, "latency", "Latency", &family);
+
+        assert!(output.contains("latency_bucket{operation=\"test\",le=\"0.001\"} 2\n"));
+        assert!(output.contains("latency_bucket{operation=\"test\",le=\"0.01\"} 3\n"));
+        assert!(output.contains("latency_bucket{operation=\"test\",le=\"+Inf\"} 4\n"));
+        assert!(output.contains("latency_sum{operation=\"test\"} 1.0065\n"));
+        assert!(output.contains("latency_count{operation=\"test\"} 4\n"));
+        assert!(output.contains("latency_count{operation=\"other\"} 0\n"));
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), test)]
+    fn it_renders_every_declared_label_value() {
+        let metrics = Metrics::default();
+
+        metrics.storage.block_bytes.get("written").inc_by(42);
+        metrics.gateway.job_queue_depth.add(4);
+        metrics.gateway.job_queue_depth.add(-1);
+
+        let output = metrics.encode();
+
+        assert!(output.contains("noosphere_storage_block_bytes_total{direction=\"written\"} 42\n"));
+        assert!(output.contains("noosphere_storage_block_bytes_total{direction=\"read\"} 0\n"));
+        assert!(output.contains("noosphere_gateway_job_queue_depth 3\n"));
+
+        for job in GATEWAY_JOBS {
+            assert!(output.contains(&format!(
+                "noosphere_gateway_job_duration_seconds_count{{job=\"{job}\"}} 0\n"
+            )));
+        }
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), test)]
+    fn it_records_undeclared_label_values_as_other() {
+        let metrics = Metrics::default();
+
+        metrics.storage.block_bytes.get("sideways").inc_by(7);
+
+        let output = metrics.encode();
+
+        assert!(output.contains("noosphere_storage_block_bytes_total{direction=\"other\"} 7\n"));
+        assert!(!output.contains("sideways"));
+    }
+}
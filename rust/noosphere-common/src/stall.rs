@@ -0,0 +1,182 @@
+//! A diagnostic mode for finding out why async work stalls. It is off by
+//! default, and may be switched on with [enable_stall_detection] (for example,
+//! via `ns_tracing_initialize` over FFI). While it is on:
+//!
+//! - Every poll of a task spawned with [crate::spawn] or [crate::TaskQueue] is
+//!   timed and recorded in a histogram, and polls that take longer than
+//!   [LONG_POLL_THRESHOLD] are reported
+//! - [SynchronousSection]s (such as decoding blocks) are timed, and those that
+//!   hold up the executor for longer than [LONG_POLL_THRESHOLD] are reported
+//! - A [crate::StreamLatencyGuard] with a name reports each stall of its
+//!   stream, along with the `tracing` span that the stream was created in
+//!
+//! Reports are emitted as `tracing` warnings, and are counted in the
+//! `runtime` section of [crate::metrics::metrics].
+
+use instant::{Duration, Instant};
+use std::{
+    future::Future,
+    pin::Pin,
+    sync::atomic::{AtomicBool, Ordering},
+    task::{Context, Poll},
+};
+use tracing::Span;
+
+use crate::metrics::metrics;
+
+/// Polls and synchronous sections that take longer than this are reported
+/// while stall detection is enabled
+pub const LONG_POLL_THRESHOLD: Duration = Duration::from_millis(10);
+
+static STALL_DETECTION: AtomicBool = AtomicBool::new(false);
+
+/// Switch stall detection on or off for the whole process
+pub fn enable_stall_detection(enabled: bool) {
+    STALL_DETECTION.store(enabled, Ordering::Relaxed);
+}
+
+/// Whether or not stall detection is currently enabled
+pub fn stall_detection_enabled() -> bool {
+    STALL_DETECTION.load(Ordering::Relaxed)
+}
+
+/// The name of a [Span], for use in reports
+pub(crate) fn span_name(span: &Span) -> &'static str {
+    span.metadata()
+        .map(|metadata| metadata.name())
+        .unwrap_or("<none>")
+}
+
+/// Wraps a [Future] and times each of its polls. Long polls are attributed to
+/// the `tracing` span that was current when the [PollMonitor] was created.
+pub struct PollMonitor<F>
+where
+    F: Future,
+{
+    inner: Pin<Box<F>>,
+    span: Span,
+}
+
+impl<F> PollMonitor<F>
+where
+    F: Future,
+{
+    /// Monitor the polls of `future`
+    pub fn new(future: F) -> Self {
+        PollMonitor {
+            inner: Box::pin(future),
+            span: Span::current(),
+        }
+    }
+}
+
+impl<F> Future for PollMonitor<F>
+where
+    F: Future,
+{
+    type Output = F::Output;
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let start = Instant::now();
+        let result = self.inner.as_mut().poll(cx);
+        let elapsed = start.elapsed();
+        let runtime = &metrics().runtime;
+
+        runtime.task_poll_duration.observe(elapsed);
+
+        if elapsed > LONG_POLL_THRESHOLD {
+            runtime.long_polls.inc();
+            warn!(
+                parent: &self.span,
+                "Task was polled for {:?} without yielding (spawned in '{}')",
+                elapsed,
+                span_name(&self.span)
+            );
+        }
+
+        result
+    }
+}
+
+/// Times a section of synchronous work, reporting it if it holds up the
+/// executor for longer than [LONG_POLL_THRESHOLD]. Create one with
+/// [synchronous_section] and drop it when the work is done.
+pub struct SynchronousSection {
+    name: &'static str,
+    start: Instant,
+}
+
+/// Start timing a section of synchronous work called `name`, which should be
+/// one of [crate::metrics::SYNCHRONOUS_SECTIONS]. Returns `None` (and costs
+/// next to nothing) when stall detection is disabled.
+pub fn synchronous_section(name: &'static str) -> Option<SynchronousSection> {
+    stall_detection_enabled().then(|| SynchronousSection {
+        name,
+        start: Instant::now(),
+    })
+}
+
+impl Drop for SynchronousSection {
+    fn drop(&mut self) {
+        let elapsed = self.start.elapsed();
+
+        metrics()
+            .runtime
+            .synchronous_duration
+            .get(self.name)
+            .observe(elapsed);
+
+        if elapsed > LONG_POLL_THRESHOLD {
+            let span = Span::current();
+            warn!(
+                "Synchronous section '{}' blocked the executor for {:?} (in '{}')",
+                self.name,
+                elapsed,
+                span_name(&span)
+            );
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use anyhow::Result;
+    use instant::Duration;
+
+    use super::{enable_stall_detection, synchronous_section, PollMonitor};
+    use crate::metrics::metrics;
+
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_records_polls_and_long_synchronous_sections() -> Result<()> {
+        enable_stall_detection(true);
+
+        let runtime = &metrics().runtime;
+        let polls = runtime.task_poll_duration.count();
+        let long_polls = runtime.long_polls.get();
+        let decodes = runtime.synchronous_duration.get("block_decode").count();
+
+        PollMonitor::new(async {
+            let _section = synchronous_section("block_decode");
+            let start = instant::Instant::now();
+            // Busy-wait to simulate expensive work on the executor
+            while start.elapsed() < Duration::from_millis(20) {}
+        })
+        .await;
+
+        enable_stall_detection(false);
+
+        assert!(runtime.task_poll_duration.count() > polls);
+        assert!(runtime.long_polls.get() > long_polls);
+        assert!(runtime.synchronous_duration.get("block_decode").count() > decodes);
+        assert!(synchronous_section("block_decode").is_none());
+
+        Ok(())
+    }
+}
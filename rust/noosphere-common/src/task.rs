@@ -1,6 +1,8 @@
 use anyhow::Result;
 use std::future::Future;
 
+use crate::{stall_detection_enabled, PollMonitor};
+
 #[cfg(target_arch = "wasm32")]
 use std::pin::Pin;
 
@@ -22,6 +24,11 @@ where
     F::Output: Send + 'static,
 {
     let (tx, rx) = channel();
+    let future: Pin<Box<dyn Future<Output = F::Output>>> = if stall_detection_enabled() {
+        Box::pin(PollMonitor::new(future))
+    } else {
+        Box::pin(future)
+    };
 
     wasm_bindgen_futures::spawn_local(async move {
         if let Err(_) = tx.send(future.await) {
@@ -40,7 +47,11 @@ where
     F: Future + Send + 'static,
     F::Output: Send + 'static,
 {
-    Ok(tokio::spawn(future).await?)
+    if stall_detection_enabled() {
+        Ok(tokio::spawn(PollMonitor::new(future)).await?)
+    } else {
+        Ok(tokio::spawn(future).await?)
+    }
 }
 
 /// An aggregator of async work that can be used to observe the moment when all
@@ -84,7 +95,11 @@ impl TaskQueue {
     where
         F: Future<Output = Result<()>> + Send + 'static,
     {
-        self.tasks.spawn(future);
+        if stall_detection_enabled() {
+            self.tasks.spawn(PollMonitor::new(future));
+        } else {
+            self.tasks.spawn(future);
+        }
     }
 
     #[cfg(not(target_arch = "wasm32"))]
@@ -0,0 +1,86 @@
+//! Benchmarks for chunking bytes into (and re-assembling bytes from) linked
+//! [BodyChunkIpld] blocks.
+//!
+//! `cargo bench -p noosphere-core --features helpers --bench body_chunk`
+
+mod common;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use libipld_cbor::DagCborCodec;
+use noosphere_core::data::BodyChunkIpld;
+use noosphere_storage::{BlockStore, Storage};
+use rand::{rngs::StdRng, RngCore, SeedableRng};
+use std::hint::black_box;
+use tokio::runtime::Runtime;
+
+/// The sizes of the bodies being chunked, in bytes
+const BODY_SIZES: &[usize] = &[64 * 1024, 1024 * 1024, 16 * 1024 * 1024];
+
+fn random_bytes(size: usize) -> Vec<u8> {
+    let mut rng = StdRng::seed_from_u64(size as u64);
+    let mut bytes = vec![0u8; size];
+    rng.fill_bytes(&mut bytes);
+    bytes
+}
+
+fn bench_body_chunks<S>(c: &mut Criterion, runtime: &Runtime, storage_name: &str, storage: S)
+where
+    S: Storage + 'static,
+{
+    let store = runtime
+        .block_on(storage.get_block_store("blocks"))
+        .expect("Failed to open block store");
+
+    let mut group = c.benchmark_group(format!("body_chunk/{storage_name}"));
+    group.sample_size(20);
+
+    for &size in BODY_SIZES {
+        let bytes = random_bytes(size);
+
+        group.throughput(Throughput::Bytes(size as u64));
+
+        group.bench_with_input(BenchmarkId::new("store_bytes", size), &bytes, |b, bytes| {
+            b.to_async(runtime).iter(|| {
+                let mut store = store.clone();
+                async move {
+                    black_box(
+                        BodyChunkIpld::store_bytes(bytes, &mut store)
+                            .await
+                            .unwrap(),
+                    )
+                }
+            })
+        });
+
+        let head = runtime
+            .block_on(BodyChunkIpld::store_bytes(&bytes, &mut store.clone()))
+            .unwrap();
+
+        group.bench_with_input(
+            BenchmarkId::new("load_all_bytes", size),
+            &head,
+            |b, head| {
+                b.to_async(runtime).iter(|| async {
+                    let chunk: BodyChunkIpld = store.load::<DagCborCodec, _>(head).await.unwrap();
+                    black_box(chunk.load_all_bytes(&store).await.unwrap())
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
+fn bench_memory_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    bench_body_chunks(c, &runtime, "memory", common::memory_storage());
+}
+
+fn bench_sled_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    let fixture = common::SledFixture::new().unwrap();
+    bench_body_chunks(c, &runtime, "sled", fixture.storage.clone());
+}
+
+criterion_group!(benches, bench_memory_storage, bench_sled_storage);
+criterion_main!(benches);
@@ -0,0 +1,101 @@
+//! Benchmarks for encoding the blocks of a sphere as a CARv1 byte stream and
+//! decoding such a stream back into a block store, which is what happens on
+//! every push, fetch and replication request.
+//!
+//! `cargo bench -p noosphere-core --features helpers --bench car`
+
+mod common;
+
+use bytes::Bytes;
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use futures::{stream, StreamExt};
+use noosphere_core::stream::{from_car_stream, memo_body_stream, put_block_stream, to_car_stream};
+use noosphere_storage::{SphereDb, Storage};
+use std::hint::black_box;
+use tokio::runtime::Runtime;
+
+/// The number of slugs in the content space of the sphere being encoded
+const CONTENT_SIZES: &[usize] = &[100, 1_000, 10_000];
+
+fn bench_car<S>(c: &mut Criterion, runtime: &Runtime, storage_name: &str, storage: S)
+where
+    S: Storage + 'static,
+{
+    let db = runtime
+        .block_on(SphereDb::new(&storage))
+        .expect("Failed to open sphere database");
+    let decode_store = runtime
+        .block_on(storage.get_block_store("decoded_blocks"))
+        .expect("Failed to open block store");
+
+    let mut group = c.benchmark_group(format!("car/{storage_name}"));
+    group.sample_size(20);
+
+    for &slug_count in CONTENT_SIZES {
+        let (version, _) = runtime
+            .block_on(common::sphere_with_content(db.clone(), slug_count))
+            .expect("Failed to generate sphere");
+
+        let car_frames: Vec<Bytes> = runtime.block_on(async {
+            to_car_stream(
+                vec![version.into()],
+                memo_body_stream(db.clone(), &version, true),
+            )
+            .map(|frame| frame.unwrap())
+            .collect()
+            .await
+        });
+        let car_bytes: usize = car_frames.iter().map(|frame| frame.len()).sum();
+
+        group.throughput(Throughput::Bytes(car_bytes as u64));
+
+        group.bench_with_input(
+            BenchmarkId::new("encode", slug_count),
+            &version,
+            |b, version| {
+                b.to_async(runtime).iter(|| async {
+                    let car_stream = to_car_stream(
+                        vec![(*version).into()],
+                        memo_body_stream(db.clone(), version, true),
+                    );
+                    tokio::pin!(car_stream);
+
+                    while let Some(frame) = car_stream.next().await {
+                        black_box(frame.unwrap());
+                    }
+                })
+            },
+        );
+
+        group.bench_with_input(
+            BenchmarkId::new("decode", slug_count),
+            &car_frames,
+            |b, car_frames| {
+                b.to_async(runtime).iter(|| async {
+                    let car_stream =
+                        stream::iter(car_frames.clone().into_iter().map(Ok::<_, std::io::Error>));
+
+                    put_block_stream(decode_store.clone(), from_car_stream(car_stream))
+                        .await
+                        .unwrap();
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
+fn bench_memory_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    bench_car(c, &runtime, "memory", common::memory_storage());
+}
+
+fn bench_sled_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    let fixture = common::SledFixture::new().unwrap();
+    bench_car(c, &runtime, "sled", fixture.storage.clone());
+}
+
+criterion_group!(benches, bench_memory_storage, bench_sled_storage);
+criterion_main!(benches);
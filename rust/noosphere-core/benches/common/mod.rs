@@ -0,0 +1,102 @@
+//! Fixtures shared by the noosphere-core benchmarks. Every benchmark is run
+//! against both [MemoryStorage] and [SledStorage], so that regressions in the
+//! in-memory hot paths as well as in the on-disk paths are visible.
+
+#![allow(dead_code)]
+
+use anyhow::Result;
+use noosphere_core::{
+    authority::Access,
+    context::{HasMutableSphereContext, HasSphereContext, SphereContentWrite},
+    data::{ContentType, Did, Link, MemoIpld},
+    helpers::generate_sphere_context,
+};
+use noosphere_storage::{MemoryStorage, SledStorage, SphereDb, Storage};
+use tempfile::TempDir;
+use tokio::runtime::Runtime;
+
+/// Create the async runtime that benchmarks are driven by
+pub fn runtime() -> Runtime {
+    Runtime::new().expect("Failed to start benchmark runtime")
+}
+
+/// Create an empty, non-persisted [MemoryStorage]
+pub fn memory_storage() -> MemoryStorage {
+    MemoryStorage::default()
+}
+
+/// A [SledStorage] that is backed by a temporary directory, which is removed
+/// when the fixture is dropped
+pub struct SledFixture {
+    pub storage: SledStorage,
+    _temp_dir: TempDir,
+}
+
+impl SledFixture {
+    pub fn new() -> Result<Self> {
+        let temp_dir = TempDir::new()?;
+        let storage = SledStorage::new(temp_dir.path())?;
+
+        Ok(SledFixture {
+            storage,
+            _temp_dir: temp_dir,
+        })
+    }
+}
+
+/// Generate a sphere whose content space holds `slug_count` entries, all
+/// written in a single revision. Returns the version of that revision and the
+/// [Did] of the author that signed it.
+pub async fn sphere_with_content<S: Storage + 'static>(
+    db: SphereDb<S>,
+    slug_count: usize,
+) -> Result<(Link<MemoIpld>, Did)> {
+    let (mut sphere_context, _) = generate_sphere_context(Access::ReadWrite, db).await?;
+
+    for i in 0..slug_count {
+        sphere_context
+            .write(
+                &format!("slug-{i}"),
+                &ContentType::Subtext,
+                format!("Note number {i}").as_bytes(),
+                None,
+            )
+            .await?;
+    }
+
+    let version = sphere_context.save(None).await?;
+    let author = sphere_context
+        .sphere_context()
+        .await?
+        .author()
+        .did()
+        .await?;
+
+    Ok((version, author))
+}
+
+/// Generate a sphere with `revisions` revisions of history, where each
+/// revision re-writes one of a rotating set of `slug_count` slugs. Returns the
+/// version of the latest revision.
+pub async fn sphere_with_history<S: Storage + 'static>(
+    db: SphereDb<S>,
+    revisions: usize,
+    slug_count: usize,
+) -> Result<Link<MemoIpld>> {
+    let (mut sphere_context, _) = generate_sphere_context(Access::ReadWrite, db).await?;
+    let mut version = sphere_context.version().await?;
+
+    for i in 0..revisions {
+        sphere_context
+            .write(
+                &format!("slug-{}", i % slug_count),
+                &ContentType::Subtext,
+                format!("Revision number {i}").as_bytes(),
+                None,
+            )
+            .await?;
+        version = sphere_context.save(None).await?;
+    }
+
+    Ok(version)
+}
@@ -0,0 +1,114 @@
+//! Benchmarks for [Sphere] revision handling: applying mutations, hydrating
+//! sparsely-synchronized revisions and streaming long histories via
+//! [Timeline].
+//!
+//! `cargo bench -p noosphere-core --features helpers --bench sphere`
+
+mod common;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use futures::StreamExt;
+use noosphere_core::view::{Sphere, SphereMutation, Timeline};
+use noosphere_storage::{SphereDb, Storage};
+use std::hint::black_box;
+use tokio::runtime::Runtime;
+
+/// The number of slugs in the content space of the sphere being measured
+const CONTENT_SIZES: &[usize] = &[100, 1_000, 10_000];
+
+/// The number of revisions in the history of the sphere being measured
+const HISTORY_DEPTHS: &[usize] = &[100, 1_000];
+
+/// The number of content changes in each mutation that is applied
+const MUTATION_SIZE: usize = 10;
+
+fn bench_sphere_operations<S>(c: &mut Criterion, runtime: &Runtime, storage_name: &str, storage: S)
+where
+    S: Storage + 'static,
+{
+    let db = runtime
+        .block_on(SphereDb::new(&storage))
+        .expect("Failed to open sphere database");
+
+    let mut group = c.benchmark_group(format!("sphere/{storage_name}"));
+    group.sample_size(20);
+
+    for &slug_count in CONTENT_SIZES {
+        let (version, author) = runtime
+            .block_on(common::sphere_with_content(db.clone(), slug_count))
+            .expect("Failed to generate sphere");
+
+        let mut mutation = SphereMutation::new(&author);
+        for i in 0..MUTATION_SIZE {
+            mutation
+                .content_mut()
+                .set(&format!("new-slug-{i}"), &version);
+        }
+
+        group.bench_with_input(
+            BenchmarkId::new("apply_mutation", slug_count),
+            &version,
+            |b, version| {
+                b.to_async(runtime).iter(|| async {
+                    black_box(
+                        Sphere::at(version, &db)
+                            .apply_mutation(&mutation)
+                            .await
+                            .unwrap(),
+                    )
+                })
+            },
+        );
+
+        group.bench_with_input(
+            BenchmarkId::new("hydrate", slug_count),
+            &version,
+            |b, version| {
+                b.to_async(runtime)
+                    .iter(|| async { Sphere::at(version, &db).hydrate().await.unwrap() })
+            },
+        );
+    }
+
+    for &revisions in HISTORY_DEPTHS {
+        let version = runtime
+            .block_on(common::sphere_with_history(db.clone(), revisions, 100))
+            .expect("Failed to generate sphere history");
+
+        group.throughput(Throughput::Elements(revisions as u64));
+        group.bench_with_input(
+            BenchmarkId::new("timeline_stream", revisions),
+            &version,
+            |b, version| {
+                b.to_async(runtime).iter(|| async {
+                    let timeline = Timeline::new(&db);
+                    let mut stream = Box::pin(timeline.stream(version, None, false));
+                    let mut count = 0usize;
+
+                    while let Some(result) = stream.next().await {
+                        black_box(result.unwrap());
+                        count += 1;
+                    }
+
+                    assert!(count > revisions);
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
+fn bench_memory_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    bench_sphere_operations(c, &runtime, "memory", common::memory_storage());
+}
+
+fn bench_sled_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    let fixture = common::SledFixture::new().unwrap();
+    bench_sphere_operations(c, &runtime, "sled", fixture.storage.clone());
+}
+
+criterion_group!(benches, bench_memory_storage, bench_sled_storage);
+criterion_main!(benches);
@@ -0,0 +1,104 @@
+//! Benchmarks for applying mutations to versioned maps (via the [Content]
+//! alias) of various sizes.
+//!
+//! `cargo bench -p noosphere-core --features helpers --bench versioned_map`
+
+mod common;
+
+use anyhow::Result;
+use cid::Cid;
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use libipld_cbor::DagCborCodec;
+use noosphere_core::{
+    data::{Link, MemoIpld},
+    view::{Content, ContentMutation},
+};
+use noosphere_storage::{BlockStore, SphereDb, Storage};
+use std::hint::black_box;
+use tokio::runtime::Runtime;
+
+/// The number of entries in the map that mutations are applied to
+const MAP_SIZES: &[usize] = &[1_000, 10_000, 100_000];
+
+/// The number of changes in each mutation that is applied
+const MUTATION_SIZES: &[usize] = &[1, 10, 100];
+
+const AUTHOR: &str = "did:key:z6MkBenchmarkAuthor";
+
+fn make_mutation(prefix: &str, size: usize, value: &Link<MemoIpld>) -> ContentMutation {
+    let mut mutation = ContentMutation::new(AUTHOR);
+    for i in 0..size {
+        mutation.set(&format!("{prefix}-{i}"), value);
+    }
+    mutation
+}
+
+async fn populate<S: Storage + 'static>(
+    db: &mut SphereDb<S>,
+    size: usize,
+) -> Result<(Cid, Link<MemoIpld>)> {
+    let memo = MemoIpld::for_body(db, &Vec::<u8>::new()).await?;
+    let value: Link<MemoIpld> = db.save::<DagCborCodec, _>(&memo).await?.into();
+    let mutation = make_mutation("slug", size, &value);
+
+    let cid = Content::apply_with_cid(None::<&Cid>, &mutation, db).await?;
+
+    Ok((cid, value))
+}
+
+fn bench_apply_with_cid<S>(c: &mut Criterion, runtime: &Runtime, storage_name: &str, storage: S)
+where
+    S: Storage + 'static,
+{
+    let mut db = runtime
+        .block_on(SphereDb::new(&storage))
+        .expect("Failed to open sphere database");
+
+    let mut group = c.benchmark_group(format!("versioned_map/{storage_name}"));
+    group.sample_size(20);
+
+    for &map_size in MAP_SIZES {
+        let (map_cid, value) = runtime
+            .block_on(populate(&mut db, map_size))
+            .expect("Failed to populate versioned map");
+
+        for &mutation_size in MUTATION_SIZES {
+            let mutation = make_mutation("new-slug", mutation_size, &value);
+
+            group.throughput(Throughput::Elements(mutation_size as u64));
+            group.bench_with_input(
+                BenchmarkId::new(format!("apply_with_cid/{mutation_size}"), map_size),
+                &map_cid,
+                |b, map_cid| {
+                    b.to_async(runtime).iter(|| {
+                        let mut db = db.clone();
+                        let mutation = &mutation;
+                        async move {
+                            black_box(
+                                Content::apply_with_cid(Some(map_cid), mutation, &mut db)
+                                    .await
+                                    .unwrap(),
+                            )
+                        }
+                    })
+                },
+            );
+        }
+    }
+
+    group.finish();
+}
+
+fn bench_memory_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    bench_apply_with_cid(c, &runtime, "memory", common::memory_storage());
+}
+
+fn bench_sled_storage(c: &mut Criterion) {
+    let runtime = common::runtime();
+    let fixture = common::SledFixture::new().unwrap();
+    bench_apply_with_cid(c, &runtime, "sled", fixture.storage.clone());
+}
+
+criterion_group!(benches, bench_memory_storage, bench_sled_storage);
+criterion_main!(benches);
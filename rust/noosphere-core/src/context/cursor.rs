@@ -7,7 +7,7 @@ use crate::{
 use anyhow::{anyhow, Result};
 use async_trait::async_trait;
 use noosphere_common::StreamLatencyGuard;
-use noosphere_storage::Storage;
+use noosphere_storage::{with_io_operation, Storage};
 use tokio::select;
 
 use crate::context::{HasMutableSphereContext, HasSphereContext, SphereContext, SphereReplicaRead};
@@ -207,10 +207,14 @@ where
 
                     tokio::pin!(stream);
 
-                    let (stream, mut rx) = StreamLatencyGuard::wrap(stream, Duration::from_secs(5));
+                    let (stream, mut rx) =
+                        StreamLatencyGuard::wrap_named(stream, Duration::from_secs(5), "replicate");
+
+                    let put_blocks =
+                        with_io_operation("replicate", put_block_stream(db.clone(), stream));
 
                     select! {
-                        _ = put_block_stream(db.clone(), stream) => (),
+                        _ = put_blocks => (),
                         _ = rx.recv() => {
                             return Err(anyhow!("Block timed out"))
                         }
@@ -239,9 +243,11 @@ where
 
         let sphere = self.to_sphere().await?;
 
-        let peer_sphere = match sphere
-            .traverse_by_petnames(petname_path, &replicate)
-            .await?
+        let peer_sphere = match with_io_operation(
+            "traverse",
+            sphere.traverse_by_petnames(petname_path, &replicate),
+        )
+        .await?
         {
             Some(sphere) => sphere,
             None => return Ok(None),
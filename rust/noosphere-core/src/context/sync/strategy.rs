@@ -77,6 +77,7 @@ where
     /// Synchronize a local sphere's data with the data in a gateway, and rollback
     /// if there is an error. The returned [Link] is the latest version of the local
     /// sphere lineage after the sync has completed.
+    #[instrument(level = "debug", skip(self, context))]
     pub async fn sync(
         &self,
         context: &mut C,
@@ -4,6 +4,7 @@ use crate::authority::{
 use anyhow::Result;
 use cid::Cid;
 use libipld_cbor::DagCborCodec;
+use noosphere_common::synchronous_section;
 use noosphere_storage::BlockStore;
 use noosphere_ucan::{chain::ProofChain, crypto::did::DidParser, store::UcanJwtStore, Ucan};
 use serde::{de, ser, Deserialize, Serialize};
@@ -90,6 +91,7 @@ impl LinkRecord {
     /// content address. Notably does not check the publishing timeframe
     /// permissions, as an expired token can be considered valid.
     /// Returns an `Err` if validation fails.
+    #[instrument(level = "debug", skip(self, store))]
     pub async fn validate<S: UcanJwtStore>(&self, store: &S) -> Result<()> {
         let identity = self.to_sphere_identity();
         let token = &self.0;
@@ -128,6 +130,10 @@ impl LinkRecord {
             }
         }
 
+        // Signature checks are asynchronous in name only; they run to completion
+        // on the executor
+        let _section = synchronous_section("signature_verification");
+
         token
             .check_signature(&mut did_parser)
             .await
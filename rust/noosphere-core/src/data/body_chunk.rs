@@ -4,7 +4,7 @@ use fastcdc::v2020::FastCDC;
 use libipld_cbor::DagCborCodec;
 use serde::{Deserialize, Serialize};
 
-use noosphere_storage::BlockStore;
+use noosphere_storage::{block_serialize, BlockStore};
 
 /// The maximum size of a body chunk as produced by [BodyChunkIpld]
 pub const BODY_CHUNK_MAX_SIZE: u32 = 1024 * 1024; // ~1mb/chunk worst case, ~.5mb/chunk average case
@@ -26,6 +26,21 @@ impl BodyChunkIpld {
     /// and returning the [Cid] of the head of the list.
     // TODO(#498): Re-write to address potentially unbounded memory overhead
     pub async fn store_bytes<S: BlockStore>(bytes: &[u8], store: &mut S) -> Result<Cid> {
+        let (head, blocks) = BodyChunkIpld::encode_bytes(bytes)?;
+
+        for (cid, block) in blocks {
+            store.put_block(&cid, &block).await?;
+            store.put_links::<DagCborCodec>(&cid, &block).await?;
+        }
+
+        Ok(head)
+    }
+
+    /// Chunk and encode a slice of bytes as linked [BodyChunkIpld] without
+    /// storing them, returning the [Cid] of the head of the list along with
+    /// every encoded chunk (tail first). This is the CPU-bound part of
+    /// [BodyChunkIpld::store_bytes], so it may be run on a blocking thread.
+    pub fn encode_bytes(bytes: &[u8]) -> Result<(Cid, Vec<(Cid, Vec<u8>)>)> {
         let chunks = FastCDC::new(
             bytes,
             fastcdc::v2020::MINIMUM_MIN,
@@ -44,19 +59,22 @@ impl BodyChunkIpld {
         }
 
         let mut next_chunk_cid = None;
+        let mut blocks = Vec::with_capacity(byte_chunks.len());
 
         for byte_chunk in byte_chunks.into_iter().rev() {
-            next_chunk_cid = Some(
-                store
-                    .save::<DagCborCodec, _>(&BodyChunkIpld {
-                        bytes: Vec::from(byte_chunk),
-                        next: next_chunk_cid,
-                    })
-                    .await?,
-            );
+            let (cid, block) = block_serialize::<DagCborCodec, _>(&BodyChunkIpld {
+                bytes: Vec::from(byte_chunk),
+                next: next_chunk_cid,
+            })?;
+
+            next_chunk_cid = Some(cid);
+            blocks.push((cid, block));
         }
 
-        next_chunk_cid.ok_or_else(|| anyhow!("No CID; did you try to store zero bytes?"))
+        let head =
+            next_chunk_cid.ok_or_else(|| anyhow!("No CID; did you try to store zero bytes?"))?;
+
+        Ok((head, blocks))
     }
 
     /// Fold all bytes in the [BodyChunkIpld] chain into a single buffer and return it
@@ -75,3 +93,68 @@ impl BodyChunkIpld {
         Ok(all_bytes)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::{BodyChunkIpld, BODY_CHUNK_MAX_SIZE};
+    use anyhow::Result;
+    use cid::{
+        multihash::{Code, MultihashDigest},
+        Cid,
+    };
+    use libipld_cbor::DagCborCodec;
+    use noosphere_storage::{block_deserialize, BlockStore, MemoryStore};
+    use std::collections::BTreeMap;
+
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    const DAG_CBOR_CODEC: u64 = 0x71;
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_encodes_a_chain_of_content_addressed_chunks() -> Result<()> {
+        let bytes: Vec<u8> = (0..(BODY_CHUNK_MAX_SIZE * 3))
+            .map(|index| (index.wrapping_mul(2654435761) >> 13) as u8)
+            .collect();
+
+        let (head, blocks) = BodyChunkIpld::encode_bytes(&bytes)?;
+        assert!(blocks.len() > 1);
+
+        // Every block is addressed by the hash of its own bytes
+        let mut blocks_by_cid = BTreeMap::new();
+        for (cid, block) in blocks {
+            let expected_cid = Cid::new_v1(DAG_CBOR_CODEC, Code::Blake3_256.digest(&block));
+            assert_eq!(cid, expected_cid);
+            blocks_by_cid.insert(cid, block);
+        }
+
+        // Following the chain from its head yields the original bytes, in
+        // chunks no larger than the maximum, through every block exactly once
+        let mut chained_bytes = Vec::new();
+        let mut next = Some(head);
+        while let Some(cid) = next {
+            let block = blocks_by_cid.remove(&cid).expect("chain links to a block");
+            let chunk: BodyChunkIpld = block_deserialize::<DagCborCodec, _>(&block)?;
+
+            assert!(chunk.bytes.len() <= BODY_CHUNK_MAX_SIZE as usize);
+            chained_bytes.extend_from_slice(&chunk.bytes);
+            next = chunk.next;
+        }
+        assert!(blocks_by_cid.is_empty());
+        assert_eq!(chained_bytes, bytes);
+
+        // Storing the bytes persists the same chain
+        let mut store = MemoryStore::default();
+        let stored = BodyChunkIpld::store_bytes(&bytes, &mut store).await?;
+        assert_eq!(stored, head);
+
+        let stored_chunk: BodyChunkIpld = store.load::<DagCborCodec, _>(&stored).await?;
+        assert_eq!(stored_chunk.load_all_bytes(&store).await?, bytes);
+
+        Ok(())
+    }
+}
@@ -0,0 +1,465 @@
+//! A seeded generator for synthetic spheres, intended to give benchmarks and
+//! load tests large, realistically shaped datasets. Content (slugs, file sizes
+//! and bytes), the shape of the petname graph and the delegated keys are all
+//! derived from the seed. Sphere identities and signatures are not, so to use
+//! exactly the same dataset across runs, generate it once and share it as a
+//! CAR fixture (see [SphereFixture::export] and [SphereFixture::import]).
+
+use std::{sync::Arc, time::Duration};
+
+use anyhow::{anyhow, Result};
+use bytes::Bytes;
+use cid::Cid;
+use ed25519_dalek::{SigningKey as Ed25519PrivateKey, VerifyingKey as Ed25519PublicKey};
+use futures::{stream, StreamExt, TryStreamExt};
+use iroh_car::CarReader;
+use noosphere_storage::{SphereDb, Storage};
+use noosphere_ucan::{crypto::KeyMaterial, key_material::ed25519::Ed25519KeyMaterial};
+use rand::{rngs::StdRng, Rng, RngCore, SeedableRng};
+use tokio::sync::Mutex;
+use tokio_stream::Stream;
+use tokio_util::io::StreamReader;
+
+use crate::{
+    authority::{Access, Author, Authorization},
+    context::{
+        HasMutableSphereContext, HasSphereContext, SphereAuthorityWrite, SphereContentWrite,
+        SphereContext, SpherePetnameWrite, SphereReplicaWrite,
+    },
+    data::{ContentType, Did, Link, MemoIpld},
+    stream::{memo_history_stream, put_block_stream, to_car_stream},
+    view::Sphere,
+};
+
+use super::generate_sphere_context;
+
+/// Link records in a fixture are long-lived, so that a fixture that is
+/// exported today can still be resolved when it is imported much later
+const FIXTURE_LINK_RECORD_LIFETIME: Duration = Duration::from_secs(10 * 365 * 24 * 60 * 60);
+
+/// Derive an [Ed25519KeyMaterial] from `rng`, so that the same key is
+/// produced for the same seed
+fn generate_seeded_ed25519_key(rng: &mut StdRng) -> Ed25519KeyMaterial {
+    let private_key = Ed25519PrivateKey::generate(rng);
+    Ed25519KeyMaterial(Ed25519PublicKey::from(&private_key), Some(private_key))
+}
+
+/// Open a [SphereContext] for the sphere at `version`, authored by `key`
+async fn open_sphere_context<S>(
+    key: Ed25519KeyMaterial,
+    authorization: Authorization,
+    version: &Link<MemoIpld>,
+    mut db: SphereDb<S>,
+) -> Result<Arc<Mutex<SphereContext<S>>>>
+where
+    S: Storage + 'static,
+{
+    let identity = Sphere::at(version, &db).get_identity().await?;
+
+    db.set_version(&identity, version).await?;
+
+    Ok(Arc::new(Mutex::new(
+        SphereContext::new(
+            identity,
+            Author {
+                key: Arc::new(Box::new(key)),
+                authorization: Some(authorization),
+            },
+            db,
+            None,
+        )
+        .await?,
+    )))
+}
+
+/// The distribution that the sizes of the files written to a synthetic sphere
+/// are drawn from
+#[derive(Clone, Debug)]
+pub enum FileSizeDistribution {
+    /// Every file is the same size
+    Fixed(usize),
+    /// File sizes are uniformly distributed between `min` and `max`
+    /// (inclusive)
+    Uniform {
+        /// The smallest file size
+        min: usize,
+        /// The largest file size
+        max: usize,
+    },
+    /// Most files are small and a few are large, as is typical of notes with
+    /// the occasional attachment; sizes larger than `max` are clamped
+    Exponential {
+        /// The mean file size
+        mean: usize,
+        /// The largest file size
+        max: usize,
+    },
+}
+
+impl FileSizeDistribution {
+    /// Draw a file size from the distribution
+    pub fn sample<R: Rng>(&self, rng: &mut R) -> usize {
+        match self {
+            FileSizeDistribution::Fixed(size) => *size,
+            FileSizeDistribution::Uniform { min, max } => rng.gen_range(*min..=(*max).max(*min)),
+            FileSizeDistribution::Exponential { mean, max } => {
+                let uniform: f64 = rng.gen_range(f64::EPSILON..1.0);
+                ((-uniform.ln() * *mean as f64) as usize).min(*max)
+            }
+        }
+    }
+}
+
+/// The shape of a synthetic sphere; see [SphereFixtureConfig::generate]
+#[derive(Clone, Debug)]
+pub struct SphereFixtureConfig {
+    /// Seeds all of the random choices made while generating the sphere
+    pub seed: u64,
+    /// The number of distinct slugs that content is written to
+    pub slugs: usize,
+    /// The number of revisions in the sphere's history
+    pub revisions: usize,
+    /// The number of files written in each revision
+    pub writes_per_revision: usize,
+    /// The distribution of the sizes of written files
+    pub file_sizes: FileSizeDistribution,
+    /// The number of petnames in the address book of each sphere in the
+    /// petname graph (other than those at its deepest level)
+    pub petname_fan_out: usize,
+    /// The number of levels of peers below the generated sphere; there are
+    /// `petname_fan_out ^ level` peer spheres at each level
+    pub petname_depth: usize,
+    /// The number of keys that are granted authority to the sphere
+    pub delegations: usize,
+}
+
+impl Default for SphereFixtureConfig {
+    fn default() -> Self {
+        SphereFixtureConfig {
+            seed: 0,
+            slugs: 256,
+            revisions: 256,
+            writes_per_revision: 4,
+            file_sizes: FileSizeDistribution::Exponential {
+                mean: 16 * 1024,
+                max: 1024 * 1024,
+            },
+            petname_fan_out: 4,
+            petname_depth: 2,
+            delegations: 8,
+        }
+    }
+}
+
+/// A generated (or imported) sphere, along with every peer sphere in its
+/// petname graph. All of the spheres share one [SphereDb].
+pub struct SphereFixture<S>
+where
+    S: Storage + 'static,
+{
+    /// The generated sphere, with full access
+    pub context: Arc<Mutex<SphereContext<S>>>,
+    /// The latest versions of the generated sphere followed by those of all
+    /// of its peers
+    pub versions: Vec<Link<MemoIpld>>,
+    authorization: Authorization,
+    db: SphereDb<S>,
+}
+
+impl SphereFixtureConfig {
+    /// Generate a sphere in `db` with the configured shape. Peers are
+    /// generated first (deepest level first), then delegations are made, and
+    /// finally the content history is written. Fails if content is to be
+    /// written but there are no slugs to write it to.
+    pub async fn generate<S>(&self, mut db: SphereDb<S>) -> Result<SphereFixture<S>>
+    where
+        S: Storage + 'static,
+    {
+        if self.slugs == 0 && self.revisions * self.writes_per_revision > 0 {
+            return Err(anyhow!(
+                "Cannot write {} files per revision without any slugs to write them to",
+                self.writes_per_revision
+            ));
+        }
+
+        let mut rng = StdRng::seed_from_u64(self.seed);
+        // The owner key must be the first thing drawn from the seed, so that
+        // [SphereFixture::import] can derive it again
+        let owner_key = generate_seeded_ed25519_key(&mut rng);
+        let mut peer_versions = Vec::new();
+        let mut level: Vec<Arc<Mutex<SphereContext<S>>>> = Vec::new();
+
+        for depth in (1..=self.petname_depth).rev() {
+            let count = self.petname_fan_out.pow(depth as u32);
+            let mut next_level = Vec::with_capacity(count);
+
+            for index in 0..count {
+                let (mut peer, _) = generate_sphere_context(Access::ReadWrite, db.clone()).await?;
+                let children = level
+                    .iter_mut()
+                    .skip(index * self.petname_fan_out)
+                    .take(self.petname_fan_out);
+
+                adopt_peers(&mut peer, children).await?;
+
+                peer.write(
+                    "index",
+                    &ContentType::Subtext,
+                    format!("Peer {index} at depth {depth}").as_bytes(),
+                    None,
+                )
+                .await?;
+                peer_versions.push(peer.save(None).await?);
+                next_level.push(peer);
+            }
+
+            level = next_level;
+        }
+
+        let (sphere, authorization, _) =
+            Sphere::generate(&owner_key.get_did().await?, &mut db).await?;
+        let mut context =
+            open_sphere_context(owner_key, authorization.clone(), sphere.cid(), db.clone()).await?;
+
+        if !level.is_empty() {
+            adopt_peers(&mut context, level.iter_mut()).await?;
+            context.save(None).await?;
+        }
+
+        if self.delegations > 0 {
+            for index in 0..self.delegations {
+                let key = generate_seeded_ed25519_key(&mut rng);
+
+                context
+                    .authorize(&format!("device-{index}"), &Did(key.get_did().await?))
+                    .await?;
+            }
+
+            context.save(None).await?;
+        }
+
+        let mut bytes = Vec::new();
+        let mut writes = 0usize;
+
+        for _ in 0..self.revisions {
+            for _ in 0..self.writes_per_revision {
+                // Visit every slug once before revisiting any of them
+                let slug_index = if writes < self.slugs {
+                    writes
+                } else {
+                    rng.gen_range(0..self.slugs)
+                };
+
+                bytes.resize(self.file_sizes.sample(&mut rng), 0);
+                rng.fill_bytes(&mut bytes);
+
+                context
+                    .write(
+                        &format!("slug-{slug_index}"),
+                        &ContentType::Bytes,
+                        bytes.as_slice(),
+                        None,
+                    )
+                    .await?;
+
+                writes += 1;
+            }
+
+            context.save(None).await?;
+        }
+
+        let mut versions = vec![context.version().await?];
+        versions.append(&mut peer_versions);
+
+        Ok(SphereFixture {
+            context,
+            versions,
+            authorization,
+            db,
+        })
+    }
+}
+
+async fn adopt_peers<'a, S, I>(context: &mut Arc<Mutex<SphereContext<S>>>, peers: I) -> Result<()>
+where
+    S: Storage + 'static,
+    I: Iterator<Item = &'a mut Arc<Mutex<SphereContext<S>>>>,
+{
+    for (index, peer) in peers.enumerate() {
+        let name = format!("peer-{index}");
+        let record = peer
+            .create_link_record(Some(FIXTURE_LINK_RECORD_LIFETIME))
+            .await?;
+
+        context
+            .set_petname(&name, Some(peer.identity().await?))
+            .await?;
+        context.save(None).await?;
+        context.set_petname_record(&name, &record).await?;
+    }
+
+    Ok(())
+}
+
+impl<S> SphereFixture<S>
+where
+    S: Storage + 'static,
+{
+    /// Stream the complete history (including content) of the sphere and all
+    /// of its peers as a CARv1. The first root of the CAR is the latest
+    /// version of the sphere, the second is the authorization of its owner,
+    /// and the rest are the latest versions of its peers.
+    pub fn export(&self) -> Result<impl Stream<Item = Result<Bytes, std::io::Error>> + '_> {
+        let mut roots: Vec<Cid> = self
+            .versions
+            .iter()
+            .map(|version| Cid::from(*version))
+            .collect();
+        roots.insert(1, Cid::try_from(&self.authorization)?);
+
+        let blocks = stream::iter(
+            self.versions
+                .iter()
+                .map(|version| memo_history_stream(self.db.clone(), version, None, true)),
+        )
+        .flatten();
+
+        Ok(to_car_stream(roots, blocks))
+    }
+
+    /// Import a CARv1 that was produced by [SphereFixture::export] into `db`.
+    /// The fixture must have been generated with the same `seed`, which is
+    /// used to derive the owner key so that the sphere can be opened with full
+    /// access.
+    pub async fn import<Str, E>(db: SphereDb<S>, car: Str, seed: u64) -> Result<SphereFixture<S>>
+    where
+        Str: Stream<Item = Result<Bytes, E>> + Unpin,
+        E: std::error::Error + Send + Sync + 'static,
+    {
+        let reader =
+            CarReader::new(StreamReader::new(car.map_err(|error| {
+                std::io::Error::new(std::io::ErrorKind::Other, error)
+            })))
+            .await?;
+        let roots = reader.header().roots().to_vec();
+
+        put_block_stream(db.clone(), reader.stream().map_err(anyhow::Error::from)).await?;
+
+        let (version, authorization, peers) = match roots.as_slice() {
+            [version, authorization, peers @ ..] => (*version, *authorization, peers),
+            _ => {
+                return Err(anyhow!(
+                    "Fixture is missing its sphere or authorization root"
+                ))
+            }
+        };
+
+        let mut versions = vec![Link::from(version)];
+
+        for peer in peers {
+            let peer = Link::from(*peer);
+            let identity = Sphere::at(&peer, &db).get_identity().await?;
+
+            db.clone().set_version(&identity, &peer).await?;
+            versions.push(peer);
+        }
+
+        let owner_key = generate_seeded_ed25519_key(&mut StdRng::seed_from_u64(seed));
+        let authorization = Authorization::Cid(authorization);
+        let context =
+            open_sphere_context(owner_key, authorization.clone(), &versions[0], db.clone()).await?;
+
+        Ok(SphereFixture {
+            context,
+            versions,
+            authorization,
+            db,
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use anyhow::Result;
+    use noosphere_storage::{MemoryStorage, SphereDb};
+    use tokio_stream::StreamExt;
+
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    use super::{FileSizeDistribution, SphereFixture, SphereFixtureConfig};
+    use crate::context::{HasSphereContext, SphereContentRead, SpherePetnameRead};
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_round_trips_a_generated_sphere_through_a_car() -> Result<()> {
+        let config = SphereFixtureConfig {
+            seed: 42,
+            slugs: 8,
+            revisions: 4,
+            writes_per_revision: 3,
+            file_sizes: FileSizeDistribution::Uniform { min: 16, max: 256 },
+            petname_fan_out: 2,
+            petname_depth: 2,
+            delegations: 2,
+        };
+
+        let fixture = config
+            .generate(SphereDb::new(&MemoryStorage::default()).await?)
+            .await?;
+
+        // One root sphere, two peers at depth 1 and four at depth 2
+        assert_eq!(fixture.versions.len(), 7);
+
+        let car = fixture.export()?.collect::<Vec<_>>().await;
+        let imported = SphereFixture::import(
+            SphereDb::new(&MemoryStorage::default()).await?,
+            tokio_stream::iter(car),
+            config.seed,
+        )
+        .await?;
+
+        assert_eq!(imported.versions, fixture.versions);
+        assert_eq!(
+            imported.context.version().await?,
+            fixture.context.version().await?
+        );
+        assert!(imported.context.read("slug-7").await?.is_some());
+        assert!(imported.context.get_petname("peer-1").await?.is_some());
+
+        Ok(())
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_refuses_to_write_content_without_slugs() -> Result<()> {
+        let config = SphereFixtureConfig {
+            slugs: 0,
+            revisions: 2,
+            writes_per_revision: 1,
+            petname_depth: 0,
+            delegations: 0,
+            ..Default::default()
+        };
+
+        assert!(config
+            .generate(SphereDb::new(&MemoryStorage::default()).await?)
+            .await
+            .is_err());
+
+        let config = SphereFixtureConfig {
+            writes_per_revision: 0,
+            ..config
+        };
+
+        assert!(config
+            .generate(SphereDb::new(&MemoryStorage::default()).await?)
+            .await
+            .is_ok());
+
+        Ok(())
+    }
+}
@@ -2,7 +2,9 @@
 //! setup for examples
 
 mod context;
+mod fixture;
 mod link;
 
 pub use context::*;
+pub use fixture::*;
 pub use link::*;
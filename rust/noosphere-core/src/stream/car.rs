@@ -2,10 +2,13 @@ use anyhow::Result;
 use async_stream::try_stream;
 use bytes::Bytes;
 use cid::Cid;
-use futures_util::{sink::SinkExt, TryStreamExt};
+use futures_util::{sink::SinkExt, StreamExt, TryStreamExt};
 use iroh_car::{CarHeader, CarReader, CarWriter};
-use noosphere_common::ConditionalSend;
-use std::io::{Error as IoError, ErrorKind as IoErrorKind};
+use noosphere_common::{stall_detection_enabled, ConditionalSend, StreamLatencyGuard};
+use std::{
+    io::{Error as IoError, ErrorKind as IoErrorKind},
+    time::Duration,
+};
 use tokio::sync::mpsc::channel;
 use tokio_stream::Stream;
 use tokio_util::{
@@ -13,6 +16,11 @@ use tokio_util::{
     sync::PollSender,
 };
 
+/// How long a CAR stream may go without yielding a block before it is
+/// reported as stalled (only while stall detection is enabled; see
+/// [noosphere_common::enable_stall_detection])
+const CAR_STREAM_STALL_THRESHOLD: Duration = Duration::from_secs(5);
+
 /// Takes a [Bytes] stream and interprets it as a
 /// [CARv1](https://ipld.io/specs/transport/car/carv1/), returning a stream of
 /// `(Cid, Vec<u8>)` blocks.
@@ -25,7 +33,7 @@ where
 {
     let stream = stream.map_err(|error| std::io::Error::new(std::io::ErrorKind::Other, error));
 
-    try_stream! {
+    let block_stream = try_stream! {
         tokio::pin!(stream);
 
         let reader = CarReader::new(StreamReader::new(stream)).await?;
@@ -36,6 +44,19 @@ where
         while let Some(entry) = tokio_stream::StreamExt::try_next(&mut stream).await? {
             yield entry;
         }
+    };
+
+    let block_stream = Box::pin(block_stream);
+
+    // The guard only reports stalls (it does not act on them), so it is only
+    // worth its overhead while stall detection is enabled
+    if stall_detection_enabled() {
+        let (guarded_stream, _) =
+            StreamLatencyGuard::wrap_named(block_stream, CAR_STREAM_STALL_THRESHOLD, "car");
+
+        guarded_stream.left_stream()
+    } else {
+        block_stream.right_stream()
     }
 }
 
@@ -240,7 +240,7 @@ mod inner {
         INITIALIZE_TRACING.call_once(|| {
             if let Err(error) = initialize_tracing_subscriber::<
                 Option<Box<dyn Layer<Registry> + Send + Sync>>,
-            >(noosphere_log, None)
+            >(noosphere_log, None, true)
             {
                 println!("Failed to initialize tracing: {}", error);
             }
@@ -254,7 +254,25 @@ mod inner {
         T: Layer<Registry> + Send + Sync + Sized,
     {
         INITIALIZE_TRACING.call_once(|| {
-            if let Err(error) = initialize_tracing_subscriber(noosphere_log, layer) {
+            if let Err(error) = initialize_tracing_subscriber(noosphere_log, layer, true) {
+                println!("Failed to initialize tracing: {}", error);
+            }
+        });
+    }
+
+    /// Identical to [initialize_tracing_with_layer], except that the log
+    /// filter only applies to log output and not to `layer`. This allows a
+    /// [Layer] to observe spans that are more verbose than what is logged (for
+    /// example, to profile them); such a [Layer] should apply its own filter
+    /// with [Layer::with_filter].
+    pub fn initialize_tracing_with_unfiltered_layer<T>(
+        noosphere_log: Option<NoosphereLog>,
+        layer: T,
+    ) where
+        T: Layer<Registry> + Send + Sync + Sized,
+    {
+        INITIALIZE_TRACING.call_once(|| {
+            if let Err(error) = initialize_tracing_subscriber(noosphere_log, layer, false) {
                 println!("Failed to initialize tracing: {}", error);
             }
         });
@@ -263,6 +281,7 @@ mod inner {
     fn initialize_tracing_subscriber<T>(
         noosphere_log: Option<NoosphereLog>,
         layer: T,
+        filter_layer: bool,
     ) -> anyhow::Result<()>
     where
         T: Layer<Registry> + Send + Sync + Sized,
@@ -328,55 +347,43 @@ mod inner {
             env_filter = env_filter.add_directive(directive)
         }
 
-        let subscriber = layer
-            .and_then(env_filter)
-            .with_subscriber(tracing_subscriber::registry());
-
-        match noosphere_log_format {
-            NoosphereLogFormat::Minimal => {
-                let subscriber = subscriber.with(
-                    FmtLayer::default().event_format(NoosphereMinimalFormatter::new(
-                        tracing_subscriber::fmt::format()
-                            .without_time()
-                            .with_target(false)
-                            .with_ansi(USE_ANSI_COLORS),
-                    )),
-                );
-
-                #[cfg(feature = "sentry")]
-                let subscriber = subscriber.with(sentry_tracing::layer());
-
-                subscriber.init();
-            }
-            NoosphereLogFormat::Verbose => {
-                let subscriber =
-                    subscriber.with(tracing_subscriber::fmt::layer().with_ansi(USE_ANSI_COLORS));
-
-                #[cfg(feature = "sentry")]
-                let subscriber = subscriber.with(sentry_tracing::layer());
-
-                subscriber.init();
-            }
-            NoosphereLogFormat::Pretty => {
-                let subscriber =
-                    subscriber.with(FmtLayer::default().pretty().with_ansi(USE_ANSI_COLORS));
-
-                #[cfg(feature = "sentry")]
-                let subscriber = subscriber.with(sentry_tracing::layer());
-
-                subscriber.init();
-            }
-            NoosphereLogFormat::Structured => {
-                let subscriber =
-                    subscriber.with(FmtLayer::default().json().with_ansi(USE_ANSI_COLORS));
-
-                #[cfg(feature = "sentry")]
-                let subscriber = subscriber.with(sentry_tracing::layer());
-
-                subscriber.init();
-            }
+        let output: Box<dyn Layer<Registry> + Send + Sync> = match noosphere_log_format {
+            NoosphereLogFormat::Minimal => FmtLayer::default()
+                .event_format(NoosphereMinimalFormatter::new(
+                    tracing_subscriber::fmt::format()
+                        .without_time()
+                        .with_target(false)
+                        .with_ansi(USE_ANSI_COLORS),
+                ))
+                .boxed(),
+            NoosphereLogFormat::Verbose => tracing_subscriber::fmt::layer()
+                .with_ansi(USE_ANSI_COLORS)
+                .boxed(),
+            NoosphereLogFormat::Pretty => FmtLayer::default()
+                .pretty()
+                .with_ansi(USE_ANSI_COLORS)
+                .boxed(),
+            NoosphereLogFormat::Structured => FmtLayer::default()
+                .json()
+                .with_ansi(USE_ANSI_COLORS)
+                .boxed(),
         };
 
+        #[cfg(feature = "sentry")]
+        let output = output.and_then(sentry_tracing::layer());
+
+        if filter_layer {
+            tracing_subscriber::registry()
+                .with(layer.and_then(env_filter).and_then(output))
+                .init();
+        } else {
+            // The log filter only applies to the output, so that `layer`
+            // observes everything that it is interested in
+            tracing_subscriber::registry()
+                .with(layer.and_then(output.with_filter(env_filter)))
+                .init();
+        }
+
         Ok(())
     }
 
@@ -27,7 +27,9 @@ use crate::{
     view::{Content, SphereMutation, SphereRevision, Timeline},
 };
 
-use noosphere_storage::{base64_decode, block_serialize, BlockStore, SphereDb, Storage, UcanStore};
+use noosphere_storage::{
+    base64_decode, block_serialize, with_io_operation, BlockStore, SphereDb, Storage, UcanStore,
+};
 
 use super::{address::AddressBook, Authority, Delegations, Identities, Revocations, Timeslice};
 
@@ -545,14 +547,18 @@ impl<S: BlockStore> Sphere<S> {
     /// "Hydrate" a range of revisions of a sphere, defined by a [Timeslice].
     /// See the comments on the `try_hydrate` method for details and
     /// implications.
+    #[instrument(level = "debug", skip(timeslice))]
     pub async fn hydrate_timeslice<'a>(timeslice: &Timeslice<'a, S>) -> Result<()> {
-        let items = timeslice.to_chronological().await?;
+        with_io_operation("hydrate", async {
+            let items = timeslice.to_chronological().await?;
 
-        for cid in items {
-            Sphere::at(&cid, timeslice.timeline.store).hydrate().await?;
-        }
+            for cid in items {
+                Sphere::at(&cid, timeslice.timeline.store).hydrate().await?;
+            }
 
-        Ok(())
+            Ok(())
+        })
+        .await
     }
 
     /// Attempt to "hydrate" the sphere at the current revision by replaying all
@@ -567,6 +573,10 @@ impl<S: BlockStore> Sphere<S> {
 
     /// Same as try_hydrate, but specifying the CID to hydrate at
     pub async fn hydrate_with_cid(cid: &Link<MemoIpld>, store: &mut S) -> Result<()> {
+        with_io_operation("hydrate", Sphere::hydrate_with_cid_inner(cid, store)).await
+    }
+
+    async fn hydrate_with_cid_inner(cid: &Link<MemoIpld>, store: &mut S) -> Result<()> {
         trace!("Hydrating {}...", cid);
         let sphere = Sphere::at(cid, store);
         let memo = sphere.to_memo().await?;
@@ -637,6 +647,7 @@ impl<S: BlockStore> Sphere<S> {
 
     /// Attempt to linearize the canonical history of the sphere by re-basing
     /// the history onto a branch with an implicitly common lineage.
+    #[instrument(level = "debug", skip(self, credential, authorization))]
     pub async fn rebase<Credential: KeyMaterial>(
         &self,
         old_base: &Link<MemoIpld>,
@@ -2,9 +2,11 @@ use crate::handlers;
 use crate::GatewayManager;
 use anyhow::Result;
 use axum::extract::DefaultBodyLimit;
-use axum::http::{HeaderValue, Method};
+use axum::http::{header, HeaderValue, Method};
+use axum::middleware::from_fn_with_state;
 use axum::routing::{get, put};
 use axum::{serve, Extension, Router};
+use noosphere_common::metrics::{metrics, PROMETHEUS_CONTENT_TYPE};
 use noosphere_core::api::{v0alpha1, v0alpha2};
 use noosphere_core::context::HasMutableSphereContext;
 use noosphere_ipfs::KuboClient;
@@ -59,30 +61,55 @@ impl Gateway {
 
         let router = Router::new()
             .route("/healthz", get(|| async {}))
+            .route(
+                "/metrics",
+                get(|| async {
+                    (
+                        [(header::CONTENT_TYPE, PROMETHEUS_CONTENT_TYPE)],
+                        metrics().encode(),
+                    )
+                }),
+            )
             .route(
                 &v0alpha1::Route::Did.to_string(),
-                get(handlers::v0alpha1::did_route::<C, S>),
+                get(handlers::v0alpha1::did_route::<C, S>)
+                    .layer(from_fn_with_state("did", handlers::record_request_duration)),
             )
             .route(
                 &v0alpha1::Route::Replicate(None).to_string(),
-                get(handlers::v0alpha1::replicate_route::<M, C, S>),
+                get(handlers::v0alpha1::replicate_route::<M, C, S>).layer(from_fn_with_state(
+                    "replicate",
+                    handlers::record_request_duration,
+                )),
             )
             .route(
                 &v0alpha1::Route::Identify.to_string(),
-                get(handlers::v0alpha1::identify_route::<M, C, S>),
+                get(handlers::v0alpha1::identify_route::<M, C, S>).layer(from_fn_with_state(
+                    "identify",
+                    handlers::record_request_duration,
+                )),
             )
             .route(
                 &v0alpha1::Route::Push.to_string(),
                 #[allow(deprecated)]
-                put(handlers::v0alpha1::push_route::<M, C, S>),
+                put(handlers::v0alpha1::push_route::<M, C, S>).layer(from_fn_with_state(
+                    "push",
+                    handlers::record_request_duration,
+                )),
             )
             .route(
                 &v0alpha2::Route::Push.to_string(),
-                put(handlers::v0alpha2::push_route::<M, C, S>),
+                put(handlers::v0alpha2::push_route::<M, C, S>).layer(from_fn_with_state(
+                    "push",
+                    handlers::record_request_duration,
+                )),
             )
             .route(
                 &v0alpha1::Route::Fetch.to_string(),
-                get(handlers::v0alpha1::fetch_route::<M, C, S>),
+                get(handlers::v0alpha1::fetch_route::<M, C, S>).layer(from_fn_with_state(
+                    "fetch",
+                    handlers::record_request_duration,
+                )),
             )
             .layer(Extension(ipfs_client))
             .layer(Extension(job_runner_client))
@@ -3,5 +3,64 @@
 #[cfg(doc)]
 use axum;
 
+use anyhow::Result;
+use axum::{
+    extract::{Request, State},
+    middleware::Next,
+    response::Response,
+};
+use cid::Cid;
+use noosphere_common::metrics::metrics;
+use noosphere_core::data::Bundle;
+use tokio_stream::{Stream, StreamExt};
+
 pub mod v0alpha1;
 pub mod v0alpha2;
+
+/// Middleware that records the time taken to produce a response to each
+/// request against the gateway metrics for the route given as its state
+pub(crate) async fn record_request_duration(
+    State(route): State<&'static str>,
+    request: Request,
+    next: Next,
+) -> Response {
+    let _timer = metrics().gateway.request_duration.start_timer(route);
+    next.run(request).await
+}
+
+/// Count the blocks that pass through a block stream, and their bytes, against
+/// the gateway metrics for `route`
+pub(crate) fn meter_block_stream<St>(
+    route: &'static str,
+    stream: St,
+) -> impl Stream<Item = Result<(Cid, Vec<u8>)>>
+where
+    St: Stream<Item = Result<(Cid, Vec<u8>)>>,
+{
+    let gateway_metrics = &metrics().gateway;
+    let blocks = gateway_metrics.streamed_blocks.get(route);
+    let bytes = gateway_metrics.streamed_bytes.get(route);
+
+    stream.map(move |item| {
+        if let Ok((_, block)) = &item {
+            blocks.inc();
+            bytes.inc_by(block.len() as u64);
+        }
+        item
+    })
+}
+
+/// Count the blocks in a [Bundle] that was received or sent in one piece, and
+/// their bytes, against the gateway metrics for `route`
+pub(crate) fn meter_bundle(route: &'static str, bundle: &Bundle) {
+    let gateway_metrics = &metrics().gateway;
+
+    gateway_metrics
+        .streamed_blocks
+        .get(route)
+        .inc_by(bundle.len() as u64);
+    gateway_metrics
+        .streamed_bytes
+        .get(route)
+        .inc_by(bundle.map().values().map(|block| block.len() as u64).sum());
+}
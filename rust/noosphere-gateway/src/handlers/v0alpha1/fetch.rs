@@ -18,6 +18,7 @@ use tokio_stream::{Stream, StreamExt};
 
 use crate::{
     extractors::{GatewayAuthority, GatewayScope},
+    handlers::meter_block_stream,
     GatewayManager,
 };
 
@@ -129,19 +130,22 @@ where
 
             return Ok(Box::pin(to_car_stream(
                 vec![latest_local_sphere_cid.into()],
-                stream.merge(memo_history_stream(
-                    store,
-                    latest_counterpart_sphere_cid,
-                    since.as_ref(),
-                    false,
-                )),
+                meter_block_stream(
+                    "fetch",
+                    stream.merge(memo_history_stream(
+                        store,
+                        latest_counterpart_sphere_cid,
+                        since.as_ref(),
+                        false,
+                    )),
+                ),
             )));
         }
         None => {
             warn!("No revisions found for counterpart {}!", counterpart);
             Ok(Box::pin(to_car_stream(
                 vec![latest_local_sphere_cid.into()],
-                stream,
+                meter_block_stream("fetch", stream),
             )))
         }
     }
@@ -1,5 +1,6 @@
 use crate::{
     extractors::{Cbor, GatewayAuthority, GatewayScope},
+    handlers::meter_bundle,
     jobs::{GatewayJob, JobClient},
     GatewayManager,
 };
@@ -45,6 +46,8 @@ where
         .try_authorize(&gateway_scope, SphereAbility::Push)
         .await?;
 
+    meter_bundle("push", &request_body.blocks);
+
     let gateway_push_routine = GatewayPushRoutine::<M, C, S> {
         gateway_sphere,
         gateway_scope,
@@ -1,5 +1,6 @@
 use crate::{
     extractors::{GatewayAuthority, GatewayScope},
+    handlers::meter_block_stream,
     GatewayManager,
 };
 use anyhow::Result;
@@ -19,7 +20,7 @@ use noosphere_core::{
     data::{ContentType, MemoIpld},
 };
 use noosphere_ipfs::{IpfsStore, KuboClient};
-use noosphere_storage::{BlockStore, BlockStoreRetry, Storage};
+use noosphere_storage::{stream_with_io_operation, BlockStore, BlockStoreRetry, Storage};
 
 /// Invoke to get a streamed CARv1 response that represents all the blocks
 /// needed to manifest the content associated with the given [Cid] path
@@ -107,7 +108,18 @@ where
                     debug!("Streaming revisions from {} to {}", since, memo_version);
                     return Ok(Body::from_stream(Box::pin(to_car_stream(
                         vec![memo_version],
-                        memo_history_stream(store, &memo_version.into(), Some(&since), false),
+                        meter_block_stream(
+                            "replicate",
+                            stream_with_io_operation(
+                                "replicate",
+                                memo_history_stream(
+                                    store,
+                                    &memo_version.into(),
+                                    Some(&since),
+                                    false,
+                                ),
+                            ),
+                        ),
                     ))));
                 } else {
                     error!("Suggested version {since} is not a valid ancestor of {memo_version}");
@@ -127,7 +139,13 @@ where
     // Always fall back to a full replication
     Ok(Body::from_stream(Box::pin(to_car_stream(
         vec![memo_version],
-        memo_body_stream(store, &memo_version.into(), include_content),
+        meter_block_stream(
+            "replicate",
+            stream_with_io_operation(
+                "replicate",
+                memo_body_stream(store, &memo_version.into(), include_content),
+            ),
+        ),
     ))))
 }
 
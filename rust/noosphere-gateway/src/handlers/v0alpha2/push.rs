@@ -1,4 +1,5 @@
 use crate::extractors::GatewayScope;
+use crate::handlers::meter_block_stream;
 use crate::jobs::{GatewayJob, JobClient};
 use crate::GatewayManager;
 use crate::{error::GatewayErrorResponse, extractors::GatewayAuthority};
@@ -50,9 +51,10 @@ where
         // In Axum 0.7+, there are `Sync` bounds required. The incoming stream
         // is `!Sync`, but as the only consumers of the stream,
         // consider it `Sync` via `UnsharedStream`.
-        block_stream: Box::pin(from_car_stream(UnsharedStream::new(
-            body.into_data_stream(),
-        ))),
+        block_stream: Box::pin(meter_block_stream(
+            "push",
+            from_car_stream(UnsharedStream::new(body.into_data_stream())),
+        )),
     };
     Ok(Body::from_stream(gateway_push_routine.invoke().await?))
 }
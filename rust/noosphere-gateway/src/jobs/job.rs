@@ -49,3 +49,18 @@ pub enum GatewayJob {
         identity: Did,
     },
 }
+
+impl GatewayJob {
+    /// A short, stable name for the kind of this job, suitable for use as a
+    /// metric label
+    pub fn kind(&self) -> &'static str {
+        match self {
+            GatewayJob::CompactHistory { .. } => "compact_history",
+            GatewayJob::IpfsSyndication { .. } => "ipfs_syndication",
+            GatewayJob::NameSystemResolveAll { .. } => "name_system_resolve_all",
+            GatewayJob::NameSystemResolveSince { .. } => "name_system_resolve_since",
+            GatewayJob::NameSystemPublish { .. } => "name_system_publish",
+            GatewayJob::NameSystemRepublish { .. } => "name_system_republish",
+        }
+    }
+}
@@ -4,6 +4,7 @@ use crate::{
 };
 use anyhow::Result;
 use async_trait::async_trait;
+use noosphere_common::metrics::metrics;
 use noosphere_core::context::HasMutableSphereContext;
 use noosphere_ipfs::IpfsClient;
 use noosphere_ns::NameResolver;
@@ -40,7 +41,19 @@ where
     type Job = GatewayJob;
 
     async fn process(context: Self::Context, job: Self::Job) -> Result<Option<Self::Job>> {
-        process_job(context, job).await
+        let gateway_metrics = &metrics().gateway;
+        let kind = job.kind();
+
+        let result = {
+            let _timer = gateway_metrics.job_duration.start_timer(kind);
+            process_job(context, job).await
+        };
+
+        if result.is_err() {
+            gateway_metrics.job_failures.get(kind).inc();
+        }
+
+        result
     }
 }
 
@@ -137,8 +137,9 @@ where
     Ok(None)
 }
 
-/// Consumes a stream of name / address tuples, resolving them one at a time
-/// and updating the provided [SphereContext] with the latest resolved values
+/// Consumes a stream of name / address tuples, resolving them as a single
+/// batch and updating the provided [SphereContext] with the latest resolved
+/// values
 async fn resolve_all<C, S, N, I, St>(
     ns_client: N,
     mut context: C,
@@ -163,37 +164,43 @@ where
         UcanStore(inner)
     };
 
-    while let Some((name, identity)) = stream.try_next().await? {
+    let mut names = Vec::new();
+    while let Some(entry) = stream.try_next().await? {
+        names.push(entry);
+    }
+
+    let resolved = fetch_records(ns_client, &names).await?;
+
+    for (name, identity) in names {
         let last_known_record = identity.link_record(&db).await;
 
-        let next_record =
-            match fetch_record(ns_client.clone(), name.clone(), identity.did.clone()).await? {
-                Some(record) => {
-                    // TODO(#257)
-                    if false {
-                        match record.validate(&ipfs_store).await {
-                            Ok(_) => {}
-                            Err(error) => {
-                                error!("Failed record validation: {}", error);
-                                continue;
-                            }
+        let next_record = match resolved.get(&identity.did).cloned() {
+            Some(record) => {
+                // TODO(#257)
+                if false {
+                    match record.validate(&ipfs_store).await {
+                        Ok(_) => {}
+                        Err(error) => {
+                            error!("Failed record validation: {}", error);
+                            continue;
                         }
                     }
-
-                    match &last_known_record {
-                        Some(last_known_record) => match last_known_record.superceded_by(&record) {
-                            true => Some(record),
-                            false => None,
-                        },
-                        None => Some(record),
-                    }
                 }
-                None => {
-                    // TODO(#259): Expire recorded value if we don't get an updated
-                    // record after some designated TTL
-                    continue;
+
+                match &last_known_record {
+                    Some(last_known_record) => match last_known_record.superceded_by(&record) {
+                        true => Some(record),
+                        false => None,
+                    },
+                    None => Some(record),
                 }
-            };
+            }
+            None => {
+                // TODO(#259): Expire recorded value if we don't get an updated
+                // record after some designated TTL
+                continue;
+            }
+        };
 
         match &next_record {
             // TODO(#260): What if the resolved value is None?
@@ -225,31 +232,71 @@ where
     Ok(())
 }
 
-/// Attempts to fetch a single link record from the name system.
-async fn fetch_record<N>(ns_client: N, name: String, identity: Did) -> Result<Option<LinkRecord>>
+/// Fetches the link records of all the given names from the name system in a
+/// single batch, keyed by the identity that each record was resolved for.
+async fn fetch_records<N>(
+    ns_client: N,
+    names: &[(String, IdentityIpld)],
+) -> Result<BTreeMap<Did, LinkRecord>>
 where
     N: NameResolver + Clone + 'static,
 {
-    debug!("Resolving record '{}' ({})...", name, identity);
-    Ok(match ns_client.resolve(&identity).await {
-        Ok(Some(record)) => {
-            debug!(
-                "Resolved record for '{}' ({}): {}",
-                name,
-                identity,
-                record.to_string()
+    let mut names_by_identity: BTreeMap<Did, Vec<&str>> = BTreeMap::new();
+    for (name, identity) in names {
+        debug!("Resolving record '{}' ({})...", name, identity.did);
+        names_by_identity
+            .entry(identity.did.clone())
+            .or_default()
+            .push(name);
+    }
+
+    let identities: Vec<Did> = names_by_identity.keys().cloned().collect();
+    let mut records = BTreeMap::new();
+
+    // A failed batch (e.g., a name system that does not support batches)
+    // falls back to resolving each name on its own
+    let outcomes = match ns_client.resolve_many(identities.clone()).await {
+        Ok(outcomes) => outcomes,
+        Err(error) => {
+            warn!(
+                "Failed to resolve {} records as a batch; resolving them one at a time: {:?}",
+                identities.len(),
+                error
             );
-            Some(record)
-        }
-        Ok(None) => {
-            warn!("No record found for {} ({})", name, identity);
-            None
+            let mut outcomes = Vec::with_capacity(identities.len());
+            for identity in identities {
+                let result = ns_client.resolve(&identity).await;
+                outcomes.push((identity, result));
+            }
+            outcomes
         }
-        Err(error) => {
-            warn!("Failed to resolve '{}' ({}): {:?}", name, identity, error);
-            None
+    };
+
+    for (identity, result) in outcomes {
+        let names = names_by_identity
+            .get(&identity)
+            .map(|names| names.join(", "))
+            .unwrap_or_default();
+        match result {
+            Ok(Some(record)) => {
+                debug!(
+                    "Resolved record for '{}' ({}): {}",
+                    names,
+                    identity,
+                    record.to_string()
+                );
+                records.insert(identity, record);
+            }
+            Ok(None) => {
+                warn!("No record found for {} ({})", names, identity);
+            }
+            Err(error) => {
+                warn!("Failed to resolve '{}' ({}): {:?}", names, identity, error);
+            }
         }
-    })
+    }
+
+    Ok(records)
 }
 
 async fn set_counterpart_record<C, S>(context: C, record: &LinkRecord) -> Result<()>
@@ -309,7 +356,7 @@ mod tests {
         data::LINK_RECORD_FACT_NAME,
         helpers::simulated_sphere_context,
     };
-    use noosphere_ns::helpers::KeyValueNameResolver;
+    use noosphere_ns::helpers::{KeyValueNameResolver, UnbatchedResolver};
     use noosphere_ucan::builder::UcanBuilder;
 
     #[tokio::test]
@@ -410,4 +457,57 @@ mod tests {
 
         Ok(())
     }
+
+    #[tokio::test]
+    async fn it_falls_back_to_single_resolutions_when_a_batch_fails() -> Result<()> {
+        let (user_sphere_context, _) = simulated_sphere_context(Access::ReadWrite, None).await?;
+        let user_sphere_identity = user_sphere_context.identity().await?;
+
+        let record: LinkRecord = {
+            let context = user_sphere_context.lock().await;
+            let identity: &str = context.identity().into();
+            UcanBuilder::default()
+                .issued_by(&context.author().key)
+                .for_audience(identity)
+                .claiming_capability(&generate_capability(identity, SphereAbility::Publish))
+                .with_lifetime(1000)
+                .with_fact(
+                    LINK_RECORD_FACT_NAME,
+                    "bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i".to_owned(),
+                )
+                .build()?
+                .sign()
+                .await?
+                .into()
+        };
+
+        let ns_client = UnbatchedResolver::<KeyValueNameResolver>::default();
+        ns_client.publish(record.clone()).await?;
+
+        let missing = Did::from("did:key:z6MkmissingRecord");
+        let names = vec![
+            (
+                "user".to_owned(),
+                IdentityIpld {
+                    did: user_sphere_identity.clone(),
+                    link_record: None,
+                },
+            ),
+            (
+                "missing".to_owned(),
+                IdentityIpld {
+                    did: missing.clone(),
+                    link_record: None,
+                },
+            ),
+        ];
+
+        let records = fetch_records(ns_client, &names).await?;
+
+        assert_eq!(records.len(), 1);
+        assert_eq!(records.get(&user_sphere_identity), Some(&record));
+        assert!(!records.contains_key(&missing));
+
+        Ok(())
+    }
 }
@@ -3,6 +3,7 @@ use super::{
     Processor,
 };
 use anyhow::{anyhow, Result};
+use noosphere_common::metrics::metrics;
 use std::{
     collections::VecDeque,
     time::{Duration, SystemTime},
@@ -26,6 +27,9 @@ pub struct WorkerQueueOrchestrator<P: Processor> {
     retries: usize,
     timeout: Duration,
     job_queue: VecDeque<JobRequest<P>>,
+    // How much this orchestrator has contributed to the process-wide
+    // job queue depth gauge, which is shared by every orchestrator
+    reported_queue_depth: usize,
     request_rx: Option<UnboundedReceiver<P::Job>>,
     response_rx: Option<UnboundedReceiver<WorkerResponse<P::Job>>>,
     worker_context: P::Context,
@@ -59,6 +63,7 @@ where
 
         Ok(Self {
             job_queue: VecDeque::new(),
+            reported_queue_depth: 0,
             workers,
             retries,
             timeout,
@@ -177,6 +182,17 @@ where
         max_duration
     }
 
+    /// Adjusts the job queue depth gauge by the change in the length of
+    /// this orchestrator's queue since it was last reported.
+    fn report_queue_depth(&mut self) {
+        let depth = self.job_queue.len();
+        metrics()
+            .gateway
+            .job_queue_depth
+            .add(depth as i64 - self.reported_queue_depth as i64);
+        self.reported_queue_depth = depth;
+    }
+
     /// Start the processing of incoming requests
     /// on the current thread.
     pub async fn start(mut self) -> Result<()> {
@@ -203,8 +219,19 @@ where
                 }
             }
             self.process_queue()?;
+            self.report_queue_depth();
         }
         #[allow(unreachable_code)]
         Ok(())
     }
 }
+
+impl<P> Drop for WorkerQueueOrchestrator<P>
+where
+    P: Processor,
+{
+    fn drop(&mut self) {
+        self.job_queue.clear();
+        self.report_queue_depth();
+    }
+}
@@ -9,7 +9,7 @@ use crate::{
 use anyhow::Result;
 use noosphere_core::context::HasMutableSphereContext;
 use noosphere_ipfs::KuboClient;
-use noosphere_ns::server::HttpClient as NameSystemHttpClient;
+use noosphere_ns::{server::HttpClient as NameSystemHttpClient, CachingNameResolver};
 use noosphere_storage::Storage;
 use std::{marker::PhantomData, sync::Arc, time::Duration};
 use tokio::task::JoinHandle;
@@ -35,7 +35,7 @@ type GatewayWorkerQueue<C, S> = Arc<
             SingleTenantContextResolver<C, S>,
             C,
             S,
-            NameSystemHttpClient,
+            CachingNameResolver<NameSystemHttpClient>,
             KuboClient,
         >,
     >,
@@ -65,7 +65,12 @@ where
         ipfs_client: KuboClient,
         name_resolver_api: Url,
     ) -> Result<Self> {
-        let name_resolver = NameSystemHttpClient::new(name_resolver_api).await?;
+        // Address books are resolved periodically; cache resolved records so
+        // that each pass doesn't wait on a name system query for every name
+        let name_resolver = CachingNameResolver::new(
+            Arc::new(NameSystemHttpClient::new(name_resolver_api).await?),
+            Default::default(),
+        );
         let worker_context = GatewayJobContext::new(context_resolver, name_resolver, ipfs_client);
         let worker_queue = Arc::new(
             WorkerQueueBuilder::new()
@@ -0,0 +1,117 @@
+//! Benchmarks for streaming large Subtext documents out as HTML, reported as
+//! bytes of HTML per second.
+//!
+//! `cargo bench -p noosphere-into --bench subtext_html`
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use noosphere_core::{
+    authority::Access,
+    context::{HasMutableSphereContext, SphereContentRead, SphereContentWrite, SphereCursor},
+    data::ContentType,
+    helpers::simulated_sphere_context,
+};
+use noosphere_into::{
+    file_to_html_stream, HtmlOutput, StaticHtmlTransform, TransformStream, DEFAULT_FRAME_SIZE,
+};
+use std::hint::black_box;
+use tokio::{io::sink, runtime::Runtime};
+
+/// The number of blocks in the documents being rendered
+const DOCUMENT_BLOCKS: &[usize] = &[1_000, 10_000];
+
+/// The frame sizes that rendered HTML is read in, in bytes
+const FRAME_SIZES: &[usize] = &[1024, DEFAULT_FRAME_SIZE, 256 * 1024];
+
+/// A Subtext document of `blocks` blocks, with a mix of headers, quotes,
+/// lists, links and transclusions of a handful of other notes
+fn subtext_document(blocks: usize) -> String {
+    let mut document = String::new();
+
+    for index in 0..blocks {
+        let line = match index % 6 {
+            0 => format!("# Section {index}"),
+            1 => format!(
+                "Some prose about /note-{} and [[another note]], followed by a longer run of text",
+                index % 8
+            ),
+            2 => format!("> A quote that mentions https://example.com/{index}"),
+            3 => format!("- A list item with a /note-{} link", index % 8),
+            4 => format!("/note-{}", index % 8),
+            _ => String::new(),
+        };
+        document.push_str(&line);
+        document.push('\n');
+    }
+
+    document
+}
+
+fn bench_subtext_to_html(c: &mut Criterion) {
+    let runtime = Runtime::new().expect("Failed to start benchmark runtime");
+    let mut group = c.benchmark_group("subtext_html");
+    group.sample_size(10);
+
+    for &blocks in DOCUMENT_BLOCKS {
+        let cursor = runtime
+            .block_on(async {
+                let (context, _) = simulated_sphere_context(Access::ReadWrite, None).await?;
+                let mut cursor = SphereCursor::latest(context);
+
+                for index in 0..8 {
+                    cursor
+                        .write(
+                            &format!("note-{index}"),
+                            &ContentType::Subtext,
+                            format!("# Note {index}\n\nThe excerpt of note {index}").as_bytes(),
+                            None,
+                        )
+                        .await?;
+                }
+
+                cursor
+                    .write(
+                        "document",
+                        &ContentType::Subtext,
+                        subtext_document(blocks).as_bytes(),
+                        None,
+                    )
+                    .await?;
+                cursor.save(None).await?;
+
+                Ok::<_, anyhow::Error>(cursor)
+            })
+            .expect("Failed to prepare sphere");
+
+        let render = |frame_size: usize| {
+            let cursor = cursor.clone();
+            async move {
+                let file = cursor.read("document").await.unwrap().unwrap();
+                let transform = StaticHtmlTransform::new(cursor.clone());
+                let mut reader =
+                    TransformStream(file_to_html_stream(file, HtmlOutput::Document, transform))
+                        .into_reader_with_frame_size(frame_size);
+
+                tokio::io::copy(&mut reader, &mut sink()).await.unwrap()
+            }
+        };
+
+        let html_size = runtime.block_on(render(DEFAULT_FRAME_SIZE));
+        group.throughput(Throughput::Bytes(html_size));
+
+        for &frame_size in FRAME_SIZES {
+            group.bench_with_input(
+                BenchmarkId::new(format!("{blocks}_blocks"), frame_size),
+                &frame_size,
+                |b, &frame_size| {
+                    b.to_async(&runtime)
+                        .iter(|| async { black_box(render(frame_size).await) })
+                },
+            );
+        }
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_subtext_to_html);
+criterion_main!(benches);
@@ -0,0 +1,79 @@
+use std::{collections::BTreeMap, io::Cursor, path::Path};
+
+use anyhow::Result;
+use cid::{
+    multihash::{Code, MultihashDigest},
+    Cid,
+};
+use serde::{Deserialize, Serialize};
+
+use crate::WriteTarget;
+
+/// The version of the HTML that [super::sphere_into_html] produces. Bump this
+/// whenever a change to a transform would change the HTML of content that has
+/// already been built, so that existing builds are regenerated from scratch.
+pub const HTML_TRANSFORM_VERSION: u32 = 1;
+
+/// Where the [BuildManifest] is kept, relative to the root of the build
+pub const BUILD_MANIFEST_PATH: &str = ".build-manifest.json";
+
+const RAW_CODEC: u64 = 0x55;
+
+/// A record of what a previous run of [super::sphere_into_html] produced, so
+/// that the next run only needs to generate what has changed since.
+#[derive(Debug, Default, Clone, Serialize, Deserialize)]
+pub struct BuildManifest {
+    /// The [HTML_TRANSFORM_VERSION] that the build was produced with
+    pub transform: u32,
+    /// A hash of the theme assets that were written by the build
+    pub theme: String,
+    /// The latest sphere revision that was built
+    pub version: Option<String>,
+    /// The content (by memo CID) that has been built, and the path it was
+    /// written to
+    pub outputs: BTreeMap<String, String>,
+}
+
+impl BuildManifest {
+    /// Load the [BuildManifest] from the [WriteTarget]. A missing or
+    /// unreadable manifest (or one produced by a different
+    /// [HTML_TRANSFORM_VERSION]) yields an empty manifest, so that everything
+    /// is built again.
+    pub async fn load<W: WriteTarget>(write_target: &W) -> Result<Self> {
+        let manifest = match write_target
+            .read_file(Path::new(BUILD_MANIFEST_PATH))
+            .await?
+        {
+            Some(bytes) => serde_json::from_slice(&bytes).unwrap_or_else(|error| {
+                warn!("Ignoring unreadable build manifest: {}", error);
+                BuildManifest::default()
+            }),
+            None => BuildManifest::default(),
+        };
+
+        Ok(if manifest.transform == HTML_TRANSFORM_VERSION {
+            manifest
+        } else {
+            BuildManifest {
+                transform: HTML_TRANSFORM_VERSION,
+                ..Default::default()
+            }
+        })
+    }
+
+    /// Persist the [BuildManifest] to the [WriteTarget]
+    pub async fn save<W: WriteTarget>(&self, write_target: &W) -> Result<()> {
+        let bytes = serde_json::to_vec(self)?;
+
+        write_target
+            .write(Path::new(BUILD_MANIFEST_PATH), Cursor::new(bytes))
+            .await
+    }
+
+    /// The hash that identifies a set of theme assets
+    pub fn theme_hash(assets: &[&[u8]]) -> String {
+        let bytes = assets.concat();
+
+        Cid::new_v1(RAW_CODEC, Code::Blake3_256.digest(&bytes)).to_string()
+    }
+}
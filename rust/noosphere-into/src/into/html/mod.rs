@@ -1,5 +1,7 @@
 mod envelope;
+mod manifest;
 mod sphere;
 
 pub use envelope::*;
+pub use manifest::*;
 pub use sphere::*;
@@ -1,15 +1,20 @@
-use std::{collections::BTreeSet, io::Cursor, path::PathBuf, sync::Arc};
+use std::{
+    collections::{BTreeMap, BTreeSet},
+    io::Cursor,
+    path::PathBuf,
+    sync::Arc,
+};
 
 use anyhow::{anyhow, Result};
-use cid::Cid;
-use noosphere_core::context::{HasSphereContext, SphereContentRead, SphereCursor};
+use noosphere_core::{
+    context::{HasSphereContext, SphereContentRead, SphereCursor},
+    data::MapOperation,
+};
 use noosphere_storage::Storage;
-use tokio::sync::Mutex;
-use tokio_stream::StreamExt;
 
 use crate::{
-    file_to_html_stream, sphere_to_html_document_stream, HtmlOutput, StaticHtmlTransform,
-    TransformStream, WriteTarget,
+    file_to_html_stream, sphere_to_html_document_stream, BuildManifest, HtmlOutput,
+    StaticHtmlTransform, TransformStream, WriteTarget,
 };
 
 static DEFAULT_STYLES: &[u8] = include_bytes!("./static/styles.css");
@@ -17,77 +22,97 @@ static DEFAULT_STYLES: &[u8] = include_bytes!("./static/styles.css");
 /// Given a sphere [Did], [SphereDb] and a [WriteTarget], produce rendered HTML
 /// output up to and including the complete historical revisions of the
 /// slug-named content of the sphere.
+///
+/// The build is incremental: a [BuildManifest] that is kept alongside the
+/// output records the latest revision that was built, and the content that
+/// was written along the way. Subsequent builds only visit the revisions that
+/// are newer than that, and only generate the content that was added to the
+/// sphere by those revisions (as recorded in their content changelogs). The
+/// whole build is regenerated when [crate::HTML_TRANSFORM_VERSION] changes,
+/// and the theme is rewritten when it changes.
 pub async fn sphere_into_html<C, S, W>(sphere_context: C, write_target: &W) -> Result<()>
 where
     C: HasSphereContext<S> + 'static,
     S: Storage + 'static,
     W: WriteTarget + 'static,
 {
-    let mut next_sphere_cid = Some(sphere_context.version().await?);
+    let mut manifest = BuildManifest::load(write_target).await?;
+    let built_version = manifest.version.take();
+    let latest_version = sphere_context.version().await?;
 
     let mut cursor = SphereCursor::latest(sphere_context);
+    cursor.mount_at(&latest_version).await?;
+
+    let latest_content = cursor.to_sphere().await?.get_content().await?;
 
     let write_target = Arc::new(write_target.clone());
-    let mut latest_revision = true;
+    let mut changed_slugs = BTreeSet::<String>::new();
+    let mut next_sphere_cid = Some(latest_version);
 
     while let Some(sphere_cid) = next_sphere_cid {
-        let sphere_index: PathBuf = format!("permalink/{sphere_cid}/index.html").into();
-
-        // We write the sphere index last, so if we already have it we can
-        // assume this revision has been written in the past
-        // TODO(#54): Figure out how to enable forced-regeneration of some-or-all
-        // of history that has been generated before
-        if write_target.exists(&sphere_index).await? {
+        if built_version.as_deref() == Some(sphere_cid.to_string().as_str()) {
             break;
         }
 
-        let write_actions = Arc::new(Mutex::new(BTreeSet::<Cid>::new()));
         let sphere = cursor.to_sphere().await?;
-        let links = sphere.get_content().await?;
-        let mut link_stream = links.stream().await?;
+        let content = sphere.get_content().await?;
+
+        // A revision that did not change the content still carries the
+        // changelog of the revision that last did
+        let content_changed = match sphere.get_parent().await? {
+            Some(parent) => parent.get_content().await?.cid() != content.cid(),
+            None => true,
+        };
+
+        let mut added = BTreeMap::new();
+
+        if content_changed {
+            for change in &content.get_changelog().await?.changes {
+                match change {
+                    MapOperation::Add { key, value } => {
+                        changed_slugs.insert(key.clone());
+                        added.insert(key.clone(), value.cid);
+                    }
+                    MapOperation::Remove { key } => {
+                        changed_slugs.insert(key.clone());
+                        added.remove(key);
+                    }
+                }
+            }
+        }
 
+        // One transform is shared by everything rendered at this revision, so
+        // that content transcluded from many places is only read once
+        let transform = StaticHtmlTransform::new(cursor.clone());
         let mut tasks = Vec::new();
 
-        while let Some(Ok((slug, link))) = link_stream.next().await {
-            let cid = link.cid;
-            let file_name: PathBuf = format!("permalink/{cid}/index.html").into();
+        for (slug, cid) in added {
+            let file_name = format!("permalink/{cid}/index.html");
 
-            // Skip this write entirely if the content has been written
+            // Skip this write entirely if the content has been written (or
+            // is being written by another task, which covers the case where
+            // we have multiple slugs referring to the same CID)
             // TODO(#55): This may not hold in a world where there are multiple
             // files written per slug; an example might be a video file that
             // needs to be transformed into an HTML document to present the
             // video, and the video file itself.
-            if write_target.exists(&file_name).await? {
+            if manifest.outputs.contains_key(&cid.to_string()) {
                 continue;
             }
 
+            manifest.outputs.insert(cid.to_string(), file_name.clone());
+
             tasks.push(W::spawn({
-                let slug = slug.clone();
-                let write_actions = write_actions.clone();
                 let write_target = write_target.clone();
-                let latest_revision = latest_revision;
                 let cursor = cursor.clone();
+                let transform = transform.clone();
 
                 async move {
-                    {
-                        let mut write_actions = write_actions.lock().await;
-
-                        // Skip this write, to cover the case where we have
-                        // multiple slugs referring to the same CID (and the
-                        // write is already being handled by another task).
-                        if write_actions.contains(&cid) {
-                            return Ok(());
-                        } else {
-                            write_actions.insert(cid);
-                        }
-                    }
-
                     let sphere_file = cursor
                         .read(&slug)
                         .await?
                         .ok_or_else(|| anyhow!("No file found for {}", slug))?;
 
-                    let transform = StaticHtmlTransform::new(cursor.clone());
                     let reader = TransformStream(file_to_html_stream(
                         sphere_file,
                         HtmlOutput::Document,
@@ -95,16 +120,9 @@ where
                     ))
                     .into_reader();
 
-                    write_target.write(&file_name, reader).await?;
-
-                    if latest_revision {
-                        write_target
-                            .symlink(
-                                &PathBuf::from(format!("permalink/{cid}")),
-                                &PathBuf::from(slug),
-                            )
-                            .await?;
-                    }
+                    write_target
+                        .write(&PathBuf::from(file_name), reader)
+                        .await?;
 
                     // TODO(#56): Support backlinks somehow; probably as a dynamic
                     // widget at the bottom of the HTML document
@@ -119,31 +137,43 @@ where
         // cases where writing content may fail
         futures::future::try_join_all(tasks).await?;
 
-        // let cursor = SphereCursor::at(sphere_context, sphere_cid);
-
-        let transform = StaticHtmlTransform::new(cursor.clone());
+        let sphere_index: PathBuf = format!("permalink/{sphere_cid}/index.html").into();
         let reader = TransformStream(sphere_to_html_document_stream(cursor.clone(), transform))
             .into_reader();
 
         write_target.write(&sphere_index, reader).await?;
 
-        if latest_revision {
+        if sphere_cid == latest_version {
             write_target
                 .symlink(&sphere_index, &PathBuf::from("index.html"))
                 .await?;
         }
 
         next_sphere_cid = cursor.rewind().await?.cloned();
-        latest_revision = false;
     }
 
-    // TODO(#57): Writing these static files should be done concurrently
-    write_target
-        .write(
-            &PathBuf::from("theme/styles.css"),
-            &mut Cursor::new(DEFAULT_STYLES),
-        )
-        .await?;
+    // Point the slugs that changed at their latest content
+    // NOTE: The slugs of removed content keep pointing at their last content
+    for slug in changed_slugs {
+        if let Some(link) = latest_content.get(&slug).await? {
+            write_target
+                .symlink(
+                    &PathBuf::from(format!("permalink/{}", link.cid)),
+                    &PathBuf::from(slug),
+                )
+                .await?;
+        }
+    }
+
+    let theme = BuildManifest::theme_hash(&[DEFAULT_STYLES]);
+    let theme_path = PathBuf::from("theme/styles.css");
+
+    if manifest.theme != theme || !write_target.exists(&theme_path).await? {
+        write_target
+            .write(&theme_path, &mut Cursor::new(DEFAULT_STYLES))
+            .await?;
+        manifest.theme = theme;
+    }
 
     // TODO(#58): Introduce some kind of default logo
     // write_target
@@ -153,6 +183,11 @@ where
     //     )
     //     .await?;
 
+    // The manifest is written last, so that an interrupted build is resumed
+    // from the last build that completed
+    manifest.version = Some(latest_version.to_string());
+    manifest.save(write_target.as_ref()).await?;
+
     Ok(())
 }
 
@@ -165,7 +200,7 @@ pub mod tests {
 
     wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
 
-    use crate::write::MemoryWriteTarget;
+    use crate::{write::MemoryWriteTarget, WriteTarget};
     use noosphere_core::{
         authority::Access,
         context::{HasMutableSphereContext, SphereContentWrite, SphereCursor},
@@ -298,4 +333,82 @@ pub mod tests {
 
         assert_eq!(cats_revised_html, cats_slug_html);
     }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_only_builds_what_changed_since_the_last_build() {
+        let (context, _) = simulated_sphere_context(Access::ReadWrite, None)
+            .await
+            .unwrap();
+        let mut cursor = SphereCursor::latest(context);
+
+        let cats_cid = cursor
+            .write(
+                "cats",
+                &ContentType::Subtext,
+                b"Cats are great".as_ref(),
+                None,
+            )
+            .await
+            .unwrap();
+        let first_version = cursor.save(None).await.unwrap();
+
+        let write_target = MemoryWriteTarget::default();
+
+        sphere_into_html(cursor.clone(), &write_target)
+            .await
+            .unwrap();
+
+        // Content that has already been built is not built again
+        let cats_path = PathBuf::from(format!("permalink/{}/index.html", cats_cid));
+        write_target
+            .write(&cats_path, b"Already built".as_ref())
+            .await
+            .unwrap();
+
+        let dogs_cid = cursor
+            .write(
+                "dogs",
+                &ContentType::Subtext,
+                b"Dogs are also great".as_ref(),
+                None,
+            )
+            .await
+            .unwrap();
+        let second_version = cursor.save(None).await.unwrap();
+
+        sphere_into_html(cursor.clone(), &write_target)
+            .await
+            .unwrap();
+
+        assert_eq!(
+            write_target.read(&cats_path).await.unwrap(),
+            b"Already built".to_vec()
+        );
+        assert!(write_target
+            .exists(&PathBuf::from(format!("permalink/{}/index.html", dogs_cid)))
+            .await
+            .unwrap());
+        assert!(write_target
+            .exists(&PathBuf::from(format!(
+                "permalink/{}/index.html",
+                first_version
+            )))
+            .await
+            .unwrap());
+        assert_eq!(
+            write_target
+                .resolve_symlink(&PathBuf::from("index.html"))
+                .await
+                .unwrap(),
+            PathBuf::from(format!("permalink/{}/index.html", second_version))
+        );
+        assert_eq!(
+            write_target
+                .resolve_symlink(&PathBuf::from("dogs"))
+                .await
+                .unwrap(),
+            PathBuf::from(format!("permalink/{}", dogs_cid))
+        );
+    }
 }
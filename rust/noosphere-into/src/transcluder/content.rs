@@ -1,16 +1,35 @@
-use std::marker::PhantomData;
+use std::{
+    collections::HashMap,
+    marker::PhantomData,
+    sync::{Arc, Mutex},
+};
 
 use crate::{ResolvedLink, TextTransclude, Transclude, Transcluder};
-use anyhow::Result;
+use anyhow::{anyhow, Result};
 use async_trait::async_trait;
-use noosphere_core::context::{HasSphereContext, SphereContentRead};
+use cid::Cid;
+use noosphere_core::context::{AsyncFileBody, HasSphereContext, SphereContentRead, SphereFile};
 use noosphere_core::data::Header;
 use noosphere_storage::Storage;
 use subtext::{block::Block, primitive::Entity, Peer};
+use tokio::sync::OnceCell;
 use tokio_stream::StreamExt;
 
+/// The parts of a file that are shown when it is transcluded
+#[derive(Clone, Debug, Default)]
+struct TranscludedContent {
+    title: Option<String>,
+    excerpt: Option<String>,
+}
+
 /// A [Transcluder] implementation that uses [HasSphereContext] to resolve the content
 /// being transcluded.
+///
+/// The title and excerpt of each transcluded file are memoized by the CID of
+/// its memo, so a file that is linked from many places is only parsed once for
+/// as long as the transcluder (or any of its clones) is in use. This assumes
+/// that the transcluder is used for a single render of the sphere at a single
+/// version.
 #[derive(Clone)]
 pub struct SphereContentTranscluder<R, S>
 where
@@ -18,6 +37,7 @@ where
     S: Storage + 'static,
 {
     content: R,
+    cache: Arc<Mutex<HashMap<Cid, Arc<OnceCell<TranscludedContent>>>>>,
     storage_type: PhantomData<S>,
 }
 
@@ -29,9 +49,54 @@ where
     pub fn new(content: R) -> Self {
         SphereContentTranscluder {
             content,
+            cache: Default::default(),
             storage_type: PhantomData,
         }
     }
+
+    /// The [TranscludedContent] of a file, parsed from the file the first
+    /// time its memo is transcluded and served from the cache thereafter
+    async fn transcluded_content(
+        &self,
+        file: SphereFile<Box<dyn AsyncFileBody>>,
+    ) -> Result<TranscludedContent> {
+        let entry = self
+            .cache
+            .lock()
+            .map_err(|_| anyhow!("Transclusion cache is poisoned"))?
+            .entry(file.memo_version.cid)
+            .or_default()
+            .clone();
+
+        let content = entry
+            .get_or_init(|| async move {
+                // TODO(#52): Maybe fall back to first heading if present and use
+                // that as a stand-in for title...
+                let title = file.memo.get_first_header(&Header::Title);
+
+                let subtext_ast_stream =
+                    subtext::stream::<Block<Entity>, _, _>(file.contents).await;
+
+                tokio::pin!(subtext_ast_stream);
+
+                let mut excerpt = None;
+
+                while let Some(Ok(block)) = subtext_ast_stream.next().await {
+                    match block {
+                        Block::Blank(_) => continue,
+                        any_other => {
+                            excerpt = Some(any_other.to_text_content());
+                            break;
+                        }
+                    }
+                }
+
+                TranscludedContent { title, excerpt }
+            })
+            .await;
+
+        Ok(content.clone())
+    }
 }
 
 #[cfg_attr(not(target_arch = "wasm32"), async_trait)]
@@ -64,26 +129,8 @@ where
 
                 Ok(match self.content.read(&slug).await? {
                     Some(file) => {
-                        // TODO(#52): Maybe fall back to first heading if present and use
-                        // that as a stand-in for title...
-                        let title = file.memo.get_first_header(&Header::Title);
-
-                        let subtext_ast_stream =
-                            subtext::stream::<Block<Entity>, _, _>(file.contents).await;
-
-                        tokio::pin!(subtext_ast_stream);
-
-                        let mut excerpt = None;
-
-                        while let Some(Ok(block)) = subtext_ast_stream.next().await {
-                            match block {
-                                Block::Blank(_) => continue,
-                                any_other => {
-                                    excerpt = Some(any_other.to_text_content());
-                                    break;
-                                }
-                            }
-                        }
+                        let TranscludedContent { title, excerpt } =
+                            self.transcluded_content(file).await?;
 
                         Some(Transclude::Text(TextTransclude {
                             title,
@@ -108,3 +155,65 @@ where
         }
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use std::str::FromStr;
+
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    use noosphere_core::{
+        authority::Access,
+        context::{HasMutableSphereContext, SphereContentWrite, SphereCursor},
+        data::{ContentType, Header},
+        helpers::simulated_sphere_context,
+    };
+    use subtext::Slashlink;
+
+    use super::SphereContentTranscluder;
+    use crate::{ResolvedLink, Transclude, Transcluder};
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_reads_each_transcluded_file_once() {
+        let (context, _) = simulated_sphere_context(Access::ReadWrite, None)
+            .await
+            .unwrap();
+        let mut cursor = SphereCursor::latest(context);
+
+        cursor
+            .write(
+                "animals",
+                &ContentType::Subtext,
+                b"\n\nAnimals are multicellular".as_ref(),
+                Some(vec![(Header::Title.to_string(), "Animals".into())]),
+            )
+            .await
+            .unwrap();
+        cursor.save(None).await.unwrap();
+
+        let transcluder = SphereContentTranscluder::new(cursor);
+        let link = ResolvedLink::Slashlink {
+            link: Slashlink::from_str("/animals").unwrap(),
+            href: "/animals".into(),
+        };
+
+        for transcluder in [transcluder.clone(), transcluder.clone()] {
+            match transcluder.transclude(&link).await.unwrap() {
+                Some(Transclude::Text(transclude)) => {
+                    assert_eq!(transclude.title.as_deref(), Some("Animals"));
+                    assert_eq!(
+                        transclude.excerpt.as_deref(),
+                        Some("Animals are multicellular")
+                    );
+                }
+                _ => panic!("Expected a text transclude"),
+            }
+        }
+
+        assert_eq!(transcluder.cache.lock().unwrap().len(), 1);
+    }
+}
@@ -1,5 +1,5 @@
 use async_stream::stream;
-use bytes::Bytes;
+use bytes::{Bytes, BytesMut};
 use futures::Stream;
 use std::io::Error as IoError;
 use tokio_util::io::StreamReader;
@@ -7,6 +7,10 @@ use tokio_util::io::StreamReader;
 #[cfg(doc)]
 use tokio::io::AsyncRead;
 
+/// The size (in bytes) of the frames that a [TransformStream] yields by
+/// default
+pub const DEFAULT_FRAME_SIZE: usize = 16 * 1024;
+
 /// This is a helper for taking a [Stream] of strings and converting it
 /// to an [AsyncRead] suitable for writing to a file.
 pub struct TransformStream<S>(pub S)
@@ -18,12 +22,98 @@ where
     S: Stream<Item = String>,
 {
     /// Consume the [TransformStream] and return a [StreamReader] that yields
-    /// the stream as bytes.
+    /// the stream as bytes, in frames of [DEFAULT_FRAME_SIZE].
     pub fn into_reader(self) -> StreamReader<impl Stream<Item = Result<Bytes, IoError>>, Bytes> {
-        StreamReader::new(Box::pin(stream! {
+        self.into_reader_with_frame_size(DEFAULT_FRAME_SIZE)
+    }
+
+    /// Same as [TransformStream::into_reader], but yields frames of (at
+    /// least) `frame_size` bytes, except for the last one.
+    pub fn into_reader_with_frame_size(
+        self,
+        frame_size: usize,
+    ) -> StreamReader<impl Stream<Item = Result<Bytes, IoError>>, Bytes> {
+        StreamReader::new(Box::pin(self.into_frames(frame_size)))
+    }
+
+    /// Consume the [TransformStream] and return a [Stream] of [Bytes] frames.
+    /// The strings of the stream are gathered into a buffer that is split off
+    /// into a frame whenever it holds at least `frame_size` bytes; the buffer
+    /// reclaims its allocation once a frame has been dropped by the consumer.
+    pub fn into_frames(self, frame_size: usize) -> impl Stream<Item = Result<Bytes, IoError>> {
+        let frame_size = frame_size.max(1);
+
+        stream! {
+            let mut buffer = BytesMut::with_capacity(frame_size);
+
             for await part in self.0 {
-              yield Ok(Bytes::from(part));
+                buffer.extend_from_slice(part.as_bytes());
+
+                if buffer.len() >= frame_size {
+                    let frame = buffer.split().freeze();
+                    buffer.reserve(frame_size);
+                    yield Ok(frame);
+                }
+            }
+
+            if !buffer.is_empty() {
+                yield Ok(buffer.freeze());
             }
-        }))
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    use super::TransformStream;
+    use bytes::Bytes;
+    use futures::{stream, TryStreamExt};
+
+    async fn frames_of(parts: &[&str], frame_size: usize) -> Vec<Bytes> {
+        let parts = parts
+            .iter()
+            .map(|part| part.to_string())
+            .collect::<Vec<_>>();
+
+        TransformStream(stream::iter(parts))
+            .into_frames(frame_size)
+            .try_collect()
+            .await
+            .unwrap()
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_gathers_parts_into_frames_of_at_least_the_frame_size() {
+        let parts = ["ab", "c", "defg", "h", "ij", "k"];
+        let frames = frames_of(&parts, 3).await;
+
+        let (last, rest) = frames.split_last().unwrap();
+        assert!(rest.iter().all(|frame| frame.len() >= 3));
+        assert!(!last.is_empty() && last.len() < 3);
+        assert_eq!(frames.concat(), parts.concat().as_bytes());
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_yields_an_oversized_part_whole() {
+        let oversized = "x".repeat(10);
+        let frames = frames_of(&["a", &oversized, "b"], 4).await;
+
+        assert_eq!(frames.len(), 2);
+        assert_eq!(frames[0], format!("a{oversized}").as_bytes());
+        assert_eq!(frames[1], "b".as_bytes());
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_yields_no_frames_for_empty_input() {
+        assert!(frames_of(&[], 4).await.is_empty());
+        assert!(frames_of(&["", ""], 4).await.is_empty());
     }
 }
@@ -1,6 +1,6 @@
-use std::str::FromStr;
+use std::{fmt::Write, str::FromStr};
 
-use crate::{Resolver, Transclude, Transcluder, Transform};
+use crate::{Resolver, Transclude, Transcluder, Transform, DEFAULT_FRAME_SIZE};
 use anyhow::Result;
 use async_stream::stream;
 
@@ -15,7 +15,8 @@ use tokio::io::AsyncRead;
 use url::Url;
 
 /// Given a [Transform] and a [SphereFile], produce a stream that yields the
-/// file content as an HTML fragment
+/// file content as an HTML fragment. Rendered blocks are gathered into strings
+/// of roughly [DEFAULT_FRAME_SIZE] bytes before they are yielded.
 pub fn subtext_to_html_fragment_stream<T, R>(
     file: SphereFile<R>,
     transform: T,
@@ -35,23 +36,32 @@ where
 
         let subtext_ast_stream = subtext::stream::<Block<Entity>, Entity, _>(file.contents).await;
 
-        yield "<article class=\"subtext\">".into();
+        let mut buffer = String::with_capacity(DEFAULT_FRAME_SIZE);
+        buffer.push_str("<article class=\"subtext\">");
 
         for await block in subtext_ast_stream {
             if let Ok(block) = block {
-                match block_to_html(transform.clone(), block).await {
-                  Ok(block_html) => {
-                    yield block_html;
-                    yield "\n".into();
+                let block_start = buffer.len();
+
+                match write_block_html(transform.clone(), block, &mut buffer).await {
+                  Ok(_) => {
+                    buffer.push('\n');
+
+                    if buffer.len() >= DEFAULT_FRAME_SIZE {
+                        yield std::mem::replace(&mut buffer, String::with_capacity(DEFAULT_FRAME_SIZE));
+                    }
                   },
                   Err(error) => {
+                    buffer.truncate(block_start);
                     warn!("Failed to transform subtext block: {:?}", error);
                   }
                 }
             }
         }
 
-        yield "</article>".into();
+        buffer.push_str("</article>");
+
+        yield buffer;
     }
 }
 
@@ -60,66 +70,87 @@ pub async fn block_to_html<T>(transform: T, block: Block<Entity>) -> Result<Stri
 where
     T: Transform,
 {
-    let mut content_html_strings = Vec::new();
-    let mut transclude_html_strings = Vec::new();
+    let mut html = String::new();
+    write_block_html(transform, block, &mut html).await?;
+    Ok(html)
+}
+
+/// Given a [Transform] and a [Block], append the block as HTML to `output`.
+/// Nothing is appended if the block fails to render.
+pub async fn write_block_html<T>(
+    transform: T,
+    block: Block<Entity>,
+    output: &mut String,
+) -> Result<()>
+where
+    T: Transform,
+{
     let content_entities: Vec<Entity> = block.to_content_entities().into_iter().cloned().collect();
     let is_solo_slashlink = matches!(
         (content_entities.first(), content_entities.len()),
         (Some(&Entity::SlashLink(_)), 1)
     );
 
-    for entity in content_entities {
-        let (entity_html, transclude_html) = entity_to_html(entity, transform.clone()).await?;
+    // Entities are resolved (and their transcludes read) concurrently, but
+    // rendered in their original order
+    let entities_html = futures::future::try_join_all(
+        content_entities
+            .into_iter()
+            .map(|entity| entity_to_html(entity, transform.clone())),
+    )
+    .await?;
 
-        content_html_strings.push(entity_html);
-        if let Some(transclude_html) = transclude_html {
-            transclude_html_strings.push(transclude_html);
-        }
+    let content_element = match block {
+        Block::Header(_) => Some(("h1", "block-header")),
+        // If this is a slashlink on its own, effectively replace it with its transclude
+        Block::Paragraph(_) if is_solo_slashlink => None,
+        Block::Paragraph(_) => Some(("p", "block-paragraph")),
+        Block::Quote(_) => Some(("blockquote", "block-quote")),
+        Block::List(_) => Some(("div", "block-list")),
+        Block::Blank(_) => None,
+    };
+    let has_transcludes = entities_html
+        .iter()
+        .any(|(_, transclude_html)| transclude_html.is_some());
+
+    if content_element.is_none() && !has_transcludes {
+        return Ok(());
     }
 
-    let content_html = content_html_strings.join("\n");
-    let content_html = match block {
-        Block::Header(_) => html! {
-            h1(class="block-header") : Raw(&content_html)
-        }
-        .to_string(),
-        Block::Paragraph(_) => {
-            // If this is a slashlink on its own, effectively replace it with its transclude
-            if is_solo_slashlink {
-                String::new()
-            } else {
-                html! {
-                    p(class="block-paragraph") : Raw(&content_html)
-                }
-                .to_string()
+    output.push_str("<section class=\"block\">");
+
+    if let Some((tag, class)) = content_element {
+        write!(
+            output,
+            "<section class=\"block-content\"><{tag} class=\"{class}\">"
+        )?;
+        for (index, (entity_html, _)) in entities_html.iter().enumerate() {
+            if index > 0 {
+                output.push('\n');
             }
+            output.push_str(entity_html);
         }
-        Block::Quote(_) => html! {
-            blockquote(class="block-quote") : Raw(&content_html)
-        }
-        .to_string(),
-        Block::List(_) => html! {
-            div(class="block-list") : Raw(&content_html)
-        }
-        .to_string(),
-        Block::Blank(_) => String::new(),
-    };
-
-    let transclude_html = transclude_html_strings.join("\n");
+        write!(output, "</{tag}></section>")?;
+    }
 
-    Ok(html! {
-        @if !content_html.is_empty() || !transclude_html.is_empty() {
-            section(class="block") {
-                @if !content_html.is_empty() {
-                    section(class="block-content") : Raw(&content_html);
-                }
-                @if !transclude_html.is_empty() {
-                    section(class="block-transcludes") : Raw(&transclude_html);
-                }
+    if has_transcludes {
+        output.push_str("<section class=\"block-transcludes\">");
+        for (index, transclude_html) in entities_html
+            .iter()
+            .filter_map(|(_, transclude_html)| transclude_html.as_ref())
+            .enumerate()
+        {
+            if index > 0 {
+                output.push('\n');
             }
+            output.push_str(transclude_html);
         }
+        output.push_str("</section>");
     }
-    .to_string())
+
+    output.push_str("</section>");
+
+    Ok(())
 }
 
 /// Given a [Transform] and an [Entity], produce an HTML string
@@ -57,6 +57,10 @@ impl WriteTarget for MemoryWriteTarget {
         Ok(())
     }
 
+    async fn read_file(&self, path: &Path) -> Result<Option<Vec<u8>>> {
+        Ok(self.read(path).await)
+    }
+
     async fn symlink(&self, src: &Path, dst: &Path) -> Result<()> {
         let mut aliases = self.aliases.lock().await;
         aliases.insert(dst.to_path_buf(), src.to_path_buf());
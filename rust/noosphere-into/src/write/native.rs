@@ -54,10 +54,26 @@ impl WriteTarget for NativeFs {
         Ok(())
     }
 
+    async fn read_file(&self, path: &Path) -> Result<Option<Vec<u8>>> {
+        NativeFs::assert_relative(path)?;
+
+        match tokio::fs::read(self.root.join(path)).await {
+            Ok(contents) => Ok(Some(contents)),
+            Err(error) if error.kind() == std::io::ErrorKind::NotFound => Ok(None),
+            Err(error) => Err(error.into()),
+        }
+    }
+
     async fn symlink(&self, src: &Path, dst: &Path) -> Result<()> {
         NativeFs::assert_relative(src)?;
         NativeFs::assert_relative(dst)?;
 
+        if let Ok(metadata) = tokio::fs::symlink_metadata(self.root.join(dst)).await {
+            if metadata.file_type().is_symlink() {
+                tokio::fs::remove_file(self.root.join(dst)).await?;
+            }
+        }
+
         #[cfg(not(windows))]
         let result = tokio::fs::symlink(self.root.join(src), self.root.join(dst)).await?;
         #[cfg(windows)]
@@ -31,7 +31,11 @@ pub trait WriteTarget: Clone + WriteTargetConditionalSendSync {
     where
         R: AsyncRead + Unpin + WriteTargetConditionalSend;
 
-    /// Create a symbolic link between the give source path and destination path
+    /// Read the contents of the file at the provided path, if there is one
+    async fn read_file(&self, path: &Path) -> Result<Option<Vec<u8>>>;
+
+    /// Create a symbolic link between the give source path and destination
+    /// path, replacing any symbolic link that is already at the destination
     async fn symlink(&self, src: &Path, dst: &Path) -> Result<()>;
 
     /// Spawn a [Future] in a platform-appropriate fashion and poll it to
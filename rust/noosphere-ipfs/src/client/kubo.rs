@@ -16,7 +16,7 @@ use tokio_util::compat::TokioAsyncReadCompatExt;
 use ipfs_api_prelude::response::{PinAddResponse, PinLsResponse};
 use libipld_cbor::DagCborCodec;
 use libipld_core::raw::RawCodec;
-use noosphere_common::ConditionalSend;
+use noosphere_common::{metrics::metrics, ConditionalSend};
 use serde_json::Value;
 use tokio::select;
 use url::Url;
@@ -66,6 +66,7 @@ impl IpfsClient for KuboClient {
         I: IntoIterator<Item = &'a Cid> + ConditionalSend + std::fmt::Debug,
         I::IntoIter: ConditionalSend,
     {
+        let _timer = metrics().ipfs.request_duration.start_timer("pin_blocks");
         let mut api_url = self.api_url.clone();
         api_url.set_path("/api/v0/pin/add");
 
@@ -93,6 +94,10 @@ impl IpfsClient for KuboClient {
 
     #[instrument(skip(self), level = "trace")]
     async fn block_is_pinned(&self, cid: &Cid) -> Result<bool> {
+        let _timer = metrics()
+            .ipfs
+            .request_duration
+            .start_timer("block_is_pinned");
         let mut api_url = self.api_url.clone();
         let cid_base64 = cid.to_string();
 
@@ -114,6 +119,10 @@ impl IpfsClient for KuboClient {
 
     #[instrument(skip(self), level = "trace")]
     async fn server_identity(&self) -> Result<String> {
+        let _timer = metrics()
+            .ipfs
+            .request_duration
+            .start_timer("server_identity");
         let mut api_url = self.api_url.clone();
 
         api_url.set_path("/api/v0/id");
@@ -146,6 +155,10 @@ impl IpfsClient for KuboClient {
     where
         R: IpfsClientAsyncReadSendSync,
     {
+        let _timer = metrics()
+            .ipfs
+            .request_duration
+            .start_timer("syndicate_blocks");
         let mut api_url = self.api_url.clone();
         let mut form = Form::default();
 
@@ -181,6 +194,7 @@ impl IpfsClient for KuboClient {
 
     #[instrument(skip(self), level = "trace")]
     async fn get_block(&self, cid: &Cid) -> Result<Option<Vec<u8>>> {
+        let _timer = metrics().ipfs.request_duration.start_timer("get_block");
         let output_codec = get_codec(cid)?;
         let mut api_url = self.api_url.clone();
         api_url.set_path("/api/v0/dag/get");
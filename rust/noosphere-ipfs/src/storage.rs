@@ -3,7 +3,7 @@ use anyhow::Result;
 use async_trait::async_trait;
 use cid::Cid;
 use noosphere_common::ConditionalSync;
-use noosphere_storage::{BlockStore, Storage};
+use noosphere_storage::{BlockStore, Space, Storage, StorageStats};
 use std::sync::Arc;
 use tokio::sync::RwLock;
 
@@ -58,6 +58,22 @@ where
     }
 }
 
+#[cfg_attr(not(target_arch = "wasm32"), async_trait)]
+#[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
+impl<S, C> Space for IpfsStorage<S, C>
+where
+    S: Storage + Space + ConditionalSync,
+    C: IpfsClient + ConditionalSync,
+{
+    async fn get_space_usage(&self) -> Result<u64> {
+        self.local_storage.get_space_usage().await
+    }
+
+    async fn get_storage_stats(&self) -> Result<StorageStats> {
+        self.local_storage.get_storage_stats().await
+    }
+}
+
 /// An implementation of [BlockStore] that wraps some other implementation of
 /// same. It forwards most behavior to its wrapped implementation, except when
 /// reading blocks. In that case, if a block cannot be found locally, it will
@@ -0,0 +1,309 @@
+//! Simulates a large name system network in a single process, to see how
+//! publishing and resolving records behave as the network grows.
+//!
+//! Every node is a real [DhtNode], connected to its peers over libp2p's
+//! in-process memory transport, where each write is delayed by a fixed
+//! latency. Between rounds, a fraction of the nodes leave the network and are
+//! replaced by new ones (churn).
+//!
+//! `cargo run --release --example simulation -- --nodes 500 --latency-ms 20`
+//!
+//! Options (defaults in parentheses):
+//!
+//! - `--nodes <n>` (100): nodes in the network, besides the bootstrap node
+//! - `--latency-ms <ms>` (10): delay added to every write to a connection
+//! - `--churn <fraction>` (0.1): fraction of nodes replaced between rounds
+//! - `--rounds <n>` (3): rounds of publishing and resolving
+//! - `--records <n>` (50): records published, then resolved, per round
+//! - `--parallelism <n>` (16): publishes or resolves running at once
+//! - `--json <path>`: also write the report of each round as JSON
+
+use anyhow::{anyhow, Result};
+use futures::{stream, StreamExt};
+use libp2p::{identity::Keypair, Multiaddr};
+use noosphere_ns::dht::{AllowAllValidator, DhtConfig, DhtNode, DhtTransport};
+use rand::{seq::index::sample, thread_rng};
+use serde::Serialize;
+use std::{
+    env,
+    time::{Duration, Instant},
+};
+
+struct Options {
+    nodes: usize,
+    latency: Duration,
+    churn: f64,
+    rounds: usize,
+    records: usize,
+    parallelism: usize,
+    json: Option<String>,
+}
+
+impl Options {
+    fn from_args() -> Result<Self> {
+        let mut options = Options {
+            nodes: 100,
+            latency: Duration::from_millis(10),
+            churn: 0.1,
+            rounds: 3,
+            records: 50,
+            parallelism: 16,
+            json: None,
+        };
+        let mut args = env::args().skip(1);
+
+        while let Some(arg) = args.next() {
+            let mut value = || args.next().ok_or_else(|| anyhow!("{arg} requires a value"));
+            match arg.as_str() {
+                "--nodes" => options.nodes = value()?.parse::<usize>()?.max(1),
+                "--latency-ms" => options.latency = Duration::from_millis(value()?.parse()?),
+                "--churn" => {
+                    options.churn = value()?.parse()?;
+                    if !(0.0..=1.0).contains(&options.churn) {
+                        return Err(anyhow!("--churn must be between 0.0 and 1.0"));
+                    }
+                }
+                "--rounds" => options.rounds = value()?.parse()?,
+                "--records" => options.records = value()?.parse()?,
+                "--parallelism" => options.parallelism = value()?.parse::<usize>()?.max(1),
+                "--json" => options.json = Some(value()?),
+                _ => return Err(anyhow!("Unknown argument: {arg}")),
+            }
+        }
+
+        Ok(options)
+    }
+}
+
+/// A summary of a set of latencies, in milliseconds.
+#[derive(Serialize)]
+struct Distribution {
+    count: usize,
+    p50: f64,
+    p90: f64,
+    p99: f64,
+    max: f64,
+}
+
+impl Distribution {
+    fn new(mut latencies: Vec<Duration>) -> Self {
+        latencies.sort();
+        let percentile = |p: f64| -> f64 {
+            if latencies.is_empty() {
+                return 0.0;
+            }
+            let index = ((latencies.len() - 1) as f64 * p).round() as usize;
+            latencies[index].as_secs_f64() * 1000.0
+        };
+        Distribution {
+            count: latencies.len(),
+            p50: percentile(0.5),
+            p90: percentile(0.9),
+            p99: percentile(0.99),
+            max: percentile(1.0),
+        }
+    }
+}
+
+#[derive(Serialize)]
+struct RoundReport {
+    round: usize,
+    nodes: usize,
+    publish: Distribution,
+    publish_failures: usize,
+    resolve: Distribution,
+    resolve_misses: usize,
+    resolve_failures: usize,
+    /// Frames written across the whole network during the round
+    writes: u64,
+    /// Bytes written across the whole network during the round
+    bytes: u64,
+}
+
+struct Network {
+    config: DhtConfig,
+    /// Kept alive for the duration of the simulation; new nodes join
+    /// through it
+    _bootstrap: DhtNode,
+    bootstrap_address: Multiaddr,
+    nodes: Vec<DhtNode>,
+}
+
+impl Network {
+    async fn new(config: DhtConfig, size: usize) -> Result<Self> {
+        let bootstrap = DhtNode::new(
+            Keypair::generate_ed25519(),
+            config.clone(),
+            Some(AllowAllValidator {}),
+        )?;
+        let bootstrap_address = bootstrap.listen("/memory/0".parse()?).await?;
+        let mut network = Network {
+            config,
+            _bootstrap: bootstrap,
+            bootstrap_address,
+            nodes: Vec::with_capacity(size),
+        };
+        network.join(size).await?;
+        Ok(network)
+    }
+
+    /// Adds `count` new nodes to the network, returning once each of them
+    /// has at least one peer.
+    async fn join(&mut self, count: usize) -> Result<()> {
+        let joined: Vec<Result<DhtNode>> = stream::iter(0..count)
+            .map(|_| async {
+                let node = DhtNode::new(
+                    Keypair::generate_ed25519(),
+                    self.config.clone(),
+                    Some(AllowAllValidator {}),
+                )?;
+                node.listen("/memory/0".parse()?).await?;
+                node.add_peers(vec![self.bootstrap_address.clone()]).await?;
+                node.wait_for_peers(1).await?;
+                node.bootstrap().await?;
+                Ok(node)
+            })
+            .buffer_unordered(64)
+            .collect()
+            .await;
+
+        for node in joined {
+            self.nodes.push(node?);
+        }
+        Ok(())
+    }
+
+    /// Replaces a random `fraction` of the nodes with new ones.
+    async fn churn(&mut self, fraction: f64) -> Result<()> {
+        let count = ((self.nodes.len() as f64) * fraction).round() as usize;
+        let mut leaving = sample(&mut thread_rng(), self.nodes.len(), count).into_vec();
+        leaving.sort_unstable_by(|a, b| b.cmp(a));
+        for index in leaving {
+            // Dropping a node stops it
+            self.nodes.swap_remove(index);
+        }
+        self.join(count).await
+    }
+
+    fn random_node(&self) -> &DhtNode {
+        &self.nodes[sample(&mut thread_rng(), self.nodes.len(), 1).index(0)]
+    }
+}
+
+async fn run_round(network: &Network, options: &Options, round: usize) -> Result<RoundReport> {
+    let stats = match &network.config.transport {
+        DhtTransport::Memory { stats, .. } => stats.clone(),
+        DhtTransport::Tcp => return Err(anyhow!("Simulations run over the memory transport")),
+    };
+    let (writes, bytes) = (stats.writes(), stats.bytes());
+    let keys: Vec<Vec<u8>> = (0..options.records)
+        .map(|index| format!("round-{round}/record-{index}").into_bytes())
+        .collect();
+
+    let published: Vec<Result<Duration>> = stream::iter(keys.iter())
+        .map(|key| async move {
+            let start = Instant::now();
+            network.random_node().put_record(key, key, 1).await?;
+            Ok(start.elapsed())
+        })
+        .buffer_unordered(options.parallelism)
+        .collect()
+        .await;
+    let publish_failures = published.iter().filter(|result| result.is_err()).count();
+
+    let resolved: Vec<Result<(Duration, bool)>> = stream::iter(keys.iter())
+        .map(|key| async move {
+            let start = Instant::now();
+            let record = network.random_node().get_record(key).await?;
+            Ok((
+                start.elapsed(),
+                record.value.as_deref() == Some(key.as_slice()),
+            ))
+        })
+        .buffer_unordered(options.parallelism)
+        .collect()
+        .await;
+    let resolve_failures = resolved.iter().filter(|result| result.is_err()).count();
+    let resolve_misses = resolved
+        .iter()
+        .filter(|result| matches!(result, Ok((_, false))))
+        .count();
+
+    Ok(RoundReport {
+        round,
+        nodes: network.nodes.len() + 1,
+        publish: Distribution::new(published.into_iter().flatten().collect()),
+        publish_failures,
+        resolve: Distribution::new(
+            resolved
+                .into_iter()
+                .flatten()
+                .map(|(latency, _)| latency)
+                .collect(),
+        ),
+        resolve_misses,
+        resolve_failures,
+        writes: stats.writes() - writes,
+        bytes: stats.bytes() - bytes,
+    })
+}
+
+fn print_report(report: &RoundReport) {
+    println!("Round {} ({} nodes)", report.round, report.nodes);
+    for (name, distribution) in [("publish", &report.publish), ("resolve", &report.resolve)] {
+        println!(
+            "  {name:<8} n={:<5} p50={:>8.1}ms p90={:>8.1}ms p99={:>8.1}ms max={:>8.1}ms",
+            distribution.count,
+            distribution.p50,
+            distribution.p90,
+            distribution.p99,
+            distribution.max
+        );
+    }
+    println!(
+        "  failures: {} publishes, {} resolves ({} resolved without the record)",
+        report.publish_failures, report.resolve_failures, report.resolve_misses
+    );
+    println!(
+        "  traffic: {} writes, {} bytes ({:.1} writes per operation)",
+        report.writes,
+        report.bytes,
+        report.writes as f64 / (report.publish.count + report.resolve.count).max(1) as f64
+    );
+}
+
+#[tokio::main(flavor = "multi_thread")]
+async fn main() -> Result<()> {
+    let options = Options::from_args()?;
+    let config = DhtConfig {
+        transport: DhtTransport::memory(options.latency),
+        peer_dialing_interval: 1,
+        query_timeout: 60,
+        ..Default::default()
+    };
+
+    let start = Instant::now();
+    let mut network = Network::new(config, options.nodes).await?;
+    println!(
+        "Started {} nodes in {:.1}s",
+        options.nodes + 1,
+        start.elapsed().as_secs_f64()
+    );
+
+    let mut reports = Vec::with_capacity(options.rounds);
+    for round in 0..options.rounds {
+        if round > 0 && options.churn > 0.0 {
+            network.churn(options.churn).await?;
+        }
+        let report = run_round(&network, &options, round).await?;
+        print_report(&report);
+        reports.push(report);
+    }
+
+    if let Some(path) = options.json.as_ref() {
+        std::fs::write(path, serde_json::to_string_pretty(&reports)?)?;
+        println!("Wrote report to {path}");
+    }
+
+    Ok(())
+}
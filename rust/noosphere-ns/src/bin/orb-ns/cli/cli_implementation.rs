@@ -65,6 +65,11 @@ pub enum CLICommand {
             value_parser = parse_cli_address::<Url>
         )]
         ipfs_api_url: Option<Url>,
+
+        /// If no configuration path provided, a directory to persist DHT
+        /// records in, so that they survive restarts of this node.
+        #[arg(long)]
+        record_store: Option<PathBuf>,
     },
 
     /// Utility to create keys compatible with Noosphere.
@@ -128,4 +133,6 @@ pub struct CLIConfigFile {
     pub dht_config: DhtConfig,
     #[serde(default, deserialize_with = "deserialize_url")]
     pub ipfs_api_url: Option<Url>,
+    #[serde(default)]
+    pub record_store: Option<PathBuf>,
 }
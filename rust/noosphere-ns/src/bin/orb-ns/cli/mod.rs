@@ -48,6 +48,7 @@ mod test {
                     peers: None,
                     no_default_peers: true,
                     ipfs_api_url: None,
+                    record_store: None,
                 },
                 &key_storage,
             )
@@ -5,6 +5,7 @@ use noosphere::key::InsecureKeyStorage;
 use noosphere_ns::{DhtConfig, Multiaddr, BOOTSTRAP_PEERS};
 use noosphere_ucan::key_material::ed25519::Ed25519KeyMaterial;
 use std::net::SocketAddr;
+use std::path::PathBuf;
 use url::Url;
 
 /// Configuration for [NameSystemRunner], hydrated/resolved from CLI.
@@ -15,6 +16,7 @@ pub struct RunnerNodeConfig {
     pub peers: Vec<Multiaddr>,
     pub dht_config: DhtConfig,
     pub ipfs_api_url: Option<Url>,
+    pub record_store: Option<PathBuf>,
 }
 
 impl RunnerNodeConfig {
@@ -28,6 +30,7 @@ impl RunnerNodeConfig {
         let listening_address = config.listening_address;
         let api_address = config.api_address;
         let ipfs_api_url = config.ipfs_api_url;
+        let record_store = config.record_store;
         let mut peers = config.peers;
         if !config.no_default_peers {
             peers.extend_from_slice(&BOOTSTRAP_PEERS[..]);
@@ -40,6 +43,7 @@ impl RunnerNodeConfig {
             peers,
             dht_config,
             ipfs_api_url,
+            record_store,
         })
     }
 
@@ -57,6 +61,7 @@ impl RunnerNodeConfig {
                 listening_address,
                 api_address,
                 ipfs_api_url,
+                record_store,
             } => match config {
                 Some(config_path) => {
                     let toml_str = tokio::fs::read_to_string(&config_path).await?;
@@ -77,6 +82,7 @@ impl RunnerNodeConfig {
                         no_default_peers,
                         dht_config,
                         ipfs_api_url,
+                        record_store,
                     };
                     Ok(RunnerNodeConfig::try_from_config(key_storage, config).await?)
                 }
@@ -148,6 +154,7 @@ mod tests {
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             &env.key_storage,
         )
@@ -199,6 +206,7 @@ query_timeout = 55
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             &env.key_storage,
         )
@@ -259,6 +267,7 @@ no_default_peers = true
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             &env.key_storage,
         )
@@ -292,6 +301,7 @@ listening_address = 10000
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             CLICommand::Run {
                 api_address: None,
@@ -301,6 +311,7 @@ listening_address = 10000
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             CLICommand::Run {
                 api_address: None,
@@ -310,6 +321,7 @@ listening_address = 10000
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
             CLICommand::Run {
                 api_address: None,
@@ -319,6 +331,7 @@ listening_address = 10000
                 peers: None,
                 no_default_peers: false,
                 ipfs_api_url: None,
+                record_store: None,
             },
         ];
 
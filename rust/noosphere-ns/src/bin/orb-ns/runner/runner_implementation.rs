@@ -1,12 +1,13 @@
 use crate::runner::config::RunnerNodeConfig;
 use anyhow::Result;
 use noosphere_ipfs::{IpfsStore, KuboClient};
-use noosphere_ns::{DhtClient, Multiaddr, NameSystem, PeerId};
-use noosphere_storage::{BlockStoreRetry, MemoryStore, UcanStore};
+use noosphere_ns::{dht::RecordPersistence, DhtClient, Multiaddr, NameSystem, PeerId};
+use noosphere_storage::{BlockStoreRetry, MemoryStore, Storage, UcanStore, METADATA_STORE};
 use serde::Serialize;
 use std::{
     future::Future,
     net::{SocketAddr, TcpListener},
+    path::Path,
     pin::Pin,
     sync::Arc,
     task,
@@ -44,6 +45,10 @@ pub struct NameSystemRunner {
 
 impl NameSystemRunner {
     pub(crate) async fn try_from_config(mut config: RunnerNodeConfig) -> Result<Self> {
+        let persistence = match config.record_store.as_ref() {
+            Some(path) => Some(open_record_persistence(path).await?),
+            None => None,
+        };
         let node = if let Some(ipfs_api_url) = config.ipfs_api_url {
             let store = {
                 let inner = MemoryStore::default();
@@ -51,10 +56,20 @@ impl NameSystemRunner {
                 let inner = BlockStoreRetry::from(inner);
                 Some(UcanStore(inner))
             };
-            NameSystem::new(&config.key_material, config.dht_config.to_owned(), store)?
+            NameSystem::with_record_persistence(
+                &config.key_material,
+                config.dht_config.to_owned(),
+                store,
+                persistence,
+            )?
         } else {
             let store = Some(UcanStore(MemoryStore::default()));
-            NameSystem::new(&config.key_material, config.dht_config.to_owned(), store)?
+            NameSystem::with_record_persistence(
+                &config.key_material,
+                config.dht_config.to_owned(),
+                store,
+                persistence,
+            )?
         };
         let peer_id = node.peer_id().to_owned();
 
@@ -107,6 +122,16 @@ impl Future for NameSystemRunner {
     }
 }
 
+/// Opens the on-disk storage at `path` for persisting DHT records.
+async fn open_record_persistence(path: &Path) -> Result<RecordPersistence> {
+    #[cfg(feature = "rocksdb")]
+    let storage = noosphere_storage::RocksDbStorage::new(path)?;
+    #[cfg(not(feature = "rocksdb"))]
+    let storage = noosphere_storage::SledStorage::new(path)?;
+
+    RecordPersistence::open(storage.get_key_value_store(METADATA_STORE).await?).await
+}
+
 fn socket_addr_to_url(socket_addr: SocketAddr) -> Result<Url> {
     Url::parse(&format!(
         "http://{}:{}",
@@ -1,4 +1,8 @@
-use crate::{dht::DhtConfig, name_system::NameSystem, DhtClient, NameSystemKeyMaterial};
+use crate::{
+    dht::{DhtConfig, RecordPersistence},
+    name_system::NameSystem,
+    DhtClient, NameSystemKeyMaterial,
+};
 use anyhow::{anyhow, Result};
 use libp2p::Multiaddr;
 use noosphere_ucan::store::UcanJwtStore;
@@ -44,6 +48,7 @@ where
     dht_config: DhtConfig,
     key_material: Option<K>,
     ucan_store: Option<S>,
+    record_persistence: Option<RecordPersistence>,
 }
 
 impl<K, S> NameSystemBuilder<K, S>
@@ -112,6 +117,19 @@ where
         self
     }
 
+    /// Restore DHT records from, and persist them to, the provided
+    /// [RecordPersistence], so that they survive restarts.
+    pub fn record_persistence(mut self, persistence: RecordPersistence) -> Self {
+        self.record_persistence = Some(persistence);
+        self
+    }
+
+    /// The most records that the node will hold at once.
+    pub fn record_store_max_records(mut self, max_records: usize) -> Self {
+        self.dht_config.record_store_max_records = max_records;
+        self
+    }
+
     /// How long, in seconds, records remain valid for. Should be significantly
     /// longer than `publication_interval`.
     /// See [KademliaConfig::set_record_ttl] and [KademliaConfig::set_provider_record_ttl].
@@ -128,6 +146,54 @@ where
         self
     }
 
+    /// How many valid records a name resolution gathers before settling on
+    /// the most recent of them.
+    pub fn resolution_quorum(mut self, quorum: usize) -> Self {
+        self.dht_config.resolution_quorum = quorum;
+        self
+    }
+
+    /// How long, in milliseconds, a name resolution waits for its quorum once
+    /// it has found at least one valid record.
+    pub fn resolution_deadline_ms(mut self, deadline: u64) -> Self {
+        self.dht_config.resolution_deadline_ms = deadline;
+        self
+    }
+
+    /// The most DHT queries that run at once; further requests are queued.
+    pub fn max_inflight_queries(mut self, max_inflight_queries: usize) -> Self {
+        self.dht_config.max_inflight_queries = max_inflight_queries;
+        self
+    }
+
+    /// The most requests that wait for one of the `max_inflight_queries`;
+    /// further requests fail.
+    pub fn max_queued_queries(mut self, max_queued_queries: usize) -> Self {
+        self.dht_config.max_queued_queries = max_queued_queries;
+        self
+    }
+
+    /// How many records may be validated in parallel, off of the DHT's event
+    /// loop.
+    pub fn validation_concurrency(mut self, concurrency: usize) -> Self {
+        self.dht_config.validation_concurrency = concurrency;
+        self
+    }
+
+    /// The most records that wait to be validated; further records are
+    /// dropped or refused.
+    pub fn max_queued_validations(mut self, max_queued_validations: usize) -> Self {
+        self.dht_config.max_queued_validations = max_queued_validations;
+        self
+    }
+
+    /// How many validated records are remembered so that they are not
+    /// verified again.
+    pub fn validation_cache_capacity(mut self, capacity: usize) -> Self {
+        self.dht_config.validation_cache_capacity = capacity;
+        self
+    }
+
     /// Build a [NameSystem] based off of the provided configuration.
     pub async fn build(mut self) -> Result<NameSystem> {
         let key_material = self
@@ -137,7 +203,12 @@ where
         let ucan_store = self
             .ucan_store
             .ok_or_else(|| anyhow!("ucan_store is required"))?;
-        let ns = NameSystem::new(&key_material, self.dht_config.clone(), Some(ucan_store))?;
+        let ns = NameSystem::with_record_persistence(
+            &key_material,
+            self.dht_config.clone(),
+            Some(ucan_store),
+            self.record_persistence,
+        )?;
 
         if let Some(listening_address) = self.listening_address {
             ns.listen(listening_address).await?;
@@ -171,6 +242,7 @@ where
             key_material: None,
             listening_address: None,
             ucan_store: None,
+            record_persistence: None,
         }
     }
 }
@@ -0,0 +1,751 @@
+use crate::NameResolver;
+use anyhow::{anyhow, Result};
+use async_trait::async_trait;
+use futures::future::{join_all, BoxFuture, FutureExt, Shared};
+use noosphere_common::metrics::metrics;
+use noosphere_core::data::{Did, LinkRecord};
+use std::{
+    collections::{BTreeMap, HashMap},
+    sync::{Arc, Mutex},
+    time::{Duration, Instant, SystemTime, UNIX_EPOCH},
+};
+use tokio::task::AbortHandle;
+
+type PendingResolution = Shared<BoxFuture<'static, Result<Option<LinkRecord>, Arc<anyhow::Error>>>>;
+type BatchResolution = Shared<
+    BoxFuture<'static, Option<Arc<HashMap<Did, Result<Option<LinkRecord>, Arc<anyhow::Error>>>>>>,
+>;
+
+/// Configuration for a [CachingNameResolver].
+#[derive(Clone, Debug)]
+pub struct NameResolverCacheConfig {
+    /// How long a resolved record is served without being refreshed. Once
+    /// this has passed, the cached record is still served, but it is
+    /// refreshed in the background.
+    pub refresh_after: Duration,
+    /// Records are also refreshed in the background once they are this close
+    /// to the expiry of their UCAN, whether or not they are resolved again.
+    pub refresh_before_expiry: Duration,
+    /// How long it is remembered that no record could be found for a DID.
+    pub missing_record_ttl: Duration,
+    /// The most DIDs to hold resolutions for; the least recently resolved
+    /// are evicted first.
+    pub capacity: usize,
+}
+
+impl Default for NameResolverCacheConfig {
+    fn default() -> Self {
+        NameResolverCacheConfig {
+            refresh_after: Duration::from_secs(60),
+            refresh_before_expiry: Duration::from_secs(60 * 5),
+            missing_record_ttl: Duration::from_secs(30),
+            capacity: 1024,
+        }
+    }
+}
+
+struct CachedResolution {
+    record: Option<LinkRecord>,
+    resolved_at: Instant,
+    /// Orders resolutions by when they were stored; see
+    /// [CacheState::by_sequence]
+    sequence: u64,
+    /// The scheduled refresh of `record` ahead of its expiry, if any
+    refresh: Option<AbortHandle>,
+}
+
+impl Drop for CachedResolution {
+    fn drop(&mut self) {
+        if let Some(refresh) = self.refresh.take() {
+            refresh.abort();
+        }
+    }
+}
+
+enum Lookup {
+    Hit(Option<LinkRecord>),
+    Stale(LinkRecord),
+    Miss,
+}
+
+#[derive(Default)]
+struct CacheState {
+    resolutions: HashMap<Did, CachedResolution>,
+    /// The DIDs of `resolutions` by the sequence number of their resolution,
+    /// so that the least recently resolved is found without a scan
+    by_sequence: BTreeMap<u64, Did>,
+    next_sequence: u64,
+    pending: HashMap<Did, PendingResolution>,
+}
+
+/// A [NameResolver] that caches the [LinkRecord]s resolved by another
+/// [NameResolver], so that repeatedly resolving the same DIDs does not wait on
+/// a full name system query every time.
+///
+/// - Cached records are served for as long as their UCAN is valid
+/// - Once a cached record is older than
+///   [NameResolverCacheConfig::refresh_after] (or nears its expiry), it is
+///   still served, and is refreshed in the background
+///   (stale-while-revalidate)
+/// - A cached record that nears its expiry is refreshed in the background
+///   even if it is not resolved again
+/// - Concurrent resolutions of the same DID share a single query
+/// - A refreshed record only replaces the cached one if it supersedes it
+///
+/// Clones share the same cache.
+pub struct CachingNameResolver<R>
+where
+    R: NameResolver + 'static,
+{
+    resolver: Arc<R>,
+    config: Arc<NameResolverCacheConfig>,
+    state: Arc<Mutex<CacheState>>,
+}
+
+impl<R> Clone for CachingNameResolver<R>
+where
+    R: NameResolver + 'static,
+{
+    fn clone(&self) -> Self {
+        CachingNameResolver {
+            resolver: self.resolver.clone(),
+            config: self.config.clone(),
+            state: self.state.clone(),
+        }
+    }
+}
+
+fn is_expired(record: &LinkRecord) -> bool {
+    record.is_expired(None)
+}
+
+/// Whether `record`'s UCAN expires within `window` from now.
+fn expires_within(record: &LinkRecord, window: Duration) -> bool {
+    let now = SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .unwrap_or_default()
+        .as_secs();
+    match record.expires_at() {
+        Some(expires_at) => expires_at.saturating_sub(now) < window.as_secs(),
+        None => false,
+    }
+}
+
+impl<R> CachingNameResolver<R>
+where
+    R: NameResolver + 'static,
+{
+    pub fn new(resolver: Arc<R>, config: NameResolverCacheConfig) -> Self {
+        CachingNameResolver {
+            resolver,
+            config: Arc::new(config),
+            state: Default::default(),
+        }
+    }
+
+    /// The [NameResolver] that records are resolved with.
+    pub fn resolver(&self) -> &Arc<R> {
+        &self.resolver
+    }
+
+    /// Remember `record` as the latest known record of its sphere, unless a
+    /// newer one is already cached. Useful when a record is learned about
+    /// other than by resolving it (e.g. because it was just published).
+    pub fn insert(&self, record: LinkRecord) {
+        let mut state = self.state.lock().unwrap();
+        let identity = record.to_sphere_identity();
+        let cached = state
+            .resolutions
+            .get(&identity)
+            .and_then(|resolution| resolution.record.clone());
+        let record = self.newest(cached, Some(record));
+        self.store(&mut state, identity, record);
+    }
+
+    fn lookup(&self, identity: &Did) -> Lookup {
+        let state = self.state.lock().unwrap();
+        let resolution = match state.resolutions.get(identity) {
+            Some(resolution) => resolution,
+            None => return Lookup::Miss,
+        };
+        let age = resolution.resolved_at.elapsed();
+
+        match &resolution.record {
+            Some(record) if is_expired(record) => Lookup::Miss,
+            Some(record)
+                if age >= self.config.refresh_after
+                    || expires_within(record, self.config.refresh_before_expiry) =>
+            {
+                Lookup::Stale(record.clone())
+            }
+            Some(record) => Lookup::Hit(Some(record.clone())),
+            None if age < self.config.missing_record_ttl => Lookup::Hit(None),
+            None => Lookup::Miss,
+        }
+    }
+
+    /// Of a `cached` record and a `resolved` one, the one that should be
+    /// served from now on.
+    fn newest(
+        &self,
+        cached: Option<LinkRecord>,
+        resolved: Option<LinkRecord>,
+    ) -> Option<LinkRecord> {
+        match (cached, resolved) {
+            (Some(cached), Some(resolved))
+                if !is_expired(&cached) && !cached.superceded_by(&resolved) =>
+            {
+                Some(cached)
+            }
+            // The name system may briefly lose track of a record that is
+            // still valid; keep serving it
+            (Some(cached), None) if !is_expired(&cached) => Some(cached),
+            (_, resolved) => resolved,
+        }
+    }
+
+    fn store(&self, state: &mut CacheState, identity: Did, record: Option<LinkRecord>) {
+        let sequence = state.next_sequence;
+        state.next_sequence += 1;
+
+        let refresh = record
+            .as_ref()
+            .and_then(|record| self.schedule_refresh(&identity, record, sequence));
+        let previous = state.resolutions.insert(
+            identity.clone(),
+            CachedResolution {
+                record,
+                resolved_at: Instant::now(),
+                sequence,
+                refresh,
+            },
+        );
+
+        if let Some(previous) = previous {
+            state.by_sequence.remove(&previous.sequence);
+        }
+        state.by_sequence.insert(sequence, identity);
+
+        while state.resolutions.len() > self.config.capacity.max(1) {
+            match state.by_sequence.pop_first() {
+                Some((_, identity)) => state.resolutions.remove(&identity),
+                None => break,
+            };
+        }
+    }
+
+    /// Arranges for the cached `record` of `identity` to be refreshed once it
+    /// is within [NameResolverCacheConfig::refresh_before_expiry] of its
+    /// expiry, unless it has been replaced or evicted by then. Nothing is
+    /// scheduled for a record that is already that close to its expiry; it is
+    /// refreshed when it is next resolved instead.
+    fn schedule_refresh(
+        &self,
+        identity: &Did,
+        record: &LinkRecord,
+        sequence: u64,
+    ) -> Option<AbortHandle> {
+        let runtime = tokio::runtime::Handle::try_current().ok()?;
+        let now = SystemTime::now()
+            .duration_since(UNIX_EPOCH)
+            .unwrap_or_default()
+            .as_secs();
+        let refresh_in = record
+            .expires_at()?
+            .checked_sub(now)?
+            .checked_sub(self.config.refresh_before_expiry.as_secs())
+            .filter(|seconds| *seconds > 0)?;
+
+        // Only hold the cache weakly, so that a scheduled refresh does not
+        // keep it alive
+        let state = Arc::downgrade(&self.state);
+        let resolver = self.resolver.clone();
+        let config = self.config.clone();
+        let identity = identity.clone();
+
+        let refresh = runtime.spawn(async move {
+            tokio::time::sleep(Duration::from_secs(refresh_in)).await;
+
+            let cache = match state.upgrade() {
+                Some(state) => CachingNameResolver {
+                    resolver,
+                    config,
+                    state,
+                },
+                None => return,
+            };
+            let is_current = cache
+                .state
+                .lock()
+                .unwrap()
+                .resolutions
+                .get(&identity)
+                .map(|resolution| resolution.sequence == sequence)
+                .unwrap_or_default();
+
+            if is_current {
+                if let Err(error) = cache.pending_resolution(&identity).await {
+                    warn!("Could not refresh record for {}: {}", identity, error);
+                }
+            }
+        });
+
+        Some(refresh.abort_handle())
+    }
+
+    /// Returns the in-flight resolution of `identity`, starting one if there
+    /// isn't one yet.
+    fn pending_resolution(&self, identity: &Did) -> PendingResolution {
+        let resolver = self.resolver.clone();
+        let did = identity.clone();
+
+        self.pending_resolution_with(
+            identity,
+            async move { resolver.resolve(&did).await }.boxed(),
+        )
+    }
+
+    /// Returns the in-flight resolution of `identity`, starting `resolution`
+    /// as its resolution if there isn't one yet.
+    fn pending_resolution_with(
+        &self,
+        identity: &Did,
+        resolution: BoxFuture<'static, Result<Option<LinkRecord>>>,
+    ) -> PendingResolution {
+        let mut state = self.state.lock().unwrap();
+
+        if let Some(pending) = state.pending.get(identity) {
+            return pending.clone();
+        }
+
+        let cache = self.clone();
+        let did = identity.clone();
+        let pending = async move {
+            let result = resolution.await;
+            let mut state = cache.state.lock().unwrap();
+
+            state.pending.remove(&did);
+
+            match result {
+                Ok(resolved) => {
+                    let cached = state
+                        .resolutions
+                        .get(&did)
+                        .and_then(|resolution| resolution.record.clone());
+                    let record = cache.newest(cached, resolved);
+                    cache.store(&mut state, did, record.clone());
+                    Ok(record)
+                }
+                Err(error) => Err(Arc::new(error)),
+            }
+        }
+        .boxed()
+        .shared();
+
+        state.pending.insert(identity.clone(), pending.clone());
+        pending
+    }
+
+    /// Returns the in-flight resolutions of `identities`. Those that are not
+    /// already being resolved are resolved together with a single batch query
+    /// of the wrapped [NameResolver]; if the batch fails (or leaves a DID out),
+    /// its DIDs are resolved one at a time instead.
+    fn pending_batch_resolutions(&self, identities: Vec<Did>) -> Vec<(Did, PendingResolution)> {
+        let mut resolutions = Vec::with_capacity(identities.len());
+        let mut batch = Vec::new();
+
+        {
+            let state = self.state.lock().unwrap();
+            for identity in identities {
+                match state.pending.get(&identity) {
+                    Some(pending) => resolutions.push((identity, pending.clone())),
+                    None => batch.push(identity),
+                }
+            }
+        }
+
+        if batch.is_empty() {
+            return resolutions;
+        }
+
+        let batch_resolution: BatchResolution = {
+            let resolver = self.resolver.clone();
+            let identities = batch.clone();
+            async move {
+                match resolver.resolve_many(identities).await {
+                    Ok(outcomes) => Some(Arc::new(
+                        outcomes
+                            .into_iter()
+                            .map(|(identity, result)| (identity, result.map_err(Arc::new)))
+                            .collect(),
+                    )),
+                    Err(error) => {
+                        warn!("Could not resolve records as a batch: {}", error);
+                        None
+                    }
+                }
+            }
+            .boxed()
+            .shared()
+        };
+
+        for identity in batch {
+            let resolver = self.resolver.clone();
+            let batch_resolution = batch_resolution.clone();
+            let did = identity.clone();
+            let resolution = async move {
+                let outcome = batch_resolution
+                    .await
+                    .and_then(|outcomes| outcomes.get(&did).cloned());
+
+                match outcome {
+                    Some(result) => result.map_err(|error| anyhow!("{}", error)),
+                    None => resolver.resolve(&did).await,
+                }
+            }
+            .boxed();
+
+            let pending = self.pending_resolution_with(&identity, resolution);
+            resolutions.push((identity, pending));
+        }
+
+        resolutions
+    }
+}
+
+#[async_trait]
+impl<R> NameResolver for CachingNameResolver<R>
+where
+    R: NameResolver + 'static,
+{
+    async fn publish(&self, record: LinkRecord) -> Result<()> {
+        self.resolver.publish(record.clone()).await?;
+        self.insert(record);
+        Ok(())
+    }
+
+    async fn resolve(&self, identity: &Did) -> Result<Option<LinkRecord>> {
+        let lookups = &metrics().name_system.cache_lookups;
+
+        match self.lookup(identity) {
+            Lookup::Hit(record) => {
+                lookups.get("hit").inc();
+                Ok(record)
+            }
+            Lookup::Stale(record) => {
+                lookups.get("stale").inc();
+                let pending = self.pending_resolution(identity);
+                let identity = identity.clone();
+                tokio::spawn(async move {
+                    if let Err(error) = pending.await {
+                        warn!("Could not refresh record for {}: {}", identity, error);
+                    }
+                });
+                Ok(Some(record))
+            }
+            Lookup::Miss => {
+                lookups.get("miss").inc();
+                self.pending_resolution(identity)
+                    .await
+                    .map_err(|error| anyhow!("{}", error))
+            }
+        }
+    }
+
+    /// Serves what it can from the cache, and resolves every remaining DID
+    /// with a single batch query of the wrapped [NameResolver] (joining any
+    /// resolutions of them that are already in flight). Never fails as a
+    /// whole: DIDs that could not be resolved have an error outcome.
+    async fn resolve_many(
+        &self,
+        identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        let lookups = &metrics().name_system.cache_lookups;
+        let mut outcomes = Vec::with_capacity(identities.len());
+        let mut misses = Vec::new();
+
+        for identity in identities {
+            match self.lookup(&identity) {
+                Lookup::Hit(record) => {
+                    lookups.get("hit").inc();
+                    outcomes.push((identity, Ok(record)));
+                }
+                Lookup::Stale(record) => {
+                    lookups.get("stale").inc();
+                    outcomes.push((identity.clone(), Ok(Some(record))));
+                    let pending = self.pending_resolution(&identity);
+                    tokio::spawn(async move {
+                        if let Err(error) = pending.await {
+                            warn!("Could not refresh record for {}: {}", identity, error);
+                        }
+                    });
+                }
+                Lookup::Miss => {
+                    lookups.get("miss").inc();
+                    misses.push(identity);
+                }
+            }
+        }
+
+        let resolutions = self.pending_batch_resolutions(misses);
+        let results = join_all(resolutions.iter().map(|(_, pending)| pending.clone())).await;
+
+        for ((identity, _), result) in resolutions.into_iter().zip(results) {
+            outcomes.push((identity, result.map_err(|error| anyhow!("{}", error))));
+        }
+
+        Ok(outcomes)
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::{CachingNameResolver, NameResolverCacheConfig};
+    use crate::{
+        helpers::{KeyValueNameResolver, UnbatchedResolver},
+        name_resolver_tests, NameResolver,
+    };
+    use anyhow::Result;
+    use async_trait::async_trait;
+    use cid::Cid;
+    use noosphere_core::{
+        authority::{generate_capability, generate_ed25519_key, SphereAbility},
+        data::{Did, LinkRecord, LINK_RECORD_FACT_NAME},
+    };
+    use noosphere_ucan::{builder::UcanBuilder, crypto::KeyMaterial};
+    use std::{
+        sync::{
+            atomic::{AtomicUsize, Ordering},
+            Arc,
+        },
+        time::Duration,
+    };
+
+    /// Counts resolutions, and takes a while to resolve so that concurrent
+    /// resolutions overlap.
+    #[derive(Default)]
+    struct SlowResolver {
+        inner: KeyValueNameResolver,
+        resolutions: AtomicUsize,
+    }
+
+    #[async_trait]
+    impl NameResolver for SlowResolver {
+        async fn publish(&self, record: LinkRecord) -> Result<()> {
+            self.inner.publish(record).await
+        }
+
+        async fn resolve(&self, identity: &Did) -> Result<Option<LinkRecord>> {
+            self.resolutions.fetch_add(1, Ordering::SeqCst);
+            tokio::time::sleep(Duration::from_millis(50)).await;
+            self.inner.resolve(identity).await
+        }
+    }
+
+    async fn make_record(link: &str) -> Result<(Did, LinkRecord)> {
+        let sphere_key = generate_ed25519_key();
+        let sphere_identity = Did::from(sphere_key.get_did().await?);
+        let link: Cid = link.parse()?;
+        let ucan = UcanBuilder::default()
+            .issued_by(&sphere_key)
+            .for_audience(&sphere_identity)
+            .claiming_capability(&generate_capability(
+                &sphere_identity,
+                SphereAbility::Publish,
+            ))
+            .with_fact(LINK_RECORD_FACT_NAME, link.to_string())
+            .with_lifetime(3600)
+            .build()?
+            .sign()
+            .await?;
+        Ok((sphere_identity, LinkRecord::try_from(ucan)?))
+    }
+
+    async fn before_name_resolver_tests() -> Result<CachingNameResolver<KeyValueNameResolver>> {
+        Ok(CachingNameResolver::new(
+            Arc::new(KeyValueNameResolver::new()),
+            Default::default(),
+        ))
+    }
+    name_resolver_tests!(
+        CachingNameResolver<KeyValueNameResolver>,
+        before_name_resolver_tests
+    );
+
+    #[tokio::test]
+    async fn it_coalesces_concurrent_resolutions_and_serves_from_cache() -> Result<()> {
+        let (identity, record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let resolver = Arc::new(SlowResolver::default());
+        resolver.inner.publish(record.clone()).await?;
+        let cache = CachingNameResolver::new(resolver.clone(), Default::default());
+
+        let resolutions = futures::future::join_all((0..5).map(|_| {
+            let cache = cache.clone();
+            let identity = identity.clone();
+            async move { cache.resolve(&identity).await }
+        }))
+        .await;
+
+        for resolution in resolutions {
+            assert_eq!(resolution?, Some(record.clone()));
+        }
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 1);
+
+        assert_eq!(cache.resolve(&identity).await?, Some(record));
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 1);
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_serves_stale_records_while_refreshing_them() -> Result<()> {
+        let (identity, record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let resolver = Arc::new(SlowResolver::default());
+        resolver.inner.publish(record.clone()).await?;
+        let cache = CachingNameResolver::new(
+            resolver.clone(),
+            NameResolverCacheConfig {
+                refresh_after: Duration::ZERO,
+                ..Default::default()
+            },
+        );
+
+        assert_eq!(cache.resolve(&identity).await?, Some(record.clone()));
+
+        // A stale record is served immediately, and refreshed in the background
+        assert_eq!(cache.resolve(&identity).await?, Some(record));
+        tokio::time::sleep(Duration::from_millis(100)).await;
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 2);
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_refreshes_records_ahead_of_their_expiry() -> Result<()> {
+        let (identity, record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let resolver = Arc::new(SlowResolver::default());
+        resolver.inner.publish(record.clone()).await?;
+        // The record's UCAN lives for an hour, so it is due to be refreshed
+        // within the next couple of seconds
+        let cache = CachingNameResolver::new(
+            resolver.clone(),
+            NameResolverCacheConfig {
+                refresh_before_expiry: Duration::from_secs(3600 - 2),
+                ..Default::default()
+            },
+        );
+
+        cache.insert(record.clone());
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 0);
+
+        tokio::time::sleep(Duration::from_millis(2500)).await;
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 1);
+        assert_eq!(cache.resolve(&identity).await?, Some(record));
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_evicts_the_least_recently_resolved_record() -> Result<()> {
+        let cache = CachingNameResolver::new(
+            Arc::new(KeyValueNameResolver::new()),
+            NameResolverCacheConfig {
+                capacity: 2,
+                ..Default::default()
+            },
+        );
+        let mut identities = Vec::new();
+
+        for _ in 0..3 {
+            let (identity, record) =
+                make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+            cache.insert(record);
+            identities.push(identity);
+        }
+
+        let state = cache.state.lock().unwrap();
+        assert_eq!(state.resolutions.len(), 2);
+        assert_eq!(state.by_sequence.len(), 2);
+        assert!(!state.resolutions.contains_key(&identities[0]));
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_only_resolves_cache_misses_of_a_batch() -> Result<()> {
+        let (identity, record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let missing = Did::from("did:key:z6MkmissingRecord");
+        let resolver = Arc::new(SlowResolver::default());
+        resolver.inner.publish(record.clone()).await?;
+        let cache = CachingNameResolver::new(resolver.clone(), Default::default());
+
+        assert_eq!(cache.resolve(&identity).await?, Some(record.clone()));
+
+        let mut resolutions = cache
+            .resolve_many(vec![identity.clone(), missing.clone()])
+            .await?;
+        resolutions.sort_by(|(a, _), (b, _)| a.cmp(b));
+
+        assert_eq!(resolutions.len(), 2);
+        for (did, resolution) in resolutions {
+            if did == identity {
+                assert_eq!(resolution?, Some(record.clone()));
+            } else {
+                assert_eq!(did, missing);
+                assert_eq!(resolution?, None);
+            }
+        }
+        assert_eq!(resolver.resolutions.load(Ordering::SeqCst), 2);
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_resolves_one_at_a_time_when_a_batch_fails() -> Result<()> {
+        let (cached_identity, cached_record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let (identity, record) =
+            make_record("bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i").await?;
+        let missing = Did::from("did:key:z6MkmissingRecord");
+        let resolver = Arc::new(UnbatchedResolver(SlowResolver::default()));
+        resolver.publish(cached_record.clone()).await?;
+        resolver.publish(record.clone()).await?;
+        let cache = CachingNameResolver::new(resolver.clone(), Default::default());
+
+        assert_eq!(
+            cache.resolve(&cached_identity).await?,
+            Some(cached_record.clone())
+        );
+
+        let mut resolutions = cache
+            .resolve_many(vec![
+                cached_identity.clone(),
+                identity.clone(),
+                missing.clone(),
+            ])
+            .await?;
+        resolutions.sort_by(|(a, _), (b, _)| a.cmp(b));
+
+        assert_eq!(resolutions.len(), 3);
+        for (did, resolution) in resolutions {
+            if did == cached_identity {
+                assert_eq!(resolution?, Some(cached_record.clone()));
+            } else if did == identity {
+                assert_eq!(resolution?, Some(record.clone()));
+            } else {
+                assert_eq!(did, missing);
+                assert_eq!(resolution?, None);
+            }
+        }
+        assert_eq!(resolver.0.resolutions.load(Ordering::SeqCst), 3);
+
+        // The records resolved one at a time are cached like any other
+        assert_eq!(cache.resolve(&identity).await?, Some(record));
+        assert_eq!(resolver.0.resolutions.load(Ordering::SeqCst), 3);
+
+        Ok(())
+    }
+}
@@ -0,0 +1,158 @@
+use super::rpc::{DhtMessage, DhtRequest};
+use libp2p::kad::{Quorum, Record};
+use std::collections::VecDeque;
+
+/// A request that starts a Kademlia query, waiting for the
+/// [super::processor::DhtProcessor] to have a free query slot.
+pub enum QueuedQuery {
+    /// A `GetRecord`, `GetRecords`, `GetProviders` or `StartProviding`
+    /// request, which is started as-is.
+    Message(DhtMessage),
+    /// A `PutRecord` request whose record has already been validated.
+    PutRecord {
+        message: DhtMessage,
+        record: Record,
+        quorum: Quorum,
+    },
+}
+
+impl QueuedQuery {
+    /// The request that is waiting on this query.
+    pub fn into_message(self) -> DhtMessage {
+        match self {
+            QueuedQuery::Message(message) | QueuedQuery::PutRecord { message, .. } => message,
+        }
+    }
+
+    /// Whether this query publishes to the network (as opposed to resolving
+    /// from it). Publishes are started ahead of resolves.
+    fn is_publish(&self) -> bool {
+        match self {
+            QueuedQuery::PutRecord { .. } => true,
+            QueuedQuery::Message(message) => {
+                matches!(message.request, DhtRequest::StartProviding { .. })
+            }
+        }
+    }
+}
+
+/// Queries that are waiting to be started, in order of arrival within each
+/// of two priorities: publishes, then resolves. Clients may send requests
+/// faster than queries complete, so the queue holds at most `capacity`
+/// queries.
+pub struct QueryQueue {
+    publishes: VecDeque<QueuedQuery>,
+    resolves: VecDeque<QueuedQuery>,
+    capacity: usize,
+}
+
+impl QueryQueue {
+    pub fn new(capacity: usize) -> Self {
+        QueryQueue {
+            publishes: VecDeque::new(),
+            resolves: VecDeque::new(),
+            capacity,
+        }
+    }
+
+    /// Queues `query`, or hands it back if the queue is full.
+    pub fn push(&mut self, query: QueuedQuery) -> Result<(), QueuedQuery> {
+        if self.depth() >= self.capacity {
+            return Err(query);
+        }
+        if query.is_publish() {
+            self.publishes.push_back(query);
+        } else {
+            self.resolves.push_back(query);
+        }
+        Ok(())
+    }
+
+    /// The next query that should be started.
+    pub fn pop(&mut self) -> Option<QueuedQuery> {
+        self.publishes
+            .pop_front()
+            .or_else(|| self.resolves.pop_front())
+    }
+
+    /// How many queries are waiting to be started.
+    pub fn depth(&self) -> usize {
+        self.publishes.len() + self.resolves.len()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{QueryQueue, QueuedQuery};
+    use crate::dht::{
+        rpc::{DhtMessage, DhtRequest, DhtResponse},
+        DhtError,
+    };
+    use libp2p::kad::{Quorum, Record, RecordKey};
+    use noosphere_common::channel::message_channel;
+
+    async fn message(request: DhtRequest) -> DhtMessage {
+        let (client, mut processor) = message_channel::<DhtRequest, DhtResponse, DhtError>();
+        client.send_oneshot(request).unwrap();
+        processor.pull_message().await.unwrap()
+    }
+
+    fn key_of(query: &QueuedQuery) -> Vec<u8> {
+        match query {
+            QueuedQuery::PutRecord { record, .. } => record.key.to_vec(),
+            QueuedQuery::Message(message) => match &message.request {
+                DhtRequest::GetRecord { key } | DhtRequest::StartProviding { key } => key.clone(),
+                _ => unreachable!(),
+            },
+        }
+    }
+
+    #[tokio::test]
+    async fn it_starts_publishes_before_resolves() {
+        let mut queue = QueryQueue::new(8);
+        let queries = [
+            QueuedQuery::Message(message(DhtRequest::GetRecord { key: b"a".to_vec() }).await),
+            QueuedQuery::PutRecord {
+                message: message(DhtRequest::GetNetworkInfo).await,
+                record: Record::new(RecordKey::new(&b"b"), b"value".to_vec()),
+                quorum: Quorum::One,
+            },
+            QueuedQuery::Message(message(DhtRequest::GetRecord { key: b"c".to_vec() }).await),
+            QueuedQuery::Message(message(DhtRequest::StartProviding { key: b"d".to_vec() }).await),
+        ];
+        for query in queries {
+            assert!(queue.push(query).is_ok());
+        }
+
+        assert_eq!(queue.depth(), 4);
+        let order: Vec<Vec<u8>> = std::iter::from_fn(|| queue.pop())
+            .map(|query| key_of(&query))
+            .collect();
+        assert_eq!(
+            order,
+            vec![b"b".to_vec(), b"d".to_vec(), b"a".to_vec(), b"c".to_vec()]
+        );
+        assert_eq!(queue.depth(), 0);
+    }
+
+    #[tokio::test]
+    async fn it_refuses_queries_beyond_its_capacity() {
+        let mut queue = QueryQueue::new(1);
+        let get_record = |key: &[u8]| DhtRequest::GetRecord { key: key.to_vec() };
+
+        assert!(queue
+            .push(QueuedQuery::Message(message(get_record(b"a")).await))
+            .is_ok());
+        let refused = queue
+            .push(QueuedQuery::Message(message(get_record(b"b")).await))
+            .err()
+            .expect("queue is full");
+
+        assert_eq!(key_of(&refused), b"b".to_vec());
+        assert_eq!(queue.depth(), 1);
+        assert_eq!(key_of(&queue.pop().unwrap()), b"a".to_vec());
+        assert!(queue
+            .push(QueuedQuery::Message(message(get_record(b"c")).await))
+            .is_ok());
+    }
+}
@@ -1,3 +1,4 @@
+use super::DhtTransport;
 use serde::Deserialize;
 
 #[cfg(doc)]
@@ -35,6 +36,50 @@ pub struct DhtConfig {
     /// See [KademliaConfig::set_record_ttl] and [KademliaConfig::set_provider_record_ttl].
     #[serde(default = "default_record_ttl")]
     pub record_ttl: u32,
+    /// How many records may be validated in parallel. Validation happens off
+    /// of the DHT's event loop, so that it never holds up other queries.
+    #[serde(default = "default_validation_concurrency")]
+    pub validation_concurrency: usize,
+    /// The most records that wait for one of the `validation_concurrency`
+    /// slots; records beyond this are dropped (or, when a client asked to
+    /// put them, refused), which bounds the memory that validation uses.
+    #[serde(default = "default_max_queued_validations")]
+    pub max_queued_validations: usize,
+    /// How many validated records are remembered, so that records that are
+    /// seen again (e.g. when they are re-gossiped during replication) are not
+    /// verified again.
+    #[serde(default = "default_validation_cache_capacity")]
+    pub validation_cache_capacity: usize,
+    /// The most records that this node will hold at once; records beyond
+    /// this are rejected, which bounds the memory used by the record store.
+    #[serde(default = "default_record_store_max_records")]
+    pub record_store_max_records: usize,
+    /// How frequently, in seconds, expired records are removed from the
+    /// record store (and from disk, when records are persisted).
+    #[serde(default = "default_record_sweep_interval")]
+    pub record_sweep_interval: u64,
+    /// How many valid records a name resolution gathers from the network
+    /// before settling on the most recent of them.
+    #[serde(default = "default_resolution_quorum")]
+    pub resolution_quorum: usize,
+    /// How long, in milliseconds, a name resolution waits for its quorum
+    /// once it has found at least one valid record; the most recent record
+    /// found by then is used.
+    #[serde(default = "default_resolution_deadline_ms")]
+    pub resolution_deadline_ms: u64,
+    /// The most DHT queries that run at once on behalf of clients; further
+    /// requests wait in a queue, where publishes are started ahead of
+    /// resolves.
+    #[serde(default = "default_max_inflight_queries")]
+    pub max_inflight_queries: usize,
+    /// The most requests that wait in that queue; requests beyond this fail
+    /// rather than wait, which bounds the memory the queue uses.
+    #[serde(default = "default_max_queued_queries")]
+    pub max_queued_queries: usize,
+    /// How the node connects to its peers; always TCP when configured from
+    /// a file.
+    #[serde(skip)]
+    pub transport: DhtTransport,
 }
 
 // We break up defaults into individual functions to support deserializing
@@ -69,6 +114,44 @@ fn default_record_ttl() -> u32 {
     60 * 60 * 24 * 3 // 3 days
 }
 
+fn default_validation_concurrency() -> usize {
+    std::thread::available_parallelism()
+        .map(|parallelism| parallelism.get())
+        .unwrap_or(4)
+}
+
+fn default_max_queued_validations() -> usize {
+    1024
+}
+
+fn default_validation_cache_capacity() -> usize {
+    4096
+}
+
+fn default_record_store_max_records() -> usize {
+    4096
+}
+
+fn default_record_sweep_interval() -> u64 {
+    60 * 5 // 5 minutes
+}
+
+fn default_resolution_quorum() -> usize {
+    3
+}
+
+fn default_resolution_deadline_ms() -> u64 {
+    2000 // 2 seconds
+}
+
+fn default_max_inflight_queries() -> usize {
+    32
+}
+
+fn default_max_queued_queries() -> usize {
+    1024
+}
+
 impl Default for DhtConfig {
     /// Creates a new [DhtConfig] with defaults applied.
     fn default() -> Self {
@@ -79,6 +162,16 @@ impl Default for DhtConfig {
             query_timeout: default_query_timeout(),
             replication_interval: default_replication_interval(),
             record_ttl: default_record_ttl(),
+            validation_concurrency: default_validation_concurrency(),
+            max_queued_validations: default_max_queued_validations(),
+            validation_cache_capacity: default_validation_cache_capacity(),
+            record_store_max_records: default_record_store_max_records(),
+            record_sweep_interval: default_record_sweep_interval(),
+            resolution_quorum: default_resolution_quorum(),
+            resolution_deadline_ms: default_resolution_deadline_ms(),
+            max_inflight_queries: default_max_inflight_queries(),
+            max_queued_queries: default_max_queued_queries(),
+            transport: DhtTransport::default(),
         }
     }
 }
@@ -1,14 +1,20 @@
+mod admission;
 mod config;
 mod errors;
 mod node;
 mod processor;
+mod record_store;
 mod rpc;
 mod swarm;
+mod transport;
 mod types;
+mod validation;
 mod validator;
 
 pub use config::DhtConfig;
 pub use errors::DhtError;
 pub use node::DhtNode;
+pub use record_store::{DhtRecordStore, RecordPersistence};
+pub use transport::{DhtTransport, TransportStats};
 pub use types::{DhtRecord, NetworkInfo, Peer};
 pub use validator::{AllowAllValidator, Validator};
@@ -3,11 +3,12 @@ use crate::dht::{
     processor::DhtProcessor,
     rpc::{DhtMessageClient, DhtRequest, DhtResponse},
     types::{DhtRecord, NetworkInfo, Peer},
-    DhtConfig, Validator,
+    DhtConfig, RecordPersistence, Validator,
 };
 use libp2p::{identity::Keypair, Multiaddr, PeerId};
 use noosphere_common::channel::message_channel;
 use std::time::Duration;
+use tokio::sync::mpsc::UnboundedReceiver;
 
 macro_rules! ensure_response {
     ($response:expr, $matcher:pat => $statement:expr) => {
@@ -52,11 +53,28 @@ impl DhtNode {
         keypair: Keypair,
         config: DhtConfig,
         validator: Option<V>,
+    ) -> Result<Self, DhtError> {
+        Self::with_record_persistence(keypair, config, validator, None)
+    }
+
+    /// Creates a new [DhtNode] whose records are restored from, and
+    /// written through to, the provided [RecordPersistence].
+    pub fn with_record_persistence<V: Validator + 'static>(
+        keypair: Keypair,
+        config: DhtConfig,
+        validator: Option<V>,
+        persistence: Option<RecordPersistence>,
     ) -> Result<Self, DhtError> {
         let peer_id = PeerId::from(keypair.public());
         let channels = message_channel::<DhtRequest, DhtResponse, DhtError>();
-        let thread_handle =
-            DhtProcessor::spawn(&keypair, peer_id, validator, config.clone(), channels.1)?;
+        let thread_handle = DhtProcessor::spawn(
+            &keypair,
+            peer_id,
+            validator,
+            persistence,
+            config.clone(),
+            channels.1,
+        )?;
 
         Ok(DhtNode {
             peer_id,
@@ -188,6 +206,17 @@ impl DhtNode {
         ensure_response!(response, DhtResponse::GetRecord(record) => Ok(record))
     }
 
+    /// Fetches every record keyed by `key` that the network holds, yielding
+    /// each valid value as soon as it is found. The query is finished early
+    /// once the receiver is dropped, so callers can stop as soon as they have
+    /// seen enough records.
+    /// Fails if node is not in an active state.
+    pub async fn get_records(&self, key: &[u8]) -> Result<UnboundedReceiver<Vec<u8>>, DhtError> {
+        let request = DhtRequest::GetRecords { key: key.to_vec() };
+        let response = self.send_request(request).await?;
+        ensure_response!(response, DhtResponse::GetRecords(records) => Ok(records))
+    }
+
     /// Instructs the node to tell its peers that it is providing
     /// the record for `key`.
     /// Fails if node is not in an active state.
@@ -337,6 +366,8 @@ mod test {
                 num_established: 0,
                 num_peers: 0,
                 num_pending: 0,
+                inflight_queries: 0,
+                queued_queries: 0,
             }
         );
 
@@ -388,6 +419,28 @@ mod test {
         Ok(())
     }
 
+    /// Testing that get_records streams every valid record, then closes.
+    #[tokio::test]
+    async fn test_dhtnode_get_records() -> Result<(), DhtError> {
+        initialize_tracing(None);
+        let mut nodes = create_network(2, Some(AllowAllValidator {})).await?;
+        initialize_network(&mut nodes).await?;
+        let (node_a, node_b) = (nodes.pop().unwrap(), nodes.pop().unwrap());
+
+        node_a.put_record(b"foo", b"bar", 1).await?;
+        let mut records = node_b.get_records(b"foo").await?;
+        let mut found = vec![];
+        while let Some(value) = records.recv().await {
+            found.push(value);
+        }
+        assert!(!found.is_empty());
+        assert!(found.iter().all(|value| value == b"bar"));
+
+        let mut records = node_b.get_records(b"missing").await?;
+        assert!(records.recv().await.is_none());
+        Ok(())
+    }
+
     /// Testing primitive start_providing/get_providers.
     #[tokio::test]
     async fn test_dhtnode_providers() -> Result<(), DhtError> {
@@ -412,7 +465,7 @@ mod test {
 
         #[async_trait]
         impl Validator for MyValidator {
-            async fn validate(&mut self, data: &[u8]) -> bool {
+            async fn validate(&self, data: &[u8]) -> bool {
                 data == b"VALID"
             }
         }
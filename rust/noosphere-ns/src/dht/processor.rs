@@ -1,9 +1,11 @@
 use super::{
+    admission::{QueryQueue, QueuedQuery},
     errors::DhtError,
     rpc::{DhtMessage, DhtMessageProcessor, DhtRequest, DhtResponse},
     swarm::{build_swarm, DhtBehavior, DhtEvent, DhtSwarmEvent},
-    types::{DhtRecord, Peer},
-    DhtConfig, Validator,
+    types::{DhtRecord, NetworkInfo, Peer},
+    validation::{PendingValidation, ValidationPool},
+    DhtConfig, RecordPersistence, Validator,
 };
 use libp2p::{
     core::transport::ListenerId,
@@ -23,6 +25,59 @@ use libp2p::{
 };
 use std::{collections::HashMap, time::Duration};
 use std::{fmt, num::NonZeroUsize};
+use tokio::sync::mpsc::{unbounded_channel, UnboundedReceiver, UnboundedSender};
+
+/// A `GetRecords` query whose valid records are streamed back to its clients
+/// as they are found.
+struct RecordStream {
+    key: Vec<u8>,
+    /// One sender for each request that is reading the stream; requests for
+    /// the same key that arrive while the query runs join it.
+    senders: Vec<UnboundedSender<Vec<u8>>>,
+    /// The valid records streamed so far, replayed to requests that join.
+    found: Vec<Vec<u8>>,
+    /// Found records that are still being validated.
+    pending_validations: usize,
+    /// Whether the DHT query has completed.
+    finished: bool,
+}
+
+impl RecordStream {
+    fn new(key: Vec<u8>) -> Self {
+        RecordStream {
+            key,
+            senders: Vec::new(),
+            found: Vec::new(),
+            pending_validations: 0,
+            finished: false,
+        }
+    }
+
+    /// Adds a client to the stream, which first receives the records that
+    /// have already been streamed.
+    fn join(&mut self) -> UnboundedReceiver<Vec<u8>> {
+        let (sender, receiver) = unbounded_channel();
+        for value in &self.found {
+            let _ = sender.send(value.clone());
+        }
+        self.senders.push(sender);
+        receiver
+    }
+
+    /// Streams a valid record to every client. Returns whether any client is
+    /// still listening.
+    fn send(&mut self, value: Vec<u8>) -> bool {
+        self.senders
+            .retain(|sender| sender.send(value.clone()).is_ok());
+        self.found.push(value);
+        !self.senders.is_empty()
+    }
+
+    /// Whether every client has stopped listening.
+    fn is_abandoned(&self) -> bool {
+        self.senders.iter().all(|sender| sender.is_closed())
+    }
+}
 
 /// The processing component of a [DHTNode]/[DHTProcessor] pair. Consumers
 /// should only interface with a [DHTProcessor] via [DHTNode].
@@ -32,8 +87,19 @@ pub struct DhtProcessor<V: Validator + 'static> {
     processor: DhtMessageProcessor,
     swarm: Swarm<DhtBehavior>,
     requests: HashMap<kad::QueryId, DhtMessage>,
+    record_streams: HashMap<kad::QueryId, RecordStream>,
+    /// Requests waiting for one of `max_inflight_queries` query slots.
+    queued_queries: QueryQueue,
+    /// The in-flight `GetRecord` query for each key, so that concurrent
+    /// requests for the same key share a single query.
+    get_record_queries: HashMap<Vec<u8>, kad::QueryId>,
+    /// The in-flight `GetRecords` query for each key, which concurrent
+    /// requests for the same key join in the same way.
+    record_stream_queries: HashMap<Vec<u8>, kad::QueryId>,
+    /// Requests that joined an in-flight `GetRecord` query.
+    coalesced_requests: HashMap<kad::QueryId, Vec<DhtMessage>>,
     kad_last_range: Option<(KBucketDistance, KBucketDistance)>,
-    validator: Option<V>,
+    validation: ValidationPool<V>,
     active_listener: Option<ListenerId>,
     pending_listener_request: Option<DhtMessage>,
 }
@@ -66,24 +132,48 @@ where
         keypair: &Keypair,
         peer_id: PeerId,
         validator: Option<V>,
+        persistence: Option<RecordPersistence>,
         config: DhtConfig,
         processor: DhtMessageProcessor,
     ) -> Result<tokio::task::JoinHandle<Result<(), DhtError>>, DhtError> {
-        let swarm = build_swarm(keypair, &peer_id, &config)?;
+        let mut node =
+            DhtProcessor::new(keypair, peer_id, validator, persistence, config, processor)?;
 
-        let mut node = DhtProcessor {
+        Ok(tokio::spawn(async move { node.process().await }))
+    }
+
+    fn new(
+        keypair: &Keypair,
+        peer_id: PeerId,
+        validator: Option<V>,
+        persistence: Option<RecordPersistence>,
+        config: DhtConfig,
+        processor: DhtMessageProcessor,
+    ) -> Result<Self, DhtError> {
+        let swarm = build_swarm(keypair, &peer_id, &config, persistence)?;
+        let validation = ValidationPool::new(
+            validator,
+            config.validation_concurrency,
+            config.max_queued_validations,
+            config.validation_cache_capacity,
+        );
+
+        Ok(DhtProcessor {
             peer_id,
-            config,
             processor,
             swarm,
             requests: HashMap::default(),
+            record_streams: HashMap::default(),
+            queued_queries: QueryQueue::new(config.max_queued_queries),
+            get_record_queries: HashMap::default(),
+            record_stream_queries: HashMap::default(),
+            coalesced_requests: HashMap::default(),
             active_listener: None,
             kad_last_range: None,
-            validator,
+            validation,
             pending_listener_request: None,
-        };
-
-        Ok(tokio::spawn(async move { node.process().await }))
+            config,
+        })
     }
 
     /// Begin processing requests and connections on the DHT network
@@ -99,6 +189,10 @@ where
         let mut peer_dialing_tick =
             tokio::time::interval(Duration::from_secs(self.config.peer_dialing_interval));
 
+        // Remove expired records from the record store on this interval.
+        let mut record_sweep_tick =
+            tokio::time::interval(Duration::from_secs(self.config.record_sweep_interval));
+
         loop {
             tokio::select! {
                 message = self.processor.pull_message() => {
@@ -115,9 +209,16 @@ where
                 event = self.swarm.select_next_some() => {
                     self.process_swarm_event(event).await
                 }
+                (pending, is_valid) = self.validation.next_outcome() => {
+                    self.complete_validation(pending, is_valid)
+                }
                 _ = bootstrap_tick.tick() => self.execute_bootstrap()?,
                 _ = peer_dialing_tick.tick() => self.dial_next_peer(),
+                _ = record_sweep_tick.tick() => self.sweep_records(),
             }
+
+            self.finish_abandoned_record_streams();
+            self.start_queued_queries();
         }
         Ok(())
     }
@@ -161,17 +262,11 @@ where
             DhtRequest::Bootstrap => {
                 message.respond(self.execute_bootstrap().map(|_| DhtResponse::Success));
             }
-            DhtRequest::GetProviders { ref key } => {
-                store_request!(
-                    self,
-                    message,
-                    Ok::<kad::QueryId, DhtError>(
-                        self.swarm
-                            .behaviour_mut()
-                            .kad
-                            .get_providers(RecordKey::new(key))
-                    )
-                );
+            DhtRequest::GetProviders { .. }
+            | DhtRequest::StartProviding { .. }
+            | DhtRequest::GetRecord { .. }
+            | DhtRequest::GetRecords { .. } => {
+                self.admit_query(QueuedQuery::Message(message));
             }
             /*
             DHTRequest::WaitForPeers(peers) => {
@@ -184,8 +279,10 @@ where
             }
             */
             DhtRequest::GetNetworkInfo => {
-                let info = self.swarm.network_info();
-                message.respond(Ok(DhtResponse::GetNetworkInfo(info.into())));
+                let mut info: NetworkInfo = self.swarm.network_info().into();
+                info.inflight_queries = self.inflight_queries();
+                info.queued_queries = self.queued_queries.depth();
+                message.respond(Ok(DhtResponse::GetNetworkInfo(info)));
             }
             DhtRequest::GetPeers => {
                 let peers = self
@@ -197,80 +294,163 @@ where
                     .collect();
                 message.respond(Ok(DhtResponse::GetPeers(peers)));
             }
-            DhtRequest::StartProviding { ref key } => {
-                store_request!(
-                    self,
+            DhtRequest::PutRecord {
+                ref key,
+                ref value,
+                quorum,
+            } => {
+                let key = key.to_owned();
+                let value = value.to_owned();
+                self.validate(PendingValidation::PutRecord {
                     message,
-                    self.swarm
-                        .behaviour_mut()
-                        .kad
-                        .start_providing(RecordKey::new(key))
-                );
+                    key,
+                    value,
+                    quorum,
+                });
             }
-            DhtRequest::GetRecord { ref key } => {
-                store_request!(
-                    self,
-                    message,
-                    Ok::<kad::QueryId, DhtError>(
-                        self.swarm
-                            .behaviour_mut()
-                            .kad
-                            .get_record(RecordKey::new(key))
-                    )
+        };
+    }
+
+    /// Hands `pending` to the [ValidationPool], settling it straight away if
+    /// the pool is too busy to take it.
+    fn validate(&mut self, pending: PendingValidation) {
+        let pending = match self.validation.validate(pending) {
+            Ok(()) => return,
+            Err(pending) => pending,
+        };
+
+        match pending {
+            PendingValidation::PutRecord { message, .. } => {
+                message.respond(Err(DhtError::Error(String::from(
+                    "Too many records are waiting to be validated.",
+                ))));
+            }
+            PendingValidation::GetRecord { messages, .. } => {
+                for message in messages {
+                    message.respond(Err(DhtError::Error(String::from(
+                        "Too many records are waiting to be validated.",
+                    ))));
+                }
+            }
+            PendingValidation::StreamedRecord { query_id, .. } => {
+                warn!("Dropped a streamed record; too many records are waiting to be validated");
+                if let Some(stream) = self.record_streams.get_mut(&query_id) {
+                    stream.pending_validations -= 1;
+                }
+                self.close_record_stream_if_done(query_id);
+            }
+            PendingValidation::InboundPutRecord { record, source } => {
+                warn!(
+                    "InboundRequest::PutRecord dropped; too many records are waiting to be validated: {:?} {:?}",
+                    record.key, source
                 );
             }
-            DhtRequest::PutRecord {
-                ref key,
-                ref value,
+        }
+    }
+
+    /// Resumes work that was waiting on a record to be validated by the
+    /// [ValidationPool].
+    #[instrument(skip(self, pending), level = "trace")]
+    fn complete_validation(&mut self, pending: PendingValidation, is_valid: bool) {
+        match pending {
+            PendingValidation::PutRecord {
+                message,
+                key,
+                value,
                 quorum,
             } => {
-                let value_owned = value.to_owned();
-                if self.validate(value).await {
-                    let record = Record {
-                        key: RecordKey::new(key),
-                        value: value_owned,
-                        publisher: None,
-                        expires: None,
+                if !is_valid {
+                    message.respond(Err(DhtError::ValidationError(value)));
+                    return;
+                }
+                let record = Record {
+                    key: RecordKey::new(&key),
+                    value,
+                    publisher: None,
+                    expires: None,
+                };
+                // Support a quorum of 0 when this is the only node in the
+                // network, in which case store it locally.
+                // Hopefully a temporary configuration in early bootstrapping.
+                if quorum == 0 {
+                    let result = if self
+                        .swarm
+                        .behaviour_mut()
+                        .kad
+                        .store_mut()
+                        .put(record)
+                        .is_err()
+                    {
+                        Err(DhtError::Error(String::from("Could not store record.")))
+                    } else {
+                        Ok(DhtResponse::PutRecord { key })
                     };
-                    // Support a quorum of 0 when this is the only node in the
-                    // network, in which case store it locally.
-                    // Hopefully a temporary configuration in early bootstrapping.
-                    if quorum == 0 {
-                        let result = if self
-                            .swarm
-                            .behaviour_mut()
-                            .kad
-                            .store_mut()
-                            .put(record)
-                            .is_err()
-                        {
-                            Err(DhtError::Error(String::from("Could not store record.")))
-                        } else {
-                            Ok(DhtResponse::PutRecord {
-                                key: key.to_owned(),
-                            })
-                        };
-                        message.respond(result);
+                    message.respond(result);
+                } else {
+                    let p2p_quorum = if quorum == 1 {
+                        Quorum::One
                     } else {
-                        let p2p_quorum = if quorum == 1 {
-                            Quorum::One
-                        } else {
-                            Quorum::N(NonZeroUsize::new(quorum).unwrap())
-                        };
-                        store_request!(
-                            self,
-                            message,
-                            self.swarm
-                                .behaviour_mut()
-                                .kad
-                                .put_record(record, p2p_quorum)
+                        Quorum::N(NonZeroUsize::new(quorum).unwrap())
+                    };
+                    self.admit_query(QueuedQuery::PutRecord {
+                        message,
+                        record,
+                        quorum: p2p_quorum,
+                    });
+                }
+            }
+            PendingValidation::GetRecord {
+                messages,
+                key,
+                value,
+            } => {
+                // We don't want to propagate validation errors for all
+                // possible invalid records, but handle it similarly as if
+                // no record at all was found.
+                let record = DhtRecord {
+                    key,
+                    value: if is_valid { Some(value) } else { None },
+                };
+                for message in messages {
+                    message.respond(Ok(DhtResponse::GetRecord(record.clone())));
+                }
+            }
+            PendingValidation::StreamedRecord { query_id, value } => {
+                let stream = match self.record_streams.get_mut(&query_id) {
+                    Some(stream) => stream,
+                    None => return,
+                };
+                stream.pending_validations -= 1;
+                if is_valid && !stream.send(value) {
+                    // Every client has stopped listening; no need to keep
+                    // querying the network
+                    self.finish_record_stream(query_id);
+                    return;
+                }
+                self.close_record_stream_if_done(query_id);
+            }
+            PendingValidation::InboundPutRecord { record, source } => {
+                if is_valid {
+                    if let Err(e) = self
+                        .swarm
+                        .behaviour_mut()
+                        .kad
+                        .store_mut()
+                        .put(record.clone())
+                    {
+                        warn!(
+                            "InboundRequest::PutRecord write failed: {:?} {:?}, {}",
+                            record, source, e
                         );
                     }
                 } else {
-                    message.respond(Err(DhtError::ValidationError(value_owned)));
+                    warn!(
+                        "InboundRequest::PutRecord validation failed: {:?} {:?}",
+                        record, source
+                    );
                 }
             }
-        };
+        }
     }
 
     /// Processes an incoming SwarmEvent, triggered from swarm activity or
@@ -352,44 +532,74 @@ where
                     record: Record { key, value, .. },
                     ..
                 }))) => {
-                    if let Some(message) = self.requests.remove(&id) {
-                        let is_valid = self.validate(&value).await;
-                        // We don't want to propagate validation errors for all
-                        // possible invalid records, but handle it similarly as if
-                        // no record at all was found.
-                        message.respond(Ok(DhtResponse::GetRecord(DhtRecord {
+                    if let Some(messages) = self.take_get_record_requests(&id) {
+                        // The first record found answers every request; stop
+                        // querying the network for more
+                        if let Some(mut query) = self.swarm.behaviour_mut().kad.query_mut(&id) {
+                            query.finish();
+                        }
+                        self.validate(PendingValidation::GetRecord {
+                            messages,
                             key: key.to_vec(),
-                            value: if is_valid { Some(value) } else { None },
-                        })));
-                    };
+                            value,
+                        });
+                    } else if let Some(stream) = self.record_streams.get_mut(&id) {
+                        if stream.is_abandoned() {
+                            self.finish_record_stream(id);
+                        } else {
+                            stream.pending_validations += 1;
+                            self.validate(PendingValidation::StreamedRecord {
+                                query_id: id,
+                                value,
+                            });
+                        }
+                    }
                 }
                 QueryResult::GetRecord(Ok(kad::GetRecordOk::FinishedWithNoAdditionalRecord {
                     ..
                 })) => {
-                    if let Some(message) = self.requests.remove(&id) {
-                        let key = {
-                            if let DhtRequest::GetRecord { ref key, .. } = message.request {
-                                key.to_owned()
-                            } else {
-                                panic!("Request must be GetRecord");
-                            }
-                        };
-                        message.respond(Ok(DhtResponse::GetRecord(DhtRecord { key, value: None })));
+                    if let Some(stream) = self.record_streams.get_mut(&id) {
+                        stream.finished = true;
+                        self.close_record_stream_if_done(id);
+                    }
+                    if let Some(messages) = self.take_get_record_requests(&id) {
+                        for message in messages {
+                            let key = {
+                                if let DhtRequest::GetRecord { ref key, .. } = message.request {
+                                    key.to_owned()
+                                } else {
+                                    panic!("Request must be GetRecord");
+                                }
+                            };
+                            message.respond(Ok(DhtResponse::GetRecord(DhtRecord {
+                                key,
+                                value: None,
+                            })));
+                        }
                     }
                 }
                 QueryResult::GetRecord(Err(e)) => {
-                    if let Some(message) = self.requests.remove(&id) {
-                        match e {
-                            kad::GetRecordError::NotFound { key, .. } => {
-                                // Not finding a record is not an `Err` response,
-                                // but simply a successful query with a `None` result.
-                                message.respond(Ok(DhtResponse::GetRecord(DhtRecord {
-                                    key: key.to_vec(),
-                                    value: None,
-                                })))
-                            }
-                            e => message.respond(Err(DhtError::from(e))),
-                        };
+                    if let Some(stream) = self.record_streams.get_mut(&id) {
+                        // Whatever records were found have already been
+                        // streamed; the client sees the end of the stream
+                        debug!("GetRecords query ended: {}", e);
+                        stream.finished = true;
+                        self.close_record_stream_if_done(id);
+                    }
+                    if let Some(messages) = self.take_get_record_requests(&id) {
+                        for message in messages {
+                            match e {
+                                kad::GetRecordError::NotFound { ref key, .. } => {
+                                    // Not finding a record is not an `Err` response,
+                                    // but simply a successful query with a `None` result.
+                                    message.respond(Ok(DhtResponse::GetRecord(DhtRecord {
+                                        key: key.to_vec(),
+                                        value: None,
+                                    })))
+                                }
+                                ref e => message.respond(Err(DhtError::from(e.clone()))),
+                            };
+                        }
                     }
                 }
                 QueryResult::PutRecord(Ok(kad::PutRecordOk { key })) => {
@@ -460,22 +670,8 @@ where
                     present_locally: _,
                 } => {}
                 kad::InboundRequest::PutRecord { source, record, .. } => match record {
-                    Some(rec) => {
-                        if self.validate(&rec.value).await {
-                            if let Err(e) =
-                                self.swarm.behaviour_mut().kad.store_mut().put(rec.clone())
-                            {
-                                warn!(
-                                    "InboundRequest::PutRecord write failed: {:?} {:?}, {}",
-                                    rec, source, e
-                                );
-                            }
-                        } else {
-                            warn!(
-                                "InboundRequest::PutRecord validation failed: {:?} {:?}",
-                                rec, source
-                            );
-                        }
+                    Some(record) => {
+                        self.validate(PendingValidation::InboundPutRecord { record, source })
                     }
                     None => warn!("InboundRequest::PutRecord failed; empty record"),
                 },
@@ -598,6 +794,208 @@ where
         Ok(())
     }
 
+    /// How many Kademlia queries started on behalf of clients are running.
+    fn inflight_queries(&self) -> usize {
+        self.requests.len() + self.record_streams.len()
+    }
+
+    /// Starts `query` if there is a free query slot, and queues it
+    /// otherwise (failing it if the queue is full). A `GetRecord` or
+    /// `GetRecords` request for a key that is already being queried joins
+    /// that query instead.
+    fn admit_query(&mut self, query: QueuedQuery) {
+        let query = match query {
+            QueuedQuery::Message(message) => match self.join_inflight_query(message) {
+                Some(message) => QueuedQuery::Message(message),
+                None => return,
+            },
+            query => query,
+        };
+
+        if self.inflight_queries() < self.config.max_inflight_queries.max(1) {
+            self.start_query(query);
+        } else if let Err(query) = self.queued_queries.push(query) {
+            query
+                .into_message()
+                .respond(Err(DhtError::Error(String::from(
+                    "Too many queries are waiting to be started.",
+                ))));
+        }
+    }
+
+    /// Starts queued queries for as long as there are free query slots.
+    fn start_queued_queries(&mut self) {
+        while self.inflight_queries() < self.config.max_inflight_queries.max(1) {
+            match self.queued_queries.pop() {
+                Some(query) => self.start_query(query),
+                None => break,
+            }
+        }
+    }
+
+    fn start_query(&mut self, query: QueuedQuery) {
+        let message = match query {
+            QueuedQuery::PutRecord {
+                message,
+                record,
+                quorum,
+            } => {
+                store_request!(
+                    self,
+                    message,
+                    self.swarm.behaviour_mut().kad.put_record(record, quorum)
+                );
+                return;
+            }
+            // A request for the same key may have started while this one
+            // was queued
+            QueuedQuery::Message(message) => match self.join_inflight_query(message) {
+                Some(message) => message,
+                None => return,
+            },
+        };
+
+        match message.request {
+            DhtRequest::GetProviders { ref key } => {
+                let query_id = self
+                    .swarm
+                    .behaviour_mut()
+                    .kad
+                    .get_providers(RecordKey::new(key));
+                self.requests.insert(query_id, message);
+            }
+            DhtRequest::StartProviding { ref key } => {
+                store_request!(
+                    self,
+                    message,
+                    self.swarm
+                        .behaviour_mut()
+                        .kad
+                        .start_providing(RecordKey::new(key))
+                );
+            }
+            DhtRequest::GetRecord { ref key } => {
+                let query_id = self
+                    .swarm
+                    .behaviour_mut()
+                    .kad
+                    .get_record(RecordKey::new(key));
+                self.get_record_queries.insert(key.to_owned(), query_id);
+                self.requests.insert(query_id, message);
+            }
+            DhtRequest::GetRecords { ref key } => {
+                let query_id = self
+                    .swarm
+                    .behaviour_mut()
+                    .kad
+                    .get_record(RecordKey::new(key));
+                let mut stream = RecordStream::new(key.to_owned());
+                let receiver = stream.join();
+                self.record_stream_queries.insert(key.to_owned(), query_id);
+                self.record_streams.insert(query_id, stream);
+                message.respond(Ok(DhtResponse::GetRecords(receiver)));
+            }
+            _ => {
+                message.respond(Err(DhtError::Error(String::from(
+                    "Request does not start a query.",
+                ))));
+            }
+        }
+    }
+
+    /// Adds a `GetRecord` or `GetRecords` request to the in-flight query of
+    /// the same kind for the same key, if there is one. Returns the message
+    /// if it still needs a query of its own.
+    fn join_inflight_query(&mut self, message: DhtMessage) -> Option<DhtMessage> {
+        match message.request {
+            DhtRequest::GetRecord { ref key } => match self.get_record_queries.get(key).copied() {
+                Some(query_id) => {
+                    self.coalesced_requests
+                        .entry(query_id)
+                        .or_default()
+                        .push(message);
+                    None
+                }
+                None => Some(message),
+            },
+            DhtRequest::GetRecords { ref key } => {
+                let stream = self
+                    .record_stream_queries
+                    .get(key)
+                    .and_then(|query_id| self.record_streams.get_mut(query_id));
+                match stream {
+                    Some(stream) => {
+                        message.respond(Ok(DhtResponse::GetRecords(stream.join())));
+                        None
+                    }
+                    None => Some(message),
+                }
+            }
+            _ => Some(message),
+        }
+    }
+
+    /// Takes every request that is waiting on the `GetRecord` query `id`.
+    fn take_get_record_requests(&mut self, id: &kad::QueryId) -> Option<Vec<DhtMessage>> {
+        let message = self.requests.remove(id)?;
+        if let DhtRequest::GetRecord { ref key } = message.request {
+            self.get_record_queries.remove(key);
+        }
+        let mut messages = vec![message];
+        messages.extend(self.coalesced_requests.remove(id).unwrap_or_default());
+        Some(messages)
+    }
+
+    /// Stops the query behind a record stream, closing the stream.
+    fn finish_record_stream(&mut self, query_id: kad::QueryId) {
+        if let Some(mut query) = self.swarm.behaviour_mut().kad.query_mut(&query_id) {
+            query.finish();
+        }
+        self.remove_record_stream(query_id);
+    }
+
+    /// Closes a record stream for every client that is reading it.
+    fn remove_record_stream(&mut self, query_id: kad::QueryId) {
+        if let Some(stream) = self.record_streams.remove(&query_id) {
+            self.record_stream_queries.remove(&stream.key);
+        }
+    }
+
+    /// Stops the queries behind record streams whose client has stopped
+    /// listening, so that they give up their query slots right away rather
+    /// than when the next record is found or the query ends.
+    fn finish_abandoned_record_streams(&mut self) {
+        let abandoned: Vec<kad::QueryId> = self
+            .record_streams
+            .iter()
+            .filter(|(_, stream)| stream.is_abandoned())
+            .map(|(query_id, _)| *query_id)
+            .collect();
+
+        for query_id in abandoned {
+            self.finish_record_stream(query_id);
+        }
+    }
+
+    /// Closes a record stream once its query has completed and every record
+    /// that it found has been validated.
+    fn close_record_stream_if_done(&mut self, query_id: kad::QueryId) {
+        let done = match self.record_streams.get(&query_id) {
+            Some(stream) => stream.finished && stream.pending_validations == 0,
+            None => false,
+        };
+        if done {
+            self.remove_record_stream(query_id);
+        }
+    }
+
+    fn sweep_records(&mut self) {
+        let removed = self.swarm.behaviour_mut().kad.store_mut().sweep();
+        if removed > 0 {
+            debug!("Removed {} expired records", removed);
+        }
+    }
+
     fn execute_bootstrap(&mut self) -> Result<(), DhtError> {
         match self.swarm.behaviour_mut().kad.bootstrap() {
             Ok(_) => Ok(()),
@@ -607,15 +1005,6 @@ where
             }
         }
     }
-
-    #[instrument(skip(self), level = "trace")]
-    async fn validate(&mut self, data: &[u8]) -> bool {
-        if let Some(v) = self.validator.as_mut() {
-            v.validate(data).await
-        } else {
-            true
-        }
-    }
 }
 
 impl<V> fmt::Debug for DhtProcessor<V>
@@ -629,3 +1018,94 @@ where
             .finish()
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::DhtProcessor;
+    use crate::dht::{
+        rpc::{DhtRequest, DhtResponse},
+        validation::PendingValidation,
+        AllowAllValidator, DhtConfig, DhtError,
+    };
+    use libp2p::{identity::Keypair, PeerId};
+    use noosphere_common::channel::message_channel;
+
+    #[tokio::test]
+    async fn it_coalesces_concurrent_record_streams_for_a_key() -> Result<(), DhtError> {
+        let keypair = Keypair::generate_ed25519();
+        let (client, channel) = message_channel::<DhtRequest, DhtResponse, DhtError>();
+        let mut processor = DhtProcessor::new(
+            &keypair,
+            PeerId::from(keypair.public()),
+            Some(AllowAllValidator {}),
+            None,
+            DhtConfig::default(),
+            channel,
+        )?;
+
+        let get_records = || {
+            let client = client.clone();
+            tokio::spawn(async move {
+                match client
+                    .send(DhtRequest::GetRecords {
+                        key: b"foo".to_vec(),
+                    })
+                    .await
+                {
+                    Ok(Ok(DhtResponse::GetRecords(records))) => records,
+                    _ => panic!("Expected a record stream"),
+                }
+            })
+        };
+
+        // Two resolves of the same key arrive before either query completes
+        let first = get_records();
+        let second = get_records();
+        for _ in 0..2 {
+            let message = processor.processor.pull_message().await.unwrap();
+            processor.process_message(message).await;
+        }
+        let (mut first, mut second) = (first.await.unwrap(), second.await.unwrap());
+
+        assert_eq!(processor.inflight_queries(), 1);
+        let query_id = *processor.record_streams.keys().next().unwrap();
+
+        // A record is found and validated...
+        processor
+            .record_streams
+            .get_mut(&query_id)
+            .unwrap()
+            .pending_validations += 1;
+        processor.complete_validation(
+            PendingValidation::StreamedRecord {
+                query_id,
+                value: b"bar".to_vec(),
+            },
+            true,
+        );
+
+        // ...and a resolve that joins late still sees it
+        let third = get_records();
+        let message = processor.processor.pull_message().await.unwrap();
+        processor.process_message(message).await;
+        let mut third = third.await.unwrap();
+        assert_eq!(processor.inflight_queries(), 1);
+
+        // The query completing ends every stream
+        processor
+            .record_streams
+            .get_mut(&query_id)
+            .unwrap()
+            .finished = true;
+        processor.close_record_stream_if_done(query_id);
+        assert_eq!(processor.inflight_queries(), 0);
+        assert!(processor.record_stream_queries.is_empty());
+
+        for records in [&mut first, &mut second, &mut third] {
+            assert_eq!(records.recv().await, Some(b"bar".to_vec()));
+            assert_eq!(records.recv().await, None);
+        }
+
+        Ok(())
+    }
+}
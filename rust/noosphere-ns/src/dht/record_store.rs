@@ -0,0 +1,520 @@
+use super::DhtConfig;
+use anyhow::{anyhow, Result};
+use libipld_cbor::DagCborCodec;
+use libipld_core::ipld::Ipld;
+use libp2p::{
+    kad::{
+        store::{self, MemoryStore, MemoryStoreConfig, RecordStore},
+        ProviderRecord, Record, RecordKey,
+    },
+    PeerId,
+};
+use noosphere_storage::{block_decode, block_encode, Store};
+use std::{
+    borrow::Cow,
+    collections::BTreeSet,
+    time::{Duration, Instant, SystemTime, UNIX_EPOCH},
+};
+use tokio::sync::mpsc::{unbounded_channel, UnboundedSender};
+
+/// Persisted records are stored under this prefix, followed by their key.
+const RECORD_KEY_PREFIX: &[u8] = b"dht/record/";
+/// The keys of all persisted records are stored under this key, so that they
+/// can be found again on startup.
+const RECORD_INDEX_KEY: &[u8] = b"dht/index";
+/// The keys of records that were first persisted after the index was last
+/// written are stored under this prefix, followed by a sequence number that
+/// counts up from zero, until they are folded into the index.
+const RECORD_JOURNAL_PREFIX: &[u8] = b"dht/journal/";
+
+enum PersistenceOperation {
+    Put { key: Vec<u8>, bytes: Vec<u8> },
+    Remove { key: Vec<u8> },
+    WriteIndex { bytes: Vec<u8> },
+}
+
+fn storage_key(key: &RecordKey) -> Vec<u8> {
+    [RECORD_KEY_PREFIX, key.as_ref()].concat()
+}
+
+fn journal_key(sequence: u64) -> Vec<u8> {
+    [RECORD_JOURNAL_PREFIX, &sequence.to_be_bytes()].concat()
+}
+
+fn encode_index<'a>(keys: impl Iterator<Item = &'a RecordKey>) -> Result<Vec<u8>> {
+    let keys = Ipld::List(keys.map(|key| Ipld::Bytes(key.to_vec())).collect());
+    Ok(block_encode::<DagCborCodec, _>(&keys)?.1)
+}
+
+fn unix_seconds(expires: Instant) -> u64 {
+    let remaining = expires.saturating_duration_since(Instant::now());
+    (SystemTime::now() + remaining)
+        .duration_since(UNIX_EPOCH)
+        .map(|since_epoch| since_epoch.as_secs())
+        .unwrap_or_default()
+}
+
+/// The [Instant] at which a record that expires at `unix_seconds` expires,
+/// or `None` if it has already expired.
+fn instant_from_unix_seconds(unix_seconds: u64) -> Option<Instant> {
+    let expires = UNIX_EPOCH + Duration::from_secs(unix_seconds);
+    expires
+        .duration_since(SystemTime::now())
+        .ok()
+        .map(|remaining| Instant::now() + remaining)
+}
+
+fn encode_record(record: &Record) -> Result<Vec<u8>> {
+    let ipld = Ipld::List(vec![
+        Ipld::Bytes(record.key.to_vec()),
+        Ipld::Bytes(record.value.clone()),
+        record
+            .publisher
+            .map(|publisher| Ipld::Bytes(publisher.to_bytes()))
+            .unwrap_or(Ipld::Null),
+        record
+            .expires
+            .map(|expires| Ipld::Integer(unix_seconds(expires).into()))
+            .unwrap_or(Ipld::Null),
+    ]);
+    Ok(block_encode::<DagCborCodec, _>(&ipld)?.1)
+}
+
+/// Decodes a persisted record, returning `None` if it has expired.
+fn decode_record(bytes: &[u8]) -> Result<Option<Record>> {
+    let fields = match block_decode::<DagCborCodec, Ipld>(bytes)? {
+        Ipld::List(fields) if fields.len() == 4 => fields,
+        _ => return Err(anyhow!("Persisted DHT record is malformed")),
+    };
+
+    let (key, value) = match (&fields[0], &fields[1]) {
+        (Ipld::Bytes(key), Ipld::Bytes(value)) => (key.to_owned(), value.to_owned()),
+        _ => return Err(anyhow!("Persisted DHT record is malformed")),
+    };
+    let publisher = match &fields[2] {
+        Ipld::Bytes(publisher) => Some(PeerId::from_bytes(publisher)?),
+        _ => None,
+    };
+    let expires = match &fields[3] {
+        Ipld::Integer(unix_seconds) => match instant_from_unix_seconds(*unix_seconds as u64) {
+            Some(expires) => Some(expires),
+            None => return Ok(None),
+        },
+        _ => None,
+    };
+
+    Ok(Some(Record {
+        key: RecordKey::from(key),
+        value,
+        publisher,
+        expires,
+    }))
+}
+
+/// Records that were persisted by a previous run of a DHT node, along with a
+/// handle for persisting the records of the current run. Open one with
+/// [RecordPersistence::open] and hand it to
+/// [crate::dht::DhtNode::with_record_persistence] (or
+/// [crate::NameSystemBuilder::record_persistence]) so that a restarted node
+/// starts out with the records it held before, rather than re-learning them
+/// over several replication cycles.
+///
+/// Writes are applied to the underlying [Store] in order by a background
+/// task, so that they never block the DHT's event loop.
+pub struct RecordPersistence {
+    records: Vec<Record>,
+    sender: UnboundedSender<PersistenceOperation>,
+}
+
+impl RecordPersistence {
+    /// Load the unexpired records that were persisted to `store`, and start
+    /// persisting changes to it.
+    pub async fn open<S: Store + 'static>(mut store: S) -> Result<Self> {
+        let mut records = Vec::new();
+        let mut expired = Vec::new();
+        let mut keys = BTreeSet::new();
+
+        if let Some(index) = store.read(RECORD_INDEX_KEY).await? {
+            match block_decode::<DagCborCodec, Ipld>(&index)? {
+                Ipld::List(index) => keys.extend(index.into_iter().filter_map(|key| match key {
+                    Ipld::Bytes(key) => Some(key),
+                    _ => None,
+                })),
+                _ => return Err(anyhow!("Persisted DHT record index is malformed")),
+            };
+        }
+
+        // Records that were stored after the index was last written (for
+        // example, if the previous run did not stop cleanly) are only found
+        // through the journal
+        let mut journal_length = 0;
+        while let Some(key) = store.read(&journal_key(journal_length)).await? {
+            keys.insert(key);
+            journal_length += 1;
+        }
+
+        for key in keys {
+            let storage_key = storage_key(&RecordKey::from(key));
+
+            match store.read(&storage_key).await? {
+                Some(bytes) => match decode_record(&bytes) {
+                    Ok(Some(record)) => records.push(record),
+                    Ok(None) => expired.push(storage_key),
+                    Err(error) => {
+                        warn!("Discarding persisted DHT record: {}", error);
+                        expired.push(storage_key);
+                    }
+                },
+                None => continue,
+            }
+        }
+
+        for key in expired {
+            store.remove(&key).await?;
+        }
+
+        if journal_length > 0 {
+            store
+                .write(
+                    RECORD_INDEX_KEY,
+                    &encode_index(records.iter().map(|record| &record.key))?,
+                )
+                .await?;
+            store.flush().await?;
+
+            // Newest first, so that the journal is never left with a gap
+            for sequence in (0..journal_length).rev() {
+                store.remove(&journal_key(sequence)).await?;
+            }
+        }
+
+        debug!("Loaded {} persisted DHT records", records.len());
+
+        let (sender, mut receiver) = unbounded_channel();
+
+        tokio::spawn(async move {
+            while let Some(operation) = receiver.recv().await {
+                let result = match operation {
+                    PersistenceOperation::Put { key, bytes } => {
+                        store.write(&key, &bytes).await.map(|_| ())
+                    }
+                    PersistenceOperation::Remove { key } => store.remove(&key).await.map(|_| ()),
+                    PersistenceOperation::WriteIndex { bytes } => {
+                        match store.write(RECORD_INDEX_KEY, &bytes).await {
+                            Ok(_) => store.flush().await,
+                            Err(error) => Err(error),
+                        }
+                    }
+                };
+
+                if let Err(error) = result {
+                    warn!("Could not persist DHT records: {}", error);
+                }
+            }
+        });
+
+        Ok(RecordPersistence { records, sender })
+    }
+}
+
+/// The [RecordStore] of a [crate::dht::DhtNode]. Records and provider records
+/// are held in a bounded [MemoryStore] (at most
+/// [DhtConfig::record_store_max_records] records), and records are
+/// optionally written through to disk via [RecordPersistence].
+///
+/// The index of persisted record keys is only rewritten when the set of keys
+/// has changed, by [DhtRecordStore::sweep]; in the meantime, the key of each
+/// newly stored record is appended to a journal before the record itself is
+/// written, so that no persisted record is lost if the node stops before the
+/// next sweep.
+pub struct DhtRecordStore {
+    records: MemoryStore,
+    persistence: Option<UnboundedSender<PersistenceOperation>>,
+    index_is_stale: bool,
+    journal_length: u64,
+}
+
+impl DhtRecordStore {
+    pub fn new(
+        local_id: PeerId,
+        config: &DhtConfig,
+        persistence: Option<RecordPersistence>,
+    ) -> Self {
+        let mut records = MemoryStore::with_config(
+            local_id,
+            MemoryStoreConfig {
+                max_records: config.record_store_max_records,
+                ..Default::default()
+            },
+        );
+
+        let persistence = persistence.map(|persistence| {
+            for record in persistence.records {
+                if let Err(error) = records.put(record) {
+                    warn!("Could not restore persisted DHT record: {:?}", error);
+                }
+            }
+            persistence.sender
+        });
+
+        DhtRecordStore {
+            records,
+            persistence,
+            index_is_stale: false,
+            journal_length: 0,
+        }
+    }
+
+    /// Removes all expired records, and brings the persisted index of record
+    /// keys up to date. Returns the number of records that were removed.
+    pub fn sweep(&mut self) -> usize {
+        let now = Instant::now();
+        let expired: Vec<RecordKey> = self
+            .records
+            .records()
+            .filter(|record| record.is_expired(now))
+            .map(|record| record.key.clone())
+            .collect();
+
+        for key in expired.iter() {
+            self.remove(key);
+        }
+
+        self.write_index();
+
+        expired.len()
+    }
+
+    fn persist(&self, operation: PersistenceOperation) {
+        if let Some(sender) = self.persistence.as_ref() {
+            let _ = sender.send(operation);
+        }
+    }
+
+    fn write_index(&mut self) {
+        if !self.index_is_stale {
+            return;
+        }
+
+        match encode_index(self.records.records().map(|record| &record.key)) {
+            Ok(bytes) => {
+                self.persist(PersistenceOperation::WriteIndex { bytes });
+                self.index_is_stale = false;
+
+                // Newest first, so that the journal is never left with a gap
+                for sequence in (0..self.journal_length).rev() {
+                    self.persist(PersistenceOperation::Remove {
+                        key: journal_key(sequence),
+                    });
+                }
+                self.journal_length = 0;
+            }
+            Err(error) => warn!("Could not encode DHT record index: {}", error),
+        }
+    }
+}
+
+impl Drop for DhtRecordStore {
+    fn drop(&mut self) {
+        self.write_index();
+    }
+}
+
+impl RecordStore for DhtRecordStore {
+    type RecordsIter<'a> = <MemoryStore as RecordStore>::RecordsIter<'a>;
+    type ProvidedIter<'a> = <MemoryStore as RecordStore>::ProvidedIter<'a>;
+
+    fn get(&self, key: &RecordKey) -> Option<Cow<'_, Record>> {
+        self.records.get(key)
+    }
+
+    fn put(&mut self, record: Record) -> store::Result<()> {
+        if self.persistence.is_none() {
+            return self.records.put(record);
+        }
+
+        let is_new = match self.records.get(&record.key) {
+            // Records are re-stored as they are replicated; there is nothing
+            // to write if nothing has changed.
+            Some(existing) if existing.as_ref() == &record => return Ok(()),
+            Some(_) => false,
+            None => true,
+        };
+
+        let bytes = encode_record(&record);
+        let key = storage_key(&record.key);
+        let journal_entry = is_new.then(|| record.key.to_vec());
+
+        self.records.put(record)?;
+
+        if let Some(record_key) = journal_entry {
+            self.persist(PersistenceOperation::Put {
+                key: journal_key(self.journal_length),
+                bytes: record_key,
+            });
+            self.journal_length += 1;
+        }
+
+        match bytes {
+            Ok(bytes) => self.persist(PersistenceOperation::Put { key, bytes }),
+            Err(error) => warn!("Could not encode DHT record: {}", error),
+        };
+
+        self.index_is_stale |= is_new;
+
+        Ok(())
+    }
+
+    fn remove(&mut self, key: &RecordKey) {
+        if self.records.get(key).is_some() {
+            self.records.remove(key);
+            self.persist(PersistenceOperation::Remove {
+                key: storage_key(key),
+            });
+            self.index_is_stale = true;
+        }
+    }
+
+    fn records(&self) -> Self::RecordsIter<'_> {
+        self.records.records()
+    }
+
+    fn add_provider(&mut self, record: ProviderRecord) -> store::Result<()> {
+        self.records.add_provider(record)
+    }
+
+    fn providers(&self, key: &RecordKey) -> Vec<ProviderRecord> {
+        self.records.providers(key)
+    }
+
+    fn provided(&self) -> Self::ProvidedIter<'_> {
+        self.records.provided()
+    }
+
+    fn remove_provider(&mut self, key: &RecordKey, provider: &PeerId) {
+        self.records.remove_provider(key, provider)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{journal_key, storage_key, DhtRecordStore, RecordPersistence};
+    use crate::dht::DhtConfig;
+    use anyhow::Result;
+    use libp2p::{
+        kad::{store::RecordStore, Record, RecordKey},
+        PeerId,
+    };
+    use noosphere_storage::{MemoryStore, Store};
+    use std::time::{Duration, Instant};
+
+    async fn reopen(store: &MemoryStore, expected: usize) -> Result<DhtRecordStore> {
+        // Writes are applied in the background, so wait for them to land
+        for _ in 0..100 {
+            let persistence = RecordPersistence::open(store.clone()).await?;
+            if persistence.records.len() == expected {
+                return Ok(DhtRecordStore::new(
+                    PeerId::random(),
+                    &DhtConfig::default(),
+                    Some(persistence),
+                ));
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+        Err(anyhow::anyhow!("Persisted records never appeared"))
+    }
+
+    #[tokio::test]
+    async fn it_restores_persisted_records_after_a_restart() -> Result<()> {
+        let storage = MemoryStore::default();
+        let peer_id = PeerId::random();
+
+        {
+            let persistence = RecordPersistence::open(storage.clone()).await?;
+            let mut records =
+                DhtRecordStore::new(peer_id, &DhtConfig::default(), Some(persistence));
+
+            let mut expiring = Record::new(RecordKey::new(&"expiring"), b"1".to_vec());
+            expiring.expires = Some(Instant::now() + Duration::from_secs(3600));
+            expiring.publisher = Some(peer_id);
+            records.put(expiring)?;
+            records.put(Record::new(RecordKey::new(&"forever"), b"2".to_vec()))?;
+            records.put(Record::new(RecordKey::new(&"removed"), b"3".to_vec()))?;
+            records.remove(&RecordKey::new(&"removed"));
+            records.sweep();
+        }
+
+        let records = reopen(&storage, 2).await?;
+
+        let expiring = records.get(&RecordKey::new(&"expiring")).unwrap();
+        assert_eq!(expiring.value, b"1".to_vec());
+        assert_eq!(expiring.publisher, Some(peer_id));
+        assert!(expiring.expires.unwrap() > Instant::now() + Duration::from_secs(3500));
+        assert_eq!(
+            records.get(&RecordKey::new(&"forever")).unwrap().value,
+            b"2".to_vec()
+        );
+        assert!(records.get(&RecordKey::new(&"removed")).is_none());
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_restores_records_stored_after_the_index_was_written() -> Result<()> {
+        let storage = MemoryStore::default();
+
+        {
+            let persistence = RecordPersistence::open(storage.clone()).await?;
+            let mut records =
+                DhtRecordStore::new(PeerId::random(), &DhtConfig::default(), Some(persistence));
+
+            records.put(Record::new(RecordKey::new(&"indexed"), b"1".to_vec()))?;
+            records.sweep();
+            records.put(Record::new(RecordKey::new(&"journaled"), b"2".to_vec()))?;
+
+            // Stop without writing the index again, as if the node crashed
+            std::mem::forget(records);
+        }
+
+        // Writes are applied in the background, and the journal entry is
+        // written before the record, so wait for the record to land
+        let journaled = storage_key(&RecordKey::new(&"journaled"));
+        for _ in 0..100 {
+            if storage.read(&journaled).await?.is_some() {
+                break;
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+
+        let persistence = RecordPersistence::open(storage.clone()).await?;
+        assert_eq!(persistence.records.len(), 2);
+
+        // Opening folds the journal into the index
+        assert!(storage.read(&journal_key(0)).await?.is_none());
+        let persistence = RecordPersistence::open(storage.clone()).await?;
+        assert_eq!(persistence.records.len(), 2);
+
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_sweeps_expired_records() -> Result<()> {
+        let storage = MemoryStore::default();
+        let persistence = RecordPersistence::open(storage.clone()).await?;
+        let mut records =
+            DhtRecordStore::new(PeerId::random(), &DhtConfig::default(), Some(persistence));
+
+        let mut expired = Record::new(RecordKey::new(&"expired"), b"1".to_vec());
+        expired.expires = Some(Instant::now());
+        records.put(expired)?;
+        records.put(Record::new(RecordKey::new(&"live"), b"2".to_vec()))?;
+
+        assert_eq!(records.sweep(), 1);
+        assert!(records.get(&RecordKey::new(&"expired")).is_none());
+
+        let records = reopen(&storage, 1).await?;
+        assert!(records.get(&RecordKey::new(&"live")).is_some());
+
+        Ok(())
+    }
+}
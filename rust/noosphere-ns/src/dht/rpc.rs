@@ -2,6 +2,7 @@ use crate::dht::errors::DhtError;
 use crate::dht::types::{DhtRecord, NetworkInfo, Peer};
 use libp2p::Multiaddr;
 use noosphere_common::channel::{Message, MessageClient, MessageProcessor};
+use tokio::sync::mpsc::UnboundedReceiver;
 
 use std::{fmt, str};
 
@@ -24,6 +25,9 @@ pub enum DhtRequest {
     GetRecord {
         key: Vec<u8>,
     },
+    GetRecords {
+        key: Vec<u8>,
+    },
     PutRecord {
         key: Vec<u8>,
         value: Vec<u8>,
@@ -61,6 +65,11 @@ impl fmt::Display for DhtRequest {
                 "DHTRequest::GetRecord {{ key={:?} }}",
                 str::from_utf8(key)
             ),
+            DhtRequest::GetRecords { key } => write!(
+                fmt,
+                "DHTRequest::GetRecords {{ key={:?} }}",
+                str::from_utf8(key)
+            ),
             DhtRequest::PutRecord { key, value, quorum } => write!(
                 fmt,
                 "DHTRequest::PutRecord {{ key={:?}, value={:?}, quorum={:?} }}",
@@ -90,8 +99,15 @@ pub enum DhtResponse {
     GetNetworkInfo(NetworkInfo),
     GetPeers(Vec<Peer>),
     GetRecord(DhtRecord),
-    PutRecord { key: Vec<u8> },
-    GetProviders { providers: Vec<libp2p::PeerId> },
+    /// Valid record values, delivered as they are found; the channel closes
+    /// once the query has finished.
+    GetRecords(UnboundedReceiver<Vec<u8>>),
+    PutRecord {
+        key: Vec<u8>,
+    },
+    GetProviders {
+        providers: Vec<libp2p::PeerId>,
+    },
 }
 
 impl fmt::Display for DhtResponse {
@@ -113,6 +129,7 @@ impl fmt::Display for DhtResponse {
             DhtResponse::GetRecord(record) => {
                 write!(fmt, "DHTResponse::GetRecord {{ {record:?} }}")
             }
+            DhtResponse::GetRecords(_) => write!(fmt, "DHTResponse::GetRecords"),
             DhtResponse::PutRecord { key } => write!(
                 fmt,
                 "DHTResponse::PutRecord {{ key={:?} }}",
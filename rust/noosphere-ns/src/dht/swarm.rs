@@ -1,12 +1,15 @@
-use crate::dht::{DhtConfig, DhtError};
+use crate::dht::{
+    transport::memory_transport, DhtConfig, DhtError, DhtRecordStore, DhtTransport,
+    RecordPersistence,
+};
 use anyhow::anyhow;
 use libp2p::{
     allow_block_list,
     identify::{Behaviour as Identify, Config as IdentifyConfig, Event as IdentifyEvent},
     identity::Keypair,
     kad::{
-        self, Behaviour as KademliaBehaviour, Config as KademliaConfig, Event as KademliaEvent,
-        Mode, StoreInserts as KademliaStoreInserts,
+        Behaviour as KademliaBehaviour, Config as KademliaConfig, Event as KademliaEvent, Mode,
+        StoreInserts as KademliaStoreInserts,
     },
     noise,
     swarm::{NetworkBehaviour, SwarmEvent},
@@ -49,14 +52,19 @@ impl From<Void> for DhtEvent {
 #[behaviour(to_swarm = "DhtEvent", event_process = false)]
 pub struct DhtBehavior {
     pub identify: Identify,
-    pub kad: KademliaBehaviour<kad::store::MemoryStore>,
+    pub kad: KademliaBehaviour<DhtRecordStore>,
     blocked_peers: allow_block_list::Behaviour<allow_block_list::BlockedPeers>,
 }
 
 pub type DhtSwarmEvent = SwarmEvent<DhtEvent>;
 
 impl DhtBehavior {
-    pub fn new(keypair: &Keypair, local_peer_id: &PeerId, config: &DhtConfig) -> Self {
+    pub fn new(
+        keypair: &Keypair,
+        local_peer_id: &PeerId,
+        config: &DhtConfig,
+        persistence: Option<RecordPersistence>,
+    ) -> Self {
         let kad = {
             let mut cfg = KademliaConfig::default();
             cfg.set_query_timeout(Duration::from_secs(config.query_timeout.into()));
@@ -81,8 +89,7 @@ impl DhtBehavior {
                 config.publication_interval.into(),
             )));
 
-            // TODO(#99): Use SphereFS storage
-            let store = kad::store::MemoryStore::new(local_peer_id.to_owned());
+            let store = DhtRecordStore::new(local_peer_id.to_owned(), config, persistence);
             let mut behaviour =
                 KademliaBehaviour::with_config(local_peer_id.to_owned(), store, cfg);
 
@@ -117,25 +124,41 @@ pub fn build_swarm(
     keypair: &Keypair,
     local_peer_id: &PeerId,
     config: &DhtConfig,
+    persistence: Option<RecordPersistence>,
 ) -> Result<Swarm<DhtBehavior>, DhtError> {
-    let swarm = SwarmBuilder::with_existing_identity(keypair.to_owned())
-        .with_tokio()
-        .with_tcp(
-            Default::default(),
-            (tls::Config::new, noise::Config::new),
-            yamux::Config::default,
-        )
-        .map_err(|e| DhtError::from(anyhow!("{}", e)))?
-        .with_dns()
-        .map_err(|e| DhtError::from(anyhow!("{}", e)))?
-        .with_behaviour(|keypair| DhtBehavior::new(keypair, local_peer_id, config))
-        .map_err(|e| DhtError::from(anyhow!("{}", e)))?
-        .with_swarm_config(|mut cfg| {
-            cfg = cfg.with_idle_connection_timeout(std::time::Duration::from_secs(
-                CONNECTION_TIMEOUT_SECONDS,
-            ));
-            cfg
-        })
-        .build();
+    let with_swarm_config = |cfg: libp2p::swarm::Config| {
+        cfg.with_idle_connection_timeout(std::time::Duration::from_secs(CONNECTION_TIMEOUT_SECONDS))
+    };
+
+    let swarm = match &config.transport {
+        DhtTransport::Tcp => SwarmBuilder::with_existing_identity(keypair.to_owned())
+            .with_tokio()
+            .with_tcp(
+                Default::default(),
+                (tls::Config::new, noise::Config::new),
+                yamux::Config::default,
+            )
+            .map_err(|e| DhtError::from(anyhow!("{}", e)))?
+            .with_dns()
+            .map_err(|e| DhtError::from(anyhow!("{}", e)))?
+            .with_behaviour(|keypair| DhtBehavior::new(keypair, local_peer_id, config, persistence))
+            .map_err(|e| DhtError::from(anyhow!("{}", e)))?
+            .with_swarm_config(with_swarm_config)
+            .build(),
+        DhtTransport::Memory { latency, stats } => {
+            SwarmBuilder::with_existing_identity(keypair.to_owned())
+                .with_tokio()
+                .with_other_transport(|keypair| {
+                    memory_transport(keypair, latency.to_owned(), stats.clone())
+                })
+                .map_err(|e| DhtError::from(anyhow!("{}", e)))?
+                .with_behaviour(|keypair| {
+                    DhtBehavior::new(keypair, local_peer_id, config, persistence)
+                })
+                .map_err(|e| DhtError::from(anyhow!("{}", e)))?
+                .with_swarm_config(with_swarm_config)
+                .build()
+        }
+    };
     Ok(swarm)
 }
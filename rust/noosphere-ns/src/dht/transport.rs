@@ -0,0 +1,334 @@
+use futures::{AsyncRead, AsyncWrite, Future};
+use libp2p::{
+    core::{
+        muxing::StreamMuxerBox,
+        transport::{Boxed, MemoryTransport},
+        upgrade::Version,
+    },
+    identity::Keypair,
+    noise, yamux, PeerId, Transport,
+};
+use std::{
+    collections::VecDeque,
+    io,
+    pin::Pin,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc,
+    },
+    task::{ready, Context, Poll},
+    time::Duration,
+};
+use tokio::time::{Instant, Sleep};
+
+/// How a [super::DhtNode] connects to its peers.
+#[derive(Clone, Debug, Default)]
+pub enum DhtTransport {
+    /// TCP (with DNS resolution), for nodes on a real network.
+    #[default]
+    Tcp,
+    /// An in-process transport over `/memory/<port>` addresses, for running
+    /// many nodes in one process (e.g. to simulate a large network). Every
+    /// write to a connection is delivered `latency` after it is made, and is
+    /// counted in `stats`.
+    Memory {
+        latency: Duration,
+        stats: Arc<TransportStats>,
+    },
+}
+
+impl DhtTransport {
+    /// A [DhtTransport::Memory] with the given `latency` and fresh
+    /// [TransportStats].
+    pub fn memory(latency: Duration) -> Self {
+        DhtTransport::Memory {
+            latency,
+            stats: Arc::new(TransportStats::default()),
+        }
+    }
+}
+
+/// Counts of the traffic written over a [DhtTransport::Memory]; shared by
+/// every node that uses it.
+#[derive(Debug, Default)]
+pub struct TransportStats {
+    writes: AtomicU64,
+    bytes: AtomicU64,
+}
+
+impl TransportStats {
+    /// How many (muxer-level) frames have been written so far.
+    pub fn writes(&self) -> u64 {
+        self.writes.load(Ordering::Relaxed)
+    }
+
+    /// How many bytes have been written so far.
+    pub fn bytes(&self) -> u64 {
+        self.bytes.load(Ordering::Relaxed)
+    }
+}
+
+/// Builds the authenticated, multiplexed in-process transport described by
+/// [DhtTransport::Memory].
+pub fn memory_transport(
+    keypair: &Keypair,
+    latency: Duration,
+    stats: Arc<TransportStats>,
+) -> Result<Boxed<(PeerId, StreamMuxerBox)>, noise::Error> {
+    Ok(MemoryTransport::default()
+        .map(move |channel, _| LatentStream::new(channel, latency, stats.clone()))
+        .upgrade(Version::V1)
+        .authenticate(noise::Config::new(keypair)?)
+        .multiplex(yamux::Config::default())
+        .map(|(peer_id, muxer), _| (peer_id, StreamMuxerBox::new(muxer)))
+        .boxed())
+}
+
+/// The most bytes that a [LatentStream] takes from its connection at once.
+const LATENT_READ_SIZE: usize = 16 * 1024;
+
+/// How many bytes a [LatentStream] holds back before it stops taking more from
+/// its connection, so that a reader that falls behind still pushes back on the
+/// writer at the other end.
+const MAX_LATENT_BYTES: usize = 64 * LATENT_READ_SIZE;
+
+/// A connection that models propagation delay: writes pass straight through
+/// to the underlying connection, while whatever arrives from it is held back
+/// until `latency` has elapsed since it arrived. Since both ends of a
+/// connection are wrapped, a write is delivered `latency` after it was made,
+/// without limiting how fast (or how often) either end can write.
+struct LatentStream<S> {
+    inner: S,
+    latency: Duration,
+    /// Frames that have arrived, with the time they may be read at
+    arrived: VecDeque<(Instant, Vec<u8>)>,
+    /// How many bytes are held in `arrived`
+    arrived_bytes: usize,
+    /// Scratch space for reading from the connection
+    read_buffer: Box<[u8]>,
+    /// How much of the front frame has already been read
+    offset: usize,
+    /// When the end of the connection may be read, once it has arrived
+    closed_at: Option<Instant>,
+    delay: Pin<Box<Sleep>>,
+    stats: Arc<TransportStats>,
+}
+
+impl<S> LatentStream<S> {
+    fn new(inner: S, latency: Duration, stats: Arc<TransportStats>) -> Self {
+        LatentStream {
+            inner,
+            latency,
+            arrived: VecDeque::new(),
+            arrived_bytes: 0,
+            read_buffer: vec![0; LATENT_READ_SIZE].into_boxed_slice(),
+            offset: 0,
+            closed_at: None,
+            delay: Box::pin(tokio::time::sleep(Duration::ZERO)),
+            stats,
+        }
+    }
+
+    /// Wait until `deadline`, or return [Poll::Pending] (having arranged to be
+    /// woken at the `deadline`).
+    fn poll_until(&mut self, cx: &mut Context<'_>, deadline: Instant) -> Poll<()> {
+        if deadline <= Instant::now() {
+            return Poll::Ready(());
+        }
+        if self.delay.deadline() != deadline {
+            self.delay.as_mut().reset(deadline);
+        }
+        self.delay.as_mut().poll(cx)
+    }
+}
+
+impl<S: AsyncRead + Unpin> AsyncRead for LatentStream<S> {
+    fn poll_read(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<io::Result<usize>> {
+        let this = self.get_mut();
+
+        if this.latency.is_zero() {
+            return Pin::new(&mut this.inner).poll_read(cx, buf);
+        }
+
+        // Take everything that has arrived so far (leaving the connection to
+        // wake us when more does), stamping it with when it may be read. Once
+        // enough is held back, leave the rest on the connection; we will be
+        // polled again as the held back frames are read.
+        while this.closed_at.is_none() && this.arrived_bytes < MAX_LATENT_BYTES {
+            match Pin::new(&mut this.inner).poll_read(cx, &mut this.read_buffer)? {
+                Poll::Ready(0) => this.closed_at = Some(Instant::now() + this.latency),
+                Poll::Ready(read) => {
+                    this.arrived_bytes += read;
+                    this.arrived.push_back((
+                        Instant::now() + this.latency,
+                        this.read_buffer[..read].to_vec(),
+                    ));
+                }
+                Poll::Pending => break,
+            }
+        }
+
+        let next = this.arrived.front().map(|(deadline, _)| *deadline);
+        let deadline = match (next, this.closed_at) {
+            (Some(deadline), _) => deadline,
+            (None, Some(closed_at)) => {
+                ready!(this.poll_until(cx, closed_at));
+                return Poll::Ready(Ok(0));
+            }
+            (None, None) => return Poll::Pending,
+        };
+        ready!(this.poll_until(cx, deadline));
+
+        let (_, frame) = this.arrived.front().expect("a frame has arrived");
+        let read = buf.len().min(frame.len() - this.offset);
+        buf[..read].copy_from_slice(&frame[this.offset..this.offset + read]);
+        this.offset += read;
+
+        if this.offset == frame.len() {
+            this.arrived_bytes -= frame.len();
+            this.arrived.pop_front();
+            this.offset = 0;
+        }
+
+        Poll::Ready(Ok(read))
+    }
+}
+
+impl<S: AsyncWrite + Unpin> AsyncWrite for LatentStream<S> {
+    fn poll_write(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<io::Result<usize>> {
+        let this = self.get_mut();
+        let written = ready!(Pin::new(&mut this.inner).poll_write(cx, buf))?;
+        this.stats.writes.fetch_add(1, Ordering::Relaxed);
+        this.stats
+            .bytes
+            .fetch_add(written as u64, Ordering::Relaxed);
+        Poll::Ready(Ok(written))
+    }
+
+    fn poll_flush(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Pin::new(&mut self.get_mut().inner).poll_flush(cx)
+    }
+
+    fn poll_close(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Pin::new(&mut self.get_mut().inner).poll_close(cx)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{DhtTransport, LatentStream, TransportStats, LATENT_READ_SIZE, MAX_LATENT_BYTES};
+    use crate::dht::{AllowAllValidator, DhtConfig, DhtError, DhtNode};
+    use futures::{channel::mpsc, AsyncReadExt, AsyncWriteExt, StreamExt, TryStreamExt};
+    use libp2p::identity::Keypair;
+    use std::{io, sync::Arc, time::Duration};
+    use tokio::time::Instant;
+
+    #[tokio::test]
+    async fn it_does_not_hold_back_writes() -> io::Result<()> {
+        let stats = Arc::new(TransportStats::default());
+        let mut stream = LatentStream::new(Vec::new(), Duration::from_secs(60), stats.clone());
+
+        for _ in 0..100 {
+            stream.write_all(b"foo").await?;
+        }
+
+        assert_eq!(stream.inner.len(), 300);
+        assert_eq!(stats.writes(), 100);
+        assert_eq!(stats.bytes(), 300);
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_delivers_each_write_after_the_latency() -> io::Result<()> {
+        let latency = Duration::from_millis(200);
+        let (sender, receiver) = mpsc::unbounded::<Vec<u8>>();
+        let mut stream = LatentStream::new(
+            receiver.map(Ok::<_, io::Error>).into_async_read(),
+            latency,
+            Arc::new(TransportStats::default()),
+        );
+
+        let start = Instant::now();
+        for _ in 0..10 {
+            sender.unbounded_send(b"foo".to_vec()).unwrap();
+        }
+        drop(sender);
+
+        let mut delivered = Vec::new();
+        stream.read_to_end(&mut delivered).await?;
+        let elapsed = start.elapsed();
+
+        assert_eq!(delivered, b"foo".repeat(10));
+        // The writes are delayed together, rather than one after another
+        assert!(elapsed >= latency);
+        assert!(elapsed < latency * 10);
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_stops_reading_once_enough_is_held_back() -> io::Result<()> {
+        let (sender, receiver) = mpsc::unbounded::<Vec<u8>>();
+        let mut stream = LatentStream::new(
+            receiver.map(Ok::<_, io::Error>).into_async_read(),
+            Duration::from_millis(50),
+            Arc::new(TransportStats::default()),
+        );
+
+        let frames = 2 * MAX_LATENT_BYTES / LATENT_READ_SIZE;
+        for _ in 0..frames {
+            sender.unbounded_send(vec![1; LATENT_READ_SIZE]).unwrap();
+        }
+        drop(sender);
+
+        let mut byte = [0; 1];
+        stream.read_exact(&mut byte).await?;
+        assert!(stream.arrived_bytes <= MAX_LATENT_BYTES);
+
+        let mut delivered = Vec::new();
+        stream.read_to_end(&mut delivered).await?;
+        assert_eq!(delivered.len() + 1, frames * LATENT_READ_SIZE);
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_connects_nodes_in_process() -> Result<(), DhtError> {
+        let transport = DhtTransport::memory(Duration::from_millis(5));
+        let config = DhtConfig {
+            transport: transport.clone(),
+            peer_dialing_interval: 1,
+            ..Default::default()
+        };
+        let make_node = || {
+            DhtNode::new(
+                Keypair::generate_ed25519(),
+                config.clone(),
+                Some(AllowAllValidator {}),
+            )
+        };
+
+        let bootstrap = make_node()?;
+        let address = bootstrap.listen("/memory/0".parse().unwrap()).await?;
+        let node = make_node()?;
+        node.listen("/memory/0".parse().unwrap()).await?;
+        node.add_peers(vec![address]).await?;
+        node.wait_for_peers(1).await?;
+
+        node.put_record(b"foo", b"bar", 1).await?;
+        let record = bootstrap.get_record(b"foo").await?;
+        assert_eq!(record.value.expect("has value"), b"bar");
+
+        if let DhtTransport::Memory { stats, .. } = transport {
+            assert!(stats.writes() > 0);
+            assert!(stats.bytes() > 0);
+        }
+        Ok(())
+    }
+}
@@ -9,6 +9,12 @@ pub struct NetworkInfo {
     pub num_connections: u32,
     pub num_pending: u32,
     pub num_established: u32,
+    /// DHT queries started on behalf of clients that are still running.
+    #[serde(default)]
+    pub inflight_queries: usize,
+    /// Queries waiting for a free slot before they are started.
+    #[serde(default)]
+    pub queued_queries: usize,
 }
 
 impl From<LibP2pNetworkInfo> for NetworkInfo {
@@ -19,6 +25,8 @@ impl From<LibP2pNetworkInfo> for NetworkInfo {
             num_connections: c.num_connections(),
             num_pending: c.num_pending(),
             num_established: c.num_established(),
+            inflight_queries: 0,
+            queued_queries: 0,
         }
     }
 }
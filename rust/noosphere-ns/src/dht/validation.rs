@@ -0,0 +1,320 @@
+use super::{rpc::DhtMessage, Validator};
+use cid::{
+    multihash::{Code, MultihashDigest},
+    Cid,
+};
+use libp2p::{
+    kad::{QueryId, Record},
+    PeerId,
+};
+use std::{
+    collections::{HashSet, VecDeque},
+    sync::Arc,
+};
+use tokio::sync::{
+    mpsc::{unbounded_channel, UnboundedReceiver, UnboundedSender},
+    OwnedSemaphorePermit, Semaphore,
+};
+
+/// The multicodec for raw bytes; record values are only hashed to identify
+/// them in the cache of validated records.
+const RAW_CODEC: u64 = 0x55;
+
+/// Work that was waiting on a record to be validated, which is resumed by the
+/// [super::processor::DhtProcessor] once the outcome is known.
+pub enum PendingValidation {
+    /// A client asked to put a record into the DHT.
+    PutRecord {
+        message: DhtMessage,
+        key: Vec<u8>,
+        value: Vec<u8>,
+        quorum: usize,
+    },
+    /// A record was found for a client's `GetRecord` query; every request
+    /// for the same key is answered with it.
+    GetRecord {
+        messages: Vec<DhtMessage>,
+        key: Vec<u8>,
+        value: Vec<u8>,
+    },
+    /// A record was found for a client's `GetRecords` query.
+    StreamedRecord { query_id: QueryId, value: Vec<u8> },
+    /// A peer asked this node to store a record.
+    InboundPutRecord { record: Record, source: PeerId },
+}
+
+impl PendingValidation {
+    fn value(&self) -> &[u8] {
+        match self {
+            PendingValidation::PutRecord { value, .. } => value,
+            PendingValidation::GetRecord { value, .. } => value,
+            PendingValidation::StreamedRecord { value, .. } => value,
+            PendingValidation::InboundPutRecord { record, .. } => &record.value,
+        }
+    }
+}
+
+/// A bounded, first-in-first-out set of the CIDs of record values that have
+/// been found to be valid.
+struct ValidatedRecords {
+    capacity: usize,
+    members: HashSet<Cid>,
+    order: VecDeque<Cid>,
+}
+
+impl ValidatedRecords {
+    fn new(capacity: usize) -> Self {
+        ValidatedRecords {
+            capacity,
+            members: HashSet::default(),
+            order: VecDeque::default(),
+        }
+    }
+
+    fn contains(&self, cid: &Cid) -> bool {
+        self.members.contains(cid)
+    }
+
+    fn insert(&mut self, cid: Cid) {
+        if self.capacity == 0 || !self.members.insert(cid) {
+            return;
+        }
+
+        self.order.push_back(cid);
+
+        while self.order.len() > self.capacity {
+            if let Some(evicted) = self.order.pop_front() {
+                self.members.remove(&evicted);
+            }
+        }
+    }
+}
+
+/// Validates record values with a [Validator] in a bounded pool of parallel
+/// tasks, so that expensive validation (such as verifying the signatures of a
+/// [noosphere_core::data::LinkRecord]) never holds up the DHT's event loop.
+///
+/// A task is only spawned once it holds one of the pool's permits; values
+/// that arrive while every permit is held wait in a bounded queue, and are
+/// handed back to the caller by [ValidationPool::validate] once that queue is
+/// full.
+///
+/// Outcomes are delivered through [ValidationPool::next_outcome]. Values that
+/// were found to be valid are remembered by CID, and are not validated again
+/// when they are seen later (for example, when a record is re-gossiped during
+/// replication). Only valid outcomes are remembered; a [Validator] is
+/// expected to judge the same value the same way every time.
+pub struct ValidationPool<V: Validator + 'static> {
+    validator: Option<Arc<V>>,
+    permits: Arc<Semaphore>,
+    queued: VecDeque<(PendingValidation, Cid)>,
+    queue_capacity: usize,
+    validated: ValidatedRecords,
+    sender: UnboundedSender<(PendingValidation, Option<Cid>, bool)>,
+    receiver: UnboundedReceiver<(PendingValidation, Option<Cid>, bool)>,
+}
+
+impl<V> ValidationPool<V>
+where
+    V: Validator + 'static,
+{
+    pub fn new(
+        validator: Option<V>,
+        concurrency: usize,
+        queue_capacity: usize,
+        cache_capacity: usize,
+    ) -> Self {
+        let (sender, receiver) = unbounded_channel();
+
+        ValidationPool {
+            validator: validator.map(Arc::new),
+            permits: Arc::new(Semaphore::new(concurrency.max(1))),
+            queued: VecDeque::new(),
+            queue_capacity,
+            validated: ValidatedRecords::new(cache_capacity),
+            sender,
+            receiver,
+        }
+    }
+
+    /// Validate the value of `pending`; the outcome is delivered later via
+    /// [ValidationPool::next_outcome]. If the pool is saturated, `pending` is
+    /// handed back as an error and will not be validated.
+    pub fn validate(&mut self, pending: PendingValidation) -> Result<(), PendingValidation> {
+        let validator = match self.validator.as_ref() {
+            Some(validator) => validator.clone(),
+            None => {
+                let _ = self.sender.send((pending, None, true));
+                return Ok(());
+            }
+        };
+
+        let cid = Cid::new_v1(RAW_CODEC, Code::Blake3_256.digest(pending.value()));
+
+        if self.validated.contains(&cid) {
+            let _ = self.sender.send((pending, None, true));
+            return Ok(());
+        }
+
+        match self.permits.clone().try_acquire_owned() {
+            Ok(permit) => {
+                self.spawn(validator, pending, cid, permit);
+                Ok(())
+            }
+            Err(_) if self.queued.len() < self.queue_capacity => {
+                self.queued.push_back((pending, cid));
+                Ok(())
+            }
+            Err(_) => Err(pending),
+        }
+    }
+
+    fn spawn(
+        &self,
+        validator: Arc<V>,
+        pending: PendingValidation,
+        cid: Cid,
+        permit: OwnedSemaphorePermit,
+    ) {
+        let sender = self.sender.clone();
+
+        tokio::spawn(async move {
+            let is_valid = validator.validate(pending.value()).await;
+            // Release the permit before the outcome is seen, so that a queued
+            // validation can take it as soon as the outcome is
+            drop(permit);
+            let _ = sender.send((pending, Some(cid), is_valid));
+        });
+    }
+
+    /// Wait for the next validation to finish, returning the work that was
+    /// waiting on it and whether or not its record is valid.
+    pub async fn next_outcome(&mut self) -> (PendingValidation, bool) {
+        // The pool holds a sender of its own, so the channel never closes
+        let (pending, cid, is_valid) = self
+            .receiver
+            .recv()
+            .await
+            .expect("Validation channel closed");
+
+        if let (Some(cid), true) = (cid, is_valid) {
+            self.validated.insert(cid);
+        }
+
+        // A permit may have been released by the validation that finished
+        while !self.queued.is_empty() {
+            let permit = match self.permits.clone().try_acquire_owned() {
+                Ok(permit) => permit,
+                Err(_) => break,
+            };
+            let (pending, cid) = self.queued.pop_front().expect("a validation is queued");
+            // Values are only queued when there is a validator
+            if let Some(validator) = self.validator.clone() {
+                self.spawn(validator, pending, cid, permit);
+            }
+        }
+
+        (pending, is_valid)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{PendingValidation, ValidationPool};
+    use crate::dht::Validator;
+    use async_trait::async_trait;
+    use libp2p::{
+        kad::{Record, RecordKey},
+        PeerId,
+    };
+    use std::sync::{
+        atomic::{AtomicUsize, Ordering},
+        Arc,
+    };
+    use tokio::sync::Semaphore;
+
+    #[derive(Clone, Default)]
+    struct CountingValidator {
+        calls: Arc<AtomicUsize>,
+    }
+
+    #[async_trait]
+    impl Validator for CountingValidator {
+        async fn validate(&self, data: &[u8]) -> bool {
+            self.calls.fetch_add(1, Ordering::SeqCst);
+            data == b"valid"
+        }
+    }
+
+    fn inbound(value: &[u8]) -> PendingValidation {
+        PendingValidation::InboundPutRecord {
+            record: Record::new(RecordKey::new(&"key"), value.to_vec()),
+            source: PeerId::random(),
+        }
+    }
+
+    #[tokio::test]
+    async fn it_only_validates_a_valid_record_once() {
+        let validator = CountingValidator::default();
+        let mut pool = ValidationPool::new(Some(validator.clone()), 2, 16, 16);
+
+        assert!(pool.validate(inbound(b"valid")).is_ok());
+        assert!(pool.next_outcome().await.1);
+
+        assert!(pool.validate(inbound(b"valid")).is_ok());
+        assert!(pool.next_outcome().await.1);
+        assert_eq!(validator.calls.load(Ordering::SeqCst), 1);
+
+        assert!(pool.validate(inbound(b"invalid")).is_ok());
+        assert!(!pool.next_outcome().await.1);
+        assert!(pool.validate(inbound(b"invalid")).is_ok());
+        assert!(!pool.next_outcome().await.1);
+        assert_eq!(validator.calls.load(Ordering::SeqCst), 3);
+    }
+
+    #[tokio::test]
+    async fn it_evicts_the_oldest_validated_records() {
+        let validator = CountingValidator::default();
+        let mut pool = ValidationPool::new(Some(validator.clone()), 2, 16, 1);
+
+        assert!(pool.validate(inbound(b"valid")).is_ok());
+        pool.next_outcome().await;
+        pool.validated.insert(cid::Cid::default());
+
+        assert!(pool.validate(inbound(b"valid")).is_ok());
+        assert!(pool.next_outcome().await.1);
+        assert_eq!(validator.calls.load(Ordering::SeqCst), 2);
+    }
+
+    /// Holds every validation until it is allowed to finish.
+    #[derive(Clone)]
+    struct GatedValidator {
+        gate: Arc<Semaphore>,
+    }
+
+    #[async_trait]
+    impl Validator for GatedValidator {
+        async fn validate(&self, _data: &[u8]) -> bool {
+            self.gate.acquire().await.unwrap().forget();
+            true
+        }
+    }
+
+    #[tokio::test]
+    async fn it_hands_back_records_once_saturated() {
+        let gate = Arc::new(Semaphore::new(0));
+        let mut pool = ValidationPool::new(Some(GatedValidator { gate: gate.clone() }), 1, 1, 16);
+
+        assert!(pool.validate(inbound(b"running")).is_ok());
+        assert!(pool.validate(inbound(b"queued")).is_ok());
+        assert!(pool.validate(inbound(b"refused")).is_err());
+
+        gate.add_permits(2);
+
+        for expected in [b"running".as_slice(), b"queued".as_slice()] {
+            let (pending, is_valid) = pool.next_outcome().await;
+            assert!(is_valid);
+            assert_eq!(pending.value(), expected);
+        }
+    }
+}
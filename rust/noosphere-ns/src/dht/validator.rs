@@ -2,7 +2,9 @@ use async_trait::async_trait;
 
 /// Trait that implements a `validate` function that determines
 /// what records can be set and stored on the [crate::dht::DHTNode].
-/// Currently only validates "Value" records.
+/// Currently only validates "Value" records. Records are validated by a
+/// bounded pool of parallel tasks, off of the DHT's event loop, so
+/// validation only has shared access to the [Validator].
 ///
 /// # Example
 ///
@@ -17,21 +19,21 @@ use async_trait::async_trait;
 /// #[async_trait]
 /// impl Validator for MyValidator {
 ///     // Ensures value is "hello" in bytes.
-///     async fn validate(&mut self, data: &[u8]) -> bool {
+///     async fn validate(&self, data: &[u8]) -> bool {
 ///         data[..] == [104, 101, 108, 108, 111][..]
 ///     }
 /// }
 ///
 /// #[tokio::main(flavor = "multi_thread")]
 /// async fn main() {
-///     let mut validator = MyValidator {};
+///     let validator = MyValidator {};
 ///     let data = String::from("hello").into_bytes();
 ///     let is_valid = validator.validate(&data).await;
 ///     assert!(is_valid);
 /// }
 #[async_trait]
 pub trait Validator: Send + Sync {
-    async fn validate(&mut self, record_value: &[u8]) -> bool;
+    async fn validate(&self, record_value: &[u8]) -> bool;
 }
 
 /// An implementation of [Validator] that allows all records.
@@ -41,7 +43,7 @@ pub struct AllowAllValidator {}
 
 #[async_trait]
 impl Validator for AllowAllValidator {
-    async fn validate(&mut self, _data: &[u8]) -> bool {
+    async fn validate(&self, _data: &[u8]) -> bool {
         true
     }
 }
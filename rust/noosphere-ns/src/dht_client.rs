@@ -4,6 +4,7 @@ use crate::{
 };
 use anyhow::Result;
 use async_trait::async_trait;
+use futures::{stream, StreamExt};
 use libp2p::Multiaddr;
 use noosphere_core::data::{Did, LinkRecord};
 
@@ -12,6 +13,10 @@ use crate::server::HttpClient;
 #[cfg(doc)]
 use crate::NameSystem;
 
+/// How many queries of a batch (e.g. [DhtClient::get_records]) are run
+/// concurrently by default.
+pub const DEFAULT_BATCH_PARALLELISM: usize = 16;
+
 #[async_trait]
 pub trait DhtClient: Send + Sync {
     /* Diagnostic APIs */
@@ -51,6 +56,39 @@ pub trait DhtClient: Send + Sync {
     /// Returns an [LinkRecord] for the provided identity if found.
     async fn get_record(&self, identity: &Did) -> Result<Option<LinkRecord>>;
 
+    /// Propagates many [LinkRecord]s at once, returning the outcome for the
+    /// identity of each record in the order that they complete.
+    async fn put_records(
+        &self,
+        records: Vec<LinkRecord>,
+        quorum: usize,
+    ) -> Result<Vec<(Did, Result<()>)>> {
+        Ok(stream::iter(records)
+            .map(|record| async move {
+                let identity = record.to_sphere_identity();
+                (identity, self.put_record(record, quorum).await)
+            })
+            .buffer_unordered(DEFAULT_BATCH_PARALLELISM)
+            .collect()
+            .await)
+    }
+
+    /// Returns the [LinkRecord]s of many identities at once, in the order
+    /// that their queries complete.
+    async fn get_records(
+        &self,
+        identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        Ok(stream::iter(identities)
+            .map(|identity| async move {
+                let record = self.get_record(&identity).await;
+                (identity, record)
+            })
+            .buffer_unordered(DEFAULT_BATCH_PARALLELISM)
+            .collect()
+            .await)
+    }
+
     /* Operator APIs */
 
     /// Connects to peers provided in `add_peers`.
@@ -196,6 +234,15 @@ pub mod test {
 
         assert_eq!(retrieved.to_sphere_identity(), sphere_identity);
         assert_eq!(retrieved.get_link(), Some(link.into()));
+
+        let batch = client
+            .get_records(vec![sphere_identity.clone(), sphere_identity.clone()])
+            .await?;
+        assert_eq!(batch.len(), 2);
+        for (identity, record) in batch {
+            assert_eq!(identity, sphere_identity);
+            assert_eq!(record?, Some(retrieved.clone()));
+        }
         Ok(())
     }
 }
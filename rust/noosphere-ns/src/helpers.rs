@@ -104,6 +104,30 @@ impl NameResolver for KeyValueNameResolver {
     }
 }
 
+/// A [NameResolver] that resolves single records with the [NameResolver] it
+/// wraps, but whose batch resolution always fails; useful for testing the
+/// fallback from batch to single resolutions.
+#[derive(Clone, Default)]
+pub struct UnbatchedResolver<R: NameResolver = KeyValueNameResolver>(pub R);
+
+#[async_trait]
+impl<R: NameResolver> NameResolver for UnbatchedResolver<R> {
+    async fn publish(&self, record: LinkRecord) -> Result<()> {
+        self.0.publish(record).await
+    }
+
+    async fn resolve(&self, identity: &Did) -> Result<Option<LinkRecord>> {
+        self.0.resolve(identity).await
+    }
+
+    async fn resolve_many(
+        &self,
+        _identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        Err(anyhow::anyhow!("Batch resolution is not supported"))
+    }
+}
+
 #[cfg(test)]
 mod test {
     use super::*;
@@ -7,6 +7,7 @@ extern crate tracing;
 extern crate lazy_static;
 
 mod builder;
+mod caching_resolver;
 pub mod dht;
 mod dht_client;
 pub mod helpers;
@@ -19,8 +20,9 @@ mod validator;
 pub mod server;
 
 pub use builder::NameSystemBuilder;
+pub use caching_resolver::{CachingNameResolver, NameResolverCacheConfig};
 pub use dht::{DhtConfig, NetworkInfo, Peer};
-pub use dht_client::DhtClient;
+pub use dht_client::{DhtClient, DEFAULT_BATCH_PARALLELISM};
 pub use libp2p::{multiaddr::Multiaddr, PeerId};
 pub use name_resolver::NameResolver;
 pub use name_system::{NameSystem, NameSystemKeyMaterial, BOOTSTRAP_PEERS};
@@ -1,6 +1,7 @@
-use crate::DhtClient;
+use crate::{dht_client::DEFAULT_BATCH_PARALLELISM, DhtClient};
 use anyhow::Result;
 use async_trait::async_trait;
+use futures::{stream, StreamExt};
 use noosphere_core::data::{Did, LinkRecord};
 
 #[async_trait]
@@ -9,6 +10,21 @@ pub trait NameResolver: Send + Sync {
     async fn publish(&self, record: LinkRecord) -> Result<()>;
     /// Retrieves a record from the name system.
     async fn resolve(&self, identity: &Did) -> Result<Option<LinkRecord>>;
+    /// Retrieves the records of many identities from the name system, in the
+    /// order that they are resolved.
+    async fn resolve_many(
+        &self,
+        identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        Ok(stream::iter(identities)
+            .map(|identity| async move {
+                let record = self.resolve(&identity).await;
+                (identity, record)
+            })
+            .buffer_unordered(DEFAULT_BATCH_PARALLELISM)
+            .collect()
+            .await)
+    }
 }
 
 #[async_trait]
@@ -20,6 +36,13 @@ impl<T: DhtClient> NameResolver for T {
     async fn resolve(&self, identity: &Did) -> Result<Option<LinkRecord>> {
         self.get_record(identity).await
     }
+
+    async fn resolve_many(
+        &self,
+        identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        self.get_records(identities).await
+    }
 }
 
 /// Helper macro for running agnostic [NameResolver] tests for
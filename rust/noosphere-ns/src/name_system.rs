@@ -1,5 +1,5 @@
 use crate::{
-    dht::{DhtConfig, DhtError, DhtNode, DhtRecord, NetworkInfo, Peer},
+    dht::{DhtConfig, DhtError, DhtNode, NetworkInfo, Peer, RecordPersistence},
     utils::make_p2p_address,
     validator::RecordValidator,
     DhtClient, PeerId,
@@ -7,6 +7,7 @@ use crate::{
 use anyhow::{anyhow, Result};
 use async_trait::async_trait;
 use libp2p::{identity::Keypair, Multiaddr};
+use noosphere_common::metrics::metrics;
 use noosphere_core::{
     authority::ed25519_key_to_bytes,
     data::{Did, LinkRecord},
@@ -14,6 +15,8 @@ use noosphere_core::{
 use noosphere_ucan::{
     crypto::KeyMaterial, key_material::ed25519::Ed25519KeyMaterial, store::UcanJwtStore,
 };
+use std::time::Duration;
+use tokio::{sync::mpsc::UnboundedReceiver, time::Instant};
 
 #[cfg(doc)]
 use cid::Cid;
@@ -64,12 +67,23 @@ impl NameSystem {
         key_material: &K,
         dht_config: DhtConfig,
         store: Option<S>,
+    ) -> Result<Self> {
+        Self::with_record_persistence(key_material, dht_config, store, None)
+    }
+
+    /// Creates a new [NameSystem] whose DHT records survive restarts via
+    /// the provided [RecordPersistence].
+    pub fn with_record_persistence<K: NameSystemKeyMaterial, S: UcanJwtStore + 'static>(
+        key_material: &K,
+        dht_config: DhtConfig,
+        store: Option<S>,
+        persistence: Option<RecordPersistence>,
     ) -> Result<Self> {
         let keypair = key_material.to_dht_keypair()?;
         let validator = store.map(|s| RecordValidator::new(s));
 
         Ok(NameSystem {
-            dht: DhtNode::new(keypair, dht_config, validator)?,
+            dht: DhtNode::with_record_persistence(keypair, dht_config, validator, persistence)?,
         })
     }
 }
@@ -132,6 +146,10 @@ impl DhtClient for NameSystem {
     }
 
     async fn put_record(&self, record: LinkRecord, quorum: usize) -> Result<()> {
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("put_record");
         let identity = record.to_sphere_identity();
         let record_bytes: Vec<u8> = record.try_into()?;
         match self
@@ -145,20 +163,86 @@ impl DhtClient for NameSystem {
     }
 
     async fn get_record(&self, identity: &Did) -> Result<Option<LinkRecord>> {
-        match self.dht.get_record(identity.as_bytes()).await {
-            Ok(DhtRecord { key: _, value }) => match value {
-                Some(value) => Ok(Some(LinkRecord::try_from(value)?)),
-                None => Ok(None),
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("get_record");
+        let config = self.dht.config();
+        let records = self
+            .dht
+            .get_records(identity.as_bytes())
+            .await
+            .map_err(|e| anyhow!(e.to_string()))?;
+
+        Ok(gather_newest_record(
+            identity,
+            records,
+            config.resolution_quorum.max(1),
+            Duration::from_millis(config.resolution_deadline_ms),
+        )
+        .await)
+    }
+}
+
+/// Gathers records for `identity` from `records` until there is a `quorum`
+/// of them, or until `deadline` has passed since the first valid one was
+/// found, and returns the most recent of them. Dropping `records` when done
+/// finishes the query behind it early.
+async fn gather_newest_record(
+    identity: &Did,
+    mut records: UnboundedReceiver<Vec<u8>>,
+    quorum: usize,
+    deadline: Duration,
+) -> Option<LinkRecord> {
+    let timer = tokio::time::sleep(deadline);
+    tokio::pin!(timer);
+
+    let mut newest: Option<LinkRecord> = None;
+    let mut found = 0;
+
+    while found < quorum {
+        tokio::select! {
+            value = records.recv() => match value {
+                Some(value) => {
+                    // Only records that decode count toward the quorum
+                    match LinkRecord::try_from(value) {
+                        Ok(record) => {
+                            found += 1;
+                            if newest.is_none() {
+                                timer.as_mut().reset(Instant::now() + deadline);
+                            }
+                            newest = Some(newest_record(newest, record));
+                        }
+                        Err(error) => warn!("Could not decode record for {}: {}", identity, error),
+                    }
+                }
+                None => break,
             },
-            Err(e) => Err(anyhow!(e.to_string())),
+            _ = &mut timer, if newest.is_some() => break,
         }
     }
+
+    newest
+}
+
+/// Of the `current` most recent record and a newly found one, whichever is
+/// more recent.
+fn newest_record(current: Option<LinkRecord>, found: LinkRecord) -> LinkRecord {
+    match current {
+        Some(current) if !current.superceded_by(&found) => current,
+        _ => found,
+    }
 }
 
 #[cfg(test)]
 mod test {
     use super::*;
-    use noosphere_core::authority::generate_ed25519_key;
+    use noosphere_core::{
+        authority::{generate_capability, generate_ed25519_key, SphereAbility},
+        data::LINK_RECORD_FACT_NAME,
+    };
+    use noosphere_ucan::builder::UcanBuilder;
+    use tokio::sync::mpsc::unbounded_channel;
 
     #[test]
     fn bootstrap_peers_parseable() {
@@ -167,6 +251,89 @@ mod test {
         assert_eq!(BOOTSTRAP_PEERS.len(), 1);
     }
 
+    /// Records for the same sphere that differ only in their lifetimes (and
+    /// so in how recent they are)
+    async fn make_conflicting_records(lifetimes: &[u64]) -> Result<(Did, Vec<LinkRecord>)> {
+        let sphere_key = generate_ed25519_key();
+        let identity = Did::from(sphere_key.get_did().await?);
+        let mut records = Vec::new();
+
+        for lifetime in lifetimes {
+            let ucan = UcanBuilder::default()
+                .issued_by(&sphere_key)
+                .for_audience(&identity)
+                .claiming_capability(&generate_capability(&identity, SphereAbility::Publish))
+                .with_fact(
+                    LINK_RECORD_FACT_NAME,
+                    "bafyr4iagi6t6khdrtbhmyjpjgvdlwv6pzylxhuhstxhkdp52rju7er325i".to_owned(),
+                )
+                .with_lifetime(*lifetime)
+                .build()?
+                .sign()
+                .await?;
+            records.push(LinkRecord::from(ucan));
+        }
+
+        Ok((identity, records))
+    }
+
+    #[tokio::test]
+    async fn it_resolves_the_newest_of_conflicting_records() -> Result<()> {
+        let (identity, records) = make_conflicting_records(&[2000, 1000, 3000, 1500]).await?;
+        let (sender, receiver) = unbounded_channel();
+
+        for record in records.iter() {
+            sender.send(record.clone().try_into()?)?;
+        }
+
+        let newest =
+            gather_newest_record(&identity, receiver, records.len(), Duration::from_secs(30)).await;
+
+        assert_eq!(newest.as_ref(), Some(&records[2]));
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_waits_out_the_deadline_from_the_first_valid_record() -> Result<()> {
+        let (identity, records) = make_conflicting_records(&[1000, 2000]).await?;
+        let (sender, receiver) = unbounded_channel::<Vec<u8>>();
+        let values: Vec<Vec<u8>> = records
+            .iter()
+            .map(|record| record.clone().try_into())
+            .collect::<Result<_>>()?;
+
+        // The first record arrives well after the deadline would have passed
+        // had it started with the query, and the second arrives within the
+        // deadline of the first
+        tokio::spawn(async move {
+            tokio::time::sleep(Duration::from_millis(1000)).await;
+            sender.send(values[0].clone()).unwrap();
+            tokio::time::sleep(Duration::from_millis(100)).await;
+            sender.send(values[1].clone()).unwrap();
+            tokio::time::sleep(Duration::from_secs(30)).await;
+        });
+
+        let newest = gather_newest_record(&identity, receiver, 3, Duration::from_millis(500)).await;
+
+        assert_eq!(newest.as_ref(), Some(&records[1]));
+        Ok(())
+    }
+
+    #[tokio::test]
+    async fn it_does_not_count_undecodable_records_toward_the_quorum() -> Result<()> {
+        let (identity, records) = make_conflicting_records(&[1000, 2000]).await?;
+        let (sender, receiver) = unbounded_channel();
+
+        sender.send(records[0].clone().try_into()?)?;
+        sender.send(b"not a record".to_vec())?;
+        sender.send(records[1].clone().try_into()?)?;
+
+        let newest = gather_newest_record(&identity, receiver, 2, Duration::from_secs(30)).await;
+
+        assert_eq!(newest.as_ref(), Some(&records[1]));
+        Ok(())
+    }
+
     use crate::name_resolver_tests;
     async fn before_name_resolver_tests() -> Result<NameSystem> {
         let ns = {
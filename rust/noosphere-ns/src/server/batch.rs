@@ -0,0 +1,132 @@
+use anyhow::Result;
+use bytes::Bytes;
+use futures::{stream::BoxStream, Stream, StreamExt};
+use noosphere_core::data::{Did, LinkRecord};
+use serde::{de::DeserializeOwned, Deserialize, Serialize};
+
+/// The content type of the responses of batch routes: one JSON value per line,
+/// written as soon as it is available.
+pub const NDJSON_CONTENT_TYPE: &str = "application/x-ndjson";
+
+/// The most identities or records that a single batch request may contain.
+pub const MAX_BATCH_SIZE: usize = 1024;
+
+/// The most queries of a batch request that are run concurrently, regardless
+/// of the parallelism that was asked for.
+pub const MAX_BATCH_PARALLELISM: usize = 64;
+
+/// The outcome for a single identity of a batch request.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct BatchResult<T> {
+    pub identity: Did,
+    pub result: Result<T, String>,
+}
+
+/// One line of the response to a batch resolve request.
+pub type BatchResolution = BatchResult<Option<LinkRecord>>;
+
+/// One line of the response to a batch publish request.
+pub type BatchPublication = BatchResult<()>;
+
+/// Query parameters accepted by the batch routes.
+#[derive(Debug, Default, Deserialize)]
+pub struct BatchQuery {
+    /// How many queries to run concurrently (at most
+    /// [MAX_BATCH_PARALLELISM])
+    pub parallelism: Option<usize>,
+    /// When publishing, how many peers each record must be stored on
+    pub quorum: Option<usize>,
+}
+
+/// Serializes `value` as a line of newline-delimited JSON.
+pub fn to_ndjson_line<T: Serialize>(value: &T) -> Result<Bytes, serde_json::Error> {
+    let mut line = serde_json::to_vec(value)?;
+    line.push(b'\n');
+    Ok(Bytes::from(line))
+}
+
+/// Parses a stream of newline-delimited JSON chunks, yielding each value as
+/// soon as its line is complete.
+pub fn from_ndjson_stream<S, E, T>(chunks: S) -> BoxStream<'static, Result<T>>
+where
+    S: Stream<Item = Result<Bytes, E>> + Send + 'static,
+    E: Into<anyhow::Error> + Send + 'static,
+    T: DeserializeOwned + Send + 'static,
+{
+    let parse = |line: &[u8]| serde_json::from_slice::<T>(line).map_err(anyhow::Error::from);
+
+    futures::stream::unfold(
+        (chunks.boxed(), Vec::new(), false),
+        move |(mut chunks, mut buffer, mut finished)| async move {
+            loop {
+                if let Some(end) = buffer.iter().position(|byte| *byte == b'\n') {
+                    let line: Vec<u8> = buffer.drain(..=end).collect();
+                    if line.len() > 1 {
+                        let value = parse(&line[..end]);
+                        return Some((value, (chunks, buffer, finished)));
+                    }
+                    continue;
+                }
+
+                if finished {
+                    if buffer.iter().all(|byte| byte.is_ascii_whitespace()) {
+                        return None;
+                    }
+                    let value = parse(&buffer);
+                    buffer.clear();
+                    return Some((value, (chunks, buffer, finished)));
+                }
+
+                match chunks.next().await {
+                    Some(Ok(chunk)) => buffer.extend_from_slice(&chunk),
+                    Some(Err(error)) => {
+                        buffer.clear();
+                        return Some((Err(error.into()), (chunks, buffer, true)));
+                    }
+                    None => finished = true,
+                }
+            }
+        },
+    )
+    .boxed()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{from_ndjson_stream, to_ndjson_line, BatchPublication};
+    use anyhow::Result;
+    use bytes::Bytes;
+    use futures::StreamExt;
+    use noosphere_core::data::Did;
+
+    #[tokio::test]
+    async fn it_parses_lines_split_across_chunks() -> Result<()> {
+        let first = to_ndjson_line(&BatchPublication {
+            identity: Did::from("did:key:a"),
+            result: Ok(()),
+        })?;
+        let second = to_ndjson_line(&BatchPublication {
+            identity: Did::from("did:key:b"),
+            result: Err("failed".into()),
+        })?;
+        let joined = [first.as_ref(), second.as_ref()].concat();
+        let (head, tail) = joined.split_at(first.len() + 5);
+        let chunks = futures::stream::iter(vec![
+            Ok::<_, anyhow::Error>(Bytes::copy_from_slice(&head[..3])),
+            Ok(Bytes::copy_from_slice(&head[3..])),
+            Ok(Bytes::copy_from_slice(tail)),
+        ]);
+
+        let parsed: Vec<Result<BatchPublication>> = from_ndjson_stream(chunks).collect().await;
+
+        assert_eq!(parsed.len(), 2);
+        let first = parsed[0].as_ref().unwrap();
+        assert_eq!(first.identity, Did::from("did:key:a"));
+        assert!(first.result.is_ok());
+        let second = parsed[1].as_ref().unwrap();
+        assert_eq!(second.identity, Did::from("did:key:b"));
+        assert_eq!(second.result, Err("failed".into()));
+
+        Ok(())
+    }
+}
@@ -1,11 +1,65 @@
+use crate::server::batch::{
+    from_ndjson_stream, BatchPublication, BatchResolution, BatchResult, MAX_BATCH_SIZE,
+};
 use crate::server::routes::Route;
+use crate::DEFAULT_BATCH_PARALLELISM;
 use crate::{dht_client::DhtClient, Multiaddr, NetworkInfo, Peer, PeerId};
 use anyhow::{anyhow, Result};
 use async_trait::async_trait;
+use futures::{stream::BoxStream, StreamExt};
+use noosphere_common::metrics::metrics;
 use noosphere_core::data::{Did, LinkRecord};
 use reqwest::Body;
+use std::collections::BTreeMap;
 use url::Url;
 
+/// Gathers the outcome for each of the `identities` of a batch request from
+/// the lines of its response. A line that cannot be read only fails the
+/// identity it was for: once the response ends, each identity that the
+/// response did not account for is given an error.
+async fn gather_batch<T>(
+    identities: &[Did],
+    mut lines: BoxStream<'static, Result<BatchResult<T>>>,
+    outcomes: &mut Vec<(Did, Result<T>)>,
+) {
+    let mut unanswered = BTreeMap::<&Did, usize>::new();
+    for identity in identities {
+        *unanswered.entry(identity).or_default() += 1;
+    }
+    let mut last_error = None;
+
+    while let Some(line) = lines.next().await {
+        match line {
+            Ok(BatchResult { identity, result }) => {
+                if let Some(count) = unanswered.get_mut(&identity) {
+                    *count = count.saturating_sub(1);
+                }
+                outcomes.push((identity, result.map_err(|error| anyhow!(error))));
+            }
+            Err(error) => {
+                warn!("Could not read a line of a batch response: {}", error);
+                last_error = Some(error.to_string());
+            }
+        }
+    }
+
+    for identity in identities {
+        match unanswered.get_mut(identity) {
+            Some(count) if *count > 0 => {
+                *count -= 1;
+                outcomes.push((
+                    identity.clone(),
+                    Err(match &last_error {
+                        Some(error) => anyhow!("No outcome was received: {}", error),
+                        None => anyhow!("No outcome was received"),
+                    }),
+                ));
+            }
+            _ => (),
+        }
+    }
+}
+
 #[derive(Clone)]
 pub struct HttpClient {
     api_base: Url,
@@ -26,6 +80,50 @@ impl HttpClient {
             peer_id,
         })
     }
+
+    /// Resolves up to [MAX_BATCH_SIZE] identities in a single request,
+    /// yielding each [BatchResolution] as soon as the server streams it back.
+    pub async fn resolve_records(
+        &self,
+        identities: &[Did],
+        parallelism: usize,
+    ) -> Result<BoxStream<'static, Result<BatchResolution>>> {
+        let mut url = self.api_base.clone();
+        url.set_path(&Route::ResolveRecords.to_string());
+        url.set_query(Some(&format!("parallelism={parallelism}")));
+        self.post_batch(url, identities).await
+    }
+
+    /// Publishes up to [MAX_BATCH_SIZE] records in a single request,
+    /// yielding each [BatchPublication] as soon as the server streams it back.
+    pub async fn publish_records(
+        &self,
+        records: &[LinkRecord],
+        quorum: usize,
+        parallelism: usize,
+    ) -> Result<BoxStream<'static, Result<BatchPublication>>> {
+        let mut url = self.api_base.clone();
+        url.set_path(&Route::PublishRecords.to_string());
+        url.set_query(Some(&format!("quorum={quorum}&parallelism={parallelism}")));
+        self.post_batch(url, records).await
+    }
+
+    async fn post_batch<B, T>(&self, url: Url, batch: &B) -> Result<BoxStream<'static, Result<T>>>
+    where
+        B: serde::Serialize + ?Sized,
+        T: serde::de::DeserializeOwned + Send + 'static,
+    {
+        let json_data = serde_json::to_string(batch)?;
+        let response = self
+            .client
+            .post(url)
+            .header("Content-Type", "application/json")
+            .body(Body::from(json_data))
+            .send()
+            .await?
+            .error_for_status()?;
+        Ok(from_ndjson_stream(response.bytes_stream()))
+    }
 }
 
 #[async_trait]
@@ -97,6 +195,10 @@ impl DhtClient for HttpClient {
     }
 
     async fn get_record(&self, identity: &Did) -> Result<Option<LinkRecord>> {
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("get_record");
         let mut url = self.api_base.clone();
         let path = Route::GetRecord
             .to_string()
@@ -106,6 +208,10 @@ impl DhtClient for HttpClient {
     }
 
     async fn put_record(&self, record: LinkRecord, quorum: usize) -> Result<()> {
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("put_record");
         let mut url = self.api_base.clone();
         url.set_path(&Route::PostRecord.to_string());
         url.set_query(Some(&format!("quorum={quorum}")));
@@ -122,6 +228,47 @@ impl DhtClient for HttpClient {
             .await?;
         Ok(res)
     }
+
+    async fn put_records(
+        &self,
+        records: Vec<LinkRecord>,
+        quorum: usize,
+    ) -> Result<Vec<(Did, Result<()>)>> {
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("put_records");
+        let mut outcomes = Vec::with_capacity(records.len());
+        for batch in records.chunks(MAX_BATCH_SIZE) {
+            let identities: Vec<Did> = batch
+                .iter()
+                .map(|record| record.to_sphere_identity())
+                .collect();
+            let publications = self
+                .publish_records(batch, quorum, DEFAULT_BATCH_PARALLELISM)
+                .await?;
+            gather_batch(&identities, publications, &mut outcomes).await;
+        }
+        Ok(outcomes)
+    }
+
+    async fn get_records(
+        &self,
+        identities: Vec<Did>,
+    ) -> Result<Vec<(Did, Result<Option<LinkRecord>>)>> {
+        let _timer = metrics()
+            .name_system
+            .query_duration
+            .start_timer("get_records");
+        let mut outcomes = Vec::with_capacity(identities.len());
+        for batch in identities.chunks(MAX_BATCH_SIZE) {
+            let resolutions = self
+                .resolve_records(batch, DEFAULT_BATCH_PARALLELISM)
+                .await?;
+            gather_batch(batch, resolutions, &mut outcomes).await;
+        }
+        Ok(outcomes)
+    }
 }
 
 #[cfg(test)]
@@ -195,4 +342,29 @@ mod test {
     }
 
     dht_client_tests!(HttpClient, before_each, DataPlaceholder);
+
+    #[tokio::test]
+    async fn it_fails_only_the_entries_whose_lines_are_malformed() -> Result<()> {
+        let identities = vec![Did::from("did:key:a"), Did::from("did:key:b")];
+        let response = [
+            crate::server::batch::to_ndjson_line(&BatchPublication {
+                identity: Did::from("did:key:a"),
+                result: Ok(()),
+            })?,
+            bytes::Bytes::from_static(b"{\"identity\": \"did:key:b\", \"res\n"),
+        ];
+        let lines = from_ndjson_stream(futures::stream::iter(
+            response.into_iter().map(Ok::<_, anyhow::Error>),
+        ));
+
+        let mut outcomes = Vec::new();
+        gather_batch(&identities, lines, &mut outcomes).await;
+
+        assert_eq!(outcomes.len(), 2);
+        assert_eq!(outcomes[0].0, Did::from("did:key:a"));
+        assert!(outcomes[0].1.is_ok());
+        assert_eq!(outcomes[1].0, Did::from("did:key:b"));
+        assert!(outcomes[1].1.is_err());
+        Ok(())
+    }
 }
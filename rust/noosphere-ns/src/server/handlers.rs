@@ -1,11 +1,21 @@
-use crate::{DhtClient, Multiaddr, NameSystem, NetworkInfo, Peer, PeerId};
+use crate::{
+    server::batch::{
+        to_ndjson_line, BatchPublication, BatchQuery, BatchResolution, MAX_BATCH_PARALLELISM,
+        MAX_BATCH_SIZE, NDJSON_CONTENT_TYPE,
+    },
+    CachingNameResolver, DhtClient, Multiaddr, NameResolver, NameSystem, NetworkInfo, Peer, PeerId,
+    DEFAULT_BATCH_PARALLELISM,
+};
 use anyhow::Result;
 use axum::{
+    body::Body,
     extract::{Path, Query, State},
-    http::StatusCode,
+    http::{header, StatusCode},
     response::{IntoResponse, Response},
     Json,
 };
+use futures::{stream, StreamExt};
+use noosphere_common::metrics::{metrics, PROMETHEUS_CONTENT_TYPE};
 use noosphere_core::data::{Did, LinkRecord};
 use serde::Deserialize;
 use std::sync::Arc;
@@ -13,6 +23,7 @@ use std::sync::Arc;
 #[derive(Clone)]
 pub struct RouterState {
     pub ns: Arc<NameSystem>,
+    pub resolver: CachingNameResolver<NameSystem>,
     pub peer_id: PeerId,
 }
 
@@ -98,8 +109,8 @@ pub async fn get_record(
     Path(did): Path<Did>,
 ) -> JsonResponse<Option<LinkRecord>> {
     let record = state
-        .ns
-        .get_record(&did)
+        .resolver
+        .resolve(&did)
         .await
         .map_err(move |error| JsonErr(StatusCode::INTERNAL_SERVER_ERROR, error.to_string()))?;
     Ok(Json(record))
@@ -118,15 +129,113 @@ pub async fn post_record(
     let Query(query) = query.unwrap_or_default();
     state
         .ns
-        .put_record(record, query.quorum)
+        .put_record(record.clone(), query.quorum)
         .await
         .map_err(move |error| {
             warn!("Error: {}", error);
             JsonErr(StatusCode::INTERNAL_SERVER_ERROR, error.to_string())
         })?;
+    state.resolver.insert(record);
     Ok(Json(()))
 }
 
+fn batch_parallelism(query: &BatchQuery, batch_size: usize) -> Result<usize, JsonErr> {
+    if batch_size > MAX_BATCH_SIZE {
+        return Err(JsonErr(
+            StatusCode::PAYLOAD_TOO_LARGE,
+            format!("Batches may contain at most {MAX_BATCH_SIZE} entries"),
+        ));
+    }
+
+    Ok(query
+        .parallelism
+        .unwrap_or(DEFAULT_BATCH_PARALLELISM)
+        .clamp(1, MAX_BATCH_PARALLELISM))
+}
+
+fn ndjson_response<S>(lines: S) -> Response
+where
+    S: stream::Stream<Item = Result<bytes::Bytes, serde_json::Error>> + Send + 'static,
+{
+    (
+        [(header::CONTENT_TYPE, NDJSON_CONTENT_TYPE)],
+        Body::from_stream(lines),
+    )
+        .into_response()
+}
+
+/// Resolves many identities concurrently, streaming back one
+/// [BatchResolution] per line as each query completes.
+pub async fn resolve_records(
+    State(state): State<RouterState>,
+    query: Option<Query<BatchQuery>>,
+    Json(identities): Json<Vec<Did>>,
+) -> Result<Response, JsonErr> {
+    let Query(query) = query.unwrap_or_default();
+    let parallelism = batch_parallelism(&query, identities.len())?;
+    let resolver = state.resolver;
+
+    let lines = stream::iter(identities)
+        .map(move |identity| {
+            let resolver = resolver.clone();
+            async move {
+                let result = resolver
+                    .resolve(&identity)
+                    .await
+                    .map_err(|error| error.to_string());
+                BatchResolution { identity, result }
+            }
+        })
+        .buffer_unordered(parallelism)
+        .map(|resolution| to_ndjson_line(&resolution));
+
+    Ok(ndjson_response(lines))
+}
+
+/// Publishes many records concurrently, streaming back one
+/// [BatchPublication] per line as each record is stored.
+pub async fn publish_records(
+    State(state): State<RouterState>,
+    query: Option<Query<BatchQuery>>,
+    Json(records): Json<Vec<LinkRecord>>,
+) -> Result<Response, JsonErr> {
+    let Query(query) = query.unwrap_or_default();
+    let parallelism = batch_parallelism(&query, records.len())?;
+    let quorum = query.quorum.unwrap_or_default();
+    let RouterState { ns, resolver, .. } = state;
+
+    let lines = stream::iter(records)
+        .map(move |record| {
+            let ns = ns.clone();
+            let resolver = resolver.clone();
+            async move {
+                let identity = record.to_sphere_identity();
+                let result = match ns.put_record(record.clone(), quorum).await {
+                    Ok(_) => {
+                        resolver.insert(record);
+                        Ok(())
+                    }
+                    Err(error) => {
+                        warn!("Error: {}", error);
+                        Err(error.to_string())
+                    }
+                };
+                BatchPublication { identity, result }
+            }
+        })
+        .buffer_unordered(parallelism)
+        .map(|publication| to_ndjson_line(&publication));
+
+    Ok(ndjson_response(lines))
+}
+
+pub async fn get_metrics() -> impl IntoResponse {
+    (
+        [(header::CONTENT_TYPE, PROMETHEUS_CONTENT_TYPE)],
+        metrics().encode(),
+    )
+}
+
 pub async fn bootstrap(State(state): State<RouterState>) -> JsonResponse<()> {
     state
         .ns
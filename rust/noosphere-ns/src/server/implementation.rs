@@ -1,5 +1,5 @@
 use crate::server::{handlers, routes::Route};
-use crate::{DhtClient, NameSystem};
+use crate::{CachingNameResolver, DhtClient, NameSystem};
 use anyhow::Result;
 use axum::{
     routing::{delete, get, post},
@@ -12,11 +12,15 @@ use tower_http::trace::TraceLayer;
 #[cfg(feature = "observability")]
 use axum_tracing_opentelemetry::middleware::{OtelAxumLayer, OtelInResponseLayer};
 
+/// The path that Prometheus metrics are served from
+const METRICS_PATH: &str = "/metrics";
+
 pub async fn start_name_system_api_server(
     ns: Arc<NameSystem>,
     listener: TcpListener,
 ) -> Result<()> {
     let peer_id = ns.peer_id().to_owned();
+    let resolver = CachingNameResolver::new(ns.clone(), Default::default());
 
     let router = Router::new()
         .route(
@@ -34,7 +38,16 @@ pub async fn start_name_system_api_server(
         .route(&Route::Address.to_string(), get(handlers::get_address))
         .route(&Route::GetRecord.to_string(), get(handlers::get_record))
         .route(&Route::PostRecord.to_string(), post(handlers::post_record))
-        .route(&Route::Bootstrap.to_string(), post(handlers::bootstrap));
+        .route(
+            &Route::ResolveRecords.to_string(),
+            post(handlers::resolve_records),
+        )
+        .route(
+            &Route::PublishRecords.to_string(),
+            post(handlers::publish_records),
+        )
+        .route(&Route::Bootstrap.to_string(), post(handlers::bootstrap))
+        .route(METRICS_PATH, get(handlers::get_metrics));
 
     #[cfg(feature = "observability")]
     let router = {
@@ -45,7 +58,11 @@ pub async fn start_name_system_api_server(
 
     let router = router
         .layer(TraceLayer::new_for_http())
-        .with_state(handlers::RouterState { ns, peer_id });
+        .with_state(handlers::RouterState {
+            ns,
+            resolver,
+            peer_id,
+        });
 
     // Listener must be set to nonblocking
     // https://docs.rs/tokio/latest/tokio/net/struct.TcpListener.html#method.from_std
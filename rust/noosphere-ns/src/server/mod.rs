@@ -1,7 +1,9 @@
+mod batch;
 mod client;
 mod handlers;
 mod implementation;
 mod routes;
 
+pub use batch::*;
 pub use client::HttpClient;
 pub use implementation::{start_name_system_api_server, ApiServer};
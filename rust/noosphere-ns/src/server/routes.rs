@@ -15,6 +15,8 @@ pub enum Route {
 
     GetRecord,
     PostRecord,
+    ResolveRecords,
+    PublishRecords,
 
     Bootstrap,
 }
@@ -34,6 +36,8 @@ impl Display for Route {
 
             Route::GetRecord => "records/:identity",
             Route::PostRecord => "records",
+            Route::ResolveRecords => "records/resolve",
+            Route::PublishRecords => "records/publish",
 
             Route::Bootstrap => "bootstrap",
         };
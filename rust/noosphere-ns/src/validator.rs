@@ -22,7 +22,7 @@ impl<S> Validator for RecordValidator<S>
 where
     S: UcanStore,
 {
-    async fn validate(&mut self, record_value: &[u8]) -> bool {
+    async fn validate(&self, record_value: &[u8]) -> bool {
         match LinkRecord::try_from(record_value) {
             Ok(record) => record.validate(&self.store).await.is_ok(),
             _ => false,
@@ -8,6 +8,11 @@
 //! `cargo run --example bench --features rocksdb`
 //! Run IndexedDb (open `http://localhost:8000` in a browser)
 //! `NO_HEADLESS=1 cargo run --example bench --target wasm32-unknown-unknown`
+//!
+//! Latencies are reported as percentiles alongside throughput, both overall
+//! and per store. On native targets, pass `--json <path>` to also write the
+//! results as JSON for comparison across runs and storage providers:
+//! `cargo run --example bench -- --json bench.json`
 
 extern crate noosphere_core_dev as noosphere_core;
 
@@ -22,8 +27,9 @@ use noosphere_core::{
     tracing::initialize_tracing,
 };
 use noosphere_storage::{SphereDb, Storage};
-use performance::{PerformanceStats, PerformanceStorage};
+use performance::{PerformanceAnalysis, PerformanceStats, PerformanceStorage};
 use rand::Rng;
+use serde::Serialize;
 use tokio::io::AsyncReadExt;
 
 #[cfg(target_arch = "wasm32")]
@@ -195,23 +201,27 @@ impl BenchmarkStorage {
     }
 }
 
-async fn log_perf_stats(stats: &PerformanceStats) {
-    output!("reads: {} (avg {}us)", stats.reads.count, stats.reads.mean);
-    output!(
-        "writes: {} (avg {}us)",
-        stats.writes.count,
-        stats.writes.mean
-    );
-    output!(
-        "removes: {} (avg {}us)",
-        stats.removes.count,
-        stats.removes.mean
-    );
+fn log_analysis(label: &str, analysis: &PerformanceAnalysis) {
     output!(
-        "flushes: {} (avg {}us)",
-        stats.flushes.count,
-        stats.flushes.mean
+        "{}: {} (avg {:.1}us, p50 {}us, p90 {}us, p99 {}us, p999 {}us, max {}us; {:.0} ops/s, {:.0} bytes/s)",
+        label,
+        analysis.count,
+        analysis.mean,
+        analysis.p50,
+        analysis.p90,
+        analysis.p99,
+        analysis.p999,
+        analysis.max,
+        analysis.ops_per_sec,
+        analysis.bytes_per_sec
     );
+}
+
+async fn log_perf_stats(stats: &PerformanceStats) {
+    log_analysis("reads", &stats.reads);
+    log_analysis("writes", &stats.writes);
+    log_analysis("removes", &stats.removes);
+    log_analysis("flushes", &stats.flushes);
     output!("logical bytes: {}", stats.logical_bytes_stored);
     output!("physical bytes: {}", stats.physical_bytes_stored);
 
@@ -221,9 +231,26 @@ async fn log_perf_stats(stats: &PerformanceStats) {
         stats.physical_bytes_stored as f64 / stats.logical_bytes_stored as f64
     };
     output!("space amplification: {}", space_amplification);
+
+    for (name, store_stats) in stats.stores.iter() {
+        output!("store '{}':", name);
+        log_analysis("  reads", &store_stats.reads);
+        log_analysis("  writes", &store_stats.writes);
+        log_analysis("  removes", &store_stats.removes);
+        log_analysis("  flushes", &store_stats.flushes);
+    }
 }
 
-async fn bench_sphere_writing_long_history() {
+/// The outcome of one benchmark run, in a form that is suitable for
+/// serializing as JSON (see `--json` above)
+#[derive(Serialize)]
+struct BenchmarkReport {
+    benchmark: String,
+    storage: String,
+    stats: PerformanceStats,
+}
+
+async fn bench_sphere_writing_long_history() -> BenchmarkReport {
     let mut storage = BenchmarkStorage::new().await.unwrap();
     output!("Testing {}", storage.name);
 
@@ -231,10 +258,17 @@ async fn bench_sphere_writing_long_history() {
     create_sphere_with_long_history(db).await.unwrap();
     let stats = storage.as_stats().await.unwrap();
     log_perf_stats(&stats).await;
+
+    let report = BenchmarkReport {
+        benchmark: "sphere_writing_long_history".into(),
+        storage: storage.name.clone(),
+        stats,
+    };
     storage.dispose().await.unwrap();
+    report
 }
 
-async fn bench_sphere_writing_large_files() {
+async fn bench_sphere_writing_large_files() -> BenchmarkReport {
     let mut storage = BenchmarkStorage::new().await.unwrap();
     output!("Testing {}", storage.name);
 
@@ -242,7 +276,14 @@ async fn bench_sphere_writing_large_files() {
     create_sphere_with_large_files(db).await.unwrap();
     let stats = storage.as_stats().await.unwrap();
     log_perf_stats(&stats).await;
+
+    let report = BenchmarkReport {
+        benchmark: "sphere_writing_large_files".into(),
+        storage: storage.name.clone(),
+        stats,
+    };
     storage.dispose().await.unwrap();
+    report
 }
 
 #[cfg(target_arch = "wasm32")]
@@ -258,8 +299,12 @@ pub fn main() {}
 async fn main_js() {
     initialize_tracing(None);
 
-    bench_sphere_writing_long_history().await;
-    bench_sphere_writing_large_files().await;
+    let reports = vec![
+        bench_sphere_writing_long_history().await,
+        bench_sphere_writing_large_files().await,
+    ];
+
+    output!("{}", serde_json::to_string(&reports).unwrap());
 }
 
 #[cfg(not(target_arch = "wasm32"))]
@@ -267,6 +312,16 @@ async fn main_js() {
 pub async fn main() {
     initialize_tracing(None);
 
-    bench_sphere_writing_long_history().await;
-    bench_sphere_writing_large_files().await;
+    let json_output_path = std::env::args().skip_while(|arg| arg != "--json").nth(1);
+
+    let reports = vec![
+        bench_sphere_writing_long_history().await,
+        bench_sphere_writing_large_files().await,
+    ];
+
+    if let Some(path) = json_output_path {
+        let json = serde_json::to_string_pretty(&reports).unwrap();
+        std::fs::write(&path, json).unwrap();
+        output!("Wrote JSON report to {}", path);
+    }
 }
@@ -1,11 +1,23 @@
-use anyhow::{Error, Result};
+use anyhow::Result;
 use async_trait::async_trait;
+use hdrhistogram::Histogram;
 use instant::{Duration, Instant};
 use noosphere_storage::{Space, Storage, Store};
-use std::{collections::HashMap, sync::Arc};
+use serde::Serialize;
+use std::{
+    collections::{BTreeMap, HashMap},
+    sync::Arc,
+};
 use tokio::sync::Mutex;
 
-#[derive(Debug, Clone, Default)]
+/// The highest latency that can be recorded, in microseconds; slower
+/// operations are clamped to this value
+const MAX_TRACKABLE_LATENCY_US: u64 = 60 * 1_000_000;
+
+/// Number of significant decimal digits retained by each latency histogram
+const LATENCY_PRECISION: u8 = 3;
+
+#[derive(Debug, Clone, Default, Serialize)]
 pub struct PerformanceStats {
     pub reads: PerformanceAnalysis,
     pub writes: PerformanceAnalysis,
@@ -13,55 +25,139 @@ pub struct PerformanceStats {
     pub flushes: PerformanceAnalysis,
     pub logical_bytes_stored: u64,
     pub physical_bytes_stored: u64,
+    /// The same analysis as above, broken down by the name of each store
+    /// (e.g., `blocks`, `links`, `versions`, `metadata`)
+    pub stores: BTreeMap<String, StorePerformanceStats>,
 }
 
-#[derive(Debug, Clone, Default)]
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct StorePerformanceStats {
+    pub reads: PerformanceAnalysis,
+    pub writes: PerformanceAnalysis,
+    pub removes: PerformanceAnalysis,
+    pub flushes: PerformanceAnalysis,
+    pub logical_bytes_stored: u64,
+}
+
+/// A summary of the latencies of one kind of operation. Latencies are in
+/// microseconds. Throughput is relative to the time spent inside of the
+/// operation, so it is independent of any overhead in the calling code.
+#[derive(Debug, Clone, Default, Serialize)]
 pub struct PerformanceAnalysis {
+    pub count: u64,
     pub mean: f64,
-    pub count: usize,
-}
-
-impl TryFrom<Vec<Duration>> for PerformanceAnalysis {
-    type Error = Error;
-    fn try_from(value: Vec<Duration>) -> Result<Self> {
-        let mut durations_us: Vec<_> = value
-            .into_iter()
-            .map(|d| TryInto::<u32>::try_into(d.as_micros()))
-            .collect::<Result<Vec<u32>, std::num::TryFromIntError>>()?;
-        durations_us.sort();
-        let count = durations_us.len();
-        let mean = if count == 0 {
-            0.0
+    pub p50: u64,
+    pub p90: u64,
+    pub p99: u64,
+    pub p999: u64,
+    pub max: u64,
+    pub bytes: u64,
+    pub ops_per_sec: f64,
+    pub bytes_per_sec: f64,
+}
+
+impl From<&OperationRecorder> for PerformanceAnalysis {
+    fn from(value: &OperationRecorder) -> Self {
+        let histogram = &value.latencies;
+        let count = histogram.len();
+
+        if count == 0 {
+            return PerformanceAnalysis::default();
+        }
+
+        let busy_seconds = value.busy.as_secs_f64();
+        let (ops_per_sec, bytes_per_sec) = if busy_seconds > 0.0 {
+            (
+                count as f64 / busy_seconds,
+                value.bytes as f64 / busy_seconds,
+            )
         } else {
-            durations_us.iter().sum::<u32>() as f64 / count as f64
+            (0.0, 0.0)
         };
-        Ok(Self { count, mean })
+
+        PerformanceAnalysis {
+            count,
+            mean: histogram.mean(),
+            p50: histogram.value_at_quantile(0.5),
+            p90: histogram.value_at_quantile(0.9),
+            p99: histogram.value_at_quantile(0.99),
+            p999: histogram.value_at_quantile(0.999),
+            max: histogram.max(),
+            bytes: value.bytes,
+            ops_per_sec,
+            bytes_per_sec,
+        }
     }
 }
 
-impl TryFrom<InternalStoreStats> for PerformanceStats {
-    type Error = Error;
-    fn try_from(value: InternalStoreStats) -> Result<Self> {
-        Ok(PerformanceStats {
-            reads: value.reads.try_into()?,
-            writes: value.writes.try_into()?,
-            removes: value.removes.try_into()?,
-            flushes: value.flushes.try_into()?,
-            logical_bytes_stored: value.logical_bytes_stored,
-            ..Default::default()
-        })
+/// Records the latencies of one kind of operation into a fixed-size
+/// histogram, so that memory usage stays constant over long runs
+#[derive(Debug, Clone)]
+struct OperationRecorder {
+    latencies: Histogram<u64>,
+    busy: Duration,
+    bytes: u64,
+}
+
+impl Default for OperationRecorder {
+    fn default() -> Self {
+        OperationRecorder {
+            latencies: Histogram::new_with_bounds(1, MAX_TRACKABLE_LATENCY_US, LATENCY_PRECISION)
+                .expect("Histogram bounds are valid"),
+            busy: Duration::ZERO,
+            bytes: 0,
+        }
+    }
+}
+
+impl OperationRecorder {
+    fn record(&mut self, duration: Duration, bytes: usize) {
+        let micros = u64::try_from(duration.as_micros()).unwrap_or(u64::MAX);
+        self.latencies.saturating_record(micros.max(1));
+        self.busy += duration;
+        self.bytes += bytes as u64;
+    }
+
+    fn merge(&mut self, other: &OperationRecorder) -> Result<()> {
+        self.latencies.add(&other.latencies)?;
+        self.busy += other.busy;
+        self.bytes += other.bytes;
+        Ok(())
     }
 }
 
 #[derive(Debug, Default)]
 struct InternalStoreStats {
-    pub reads: Vec<Duration>,
-    pub writes: Vec<Duration>,
-    pub removes: Vec<Duration>,
-    pub flushes: Vec<Duration>,
+    pub reads: OperationRecorder,
+    pub writes: OperationRecorder,
+    pub removes: OperationRecorder,
+    pub flushes: OperationRecorder,
     pub logical_bytes_stored: u64,
 }
 
+impl InternalStoreStats {
+    /// Clear the recorded operations, retaining the running total of logical
+    /// bytes stored
+    fn reset_operations(&mut self) {
+        self.reads = OperationRecorder::default();
+        self.writes = OperationRecorder::default();
+        self.removes = OperationRecorder::default();
+        self.flushes = OperationRecorder::default();
+    }
+}
+
+impl From<&InternalStoreStats> for StorePerformanceStats {
+    fn from(value: &InternalStoreStats) -> Self {
+        StorePerformanceStats {
+            reads: (&value.reads).into(),
+            writes: (&value.writes).into(),
+            removes: (&value.removes).into(),
+            flushes: (&value.flushes).into(),
+            logical_bytes_stored: value.logical_bytes_stored,
+        }
+    }
+}
+
 /// A wrapper for [Storage] types that tracks performance
 /// of various operations.
 /// If [Storage] is also [Space], [PerformanceStorage::as_stats] can be
@@ -114,19 +210,29 @@ where
     pub async fn as_stats(&mut self) -> Result<PerformanceStats> {
         let storage_stats = self.stats.lock().await;
         let mut agg = InternalStoreStats::default();
-        for (_, store_stats) in storage_stats.iter() {
+        let mut stores = BTreeMap::new();
+
+        for (name, store_stats) in storage_stats.iter() {
             let mut stats = store_stats.lock().await;
-            agg.reads.append(&mut stats.reads);
-            agg.writes.append(&mut stats.writes);
-            agg.removes.append(&mut stats.removes);
-            agg.flushes.append(&mut stats.flushes);
+            agg.reads.merge(&stats.reads)?;
+            agg.writes.merge(&stats.writes)?;
+            agg.removes.merge(&stats.removes)?;
+            agg.flushes.merge(&stats.flushes)?;
             agg.logical_bytes_stored += stats.logical_bytes_stored;
-        }
 
-        let mut perf_stats: PerformanceStats = agg.try_into()?;
-        perf_stats.physical_bytes_stored = self.storage.get_space_usage().await?;
+            stores.insert(name.to_owned(), StorePerformanceStats::from(&*stats));
+            stats.reset_operations();
+        }
 
-        Ok(perf_stats)
+        Ok(PerformanceStats {
+            reads: (&agg.reads).into(),
+            writes: (&agg.writes).into(),
+            removes: (&agg.removes).into(),
+            flushes: (&agg.flushes).into(),
+            logical_bytes_stored: agg.logical_bytes_stored,
+            physical_bytes_stored: self.storage.get_space_usage().await?,
+            stores,
+        })
     }
 }
 
@@ -171,7 +277,10 @@ impl<S: Store> Store for PerformanceStore<S> {
         let duration = start.elapsed();
 
         let mut stats = self.stats.lock().await;
-        stats.reads.push(duration);
+        stats.reads.record(
+            duration,
+            value.as_ref().map(|bytes| bytes.len()).unwrap_or(0),
+        );
         Ok(value)
     }
 
@@ -181,7 +290,7 @@ impl<S: Store> Store for PerformanceStore<S> {
         let duration = start.elapsed();
 
         let mut stats = self.stats.lock().await;
-        stats.writes.push(duration);
+        stats.writes.record(duration, bytes.len());
         stats.logical_bytes_stored += bytes.len() as u64;
         result
     }
@@ -195,7 +304,7 @@ impl<S: Store> Store for PerformanceStore<S> {
         if let Some(bytes) = &value {
             stats.logical_bytes_stored -= bytes.len() as u64;
         }
-        stats.removes.push(duration);
+        stats.removes.record(duration, 0);
         Ok(value)
     }
 
@@ -204,7 +313,7 @@ impl<S: Store> Store for PerformanceStore<S> {
         let result = self.store.flush().await;
         let duration = start.elapsed();
         let mut stats = self.stats.lock().await;
-        stats.flushes.push(duration);
+        stats.flushes.record(duration, 0);
         result
     }
 }
@@ -14,7 +14,7 @@ use libipld_core::{
     codec::{Codec, Decode, Encode},
     ipld::Ipld,
 };
-use noosphere_common::{ConditionalSend, ConditionalSync};
+use noosphere_common::{synchronous_section, ConditionalSend, ConditionalSync};
 use serde::{de::DeserializeOwned, Serialize};
 
 #[cfg(doc)]
@@ -79,7 +79,10 @@ pub trait BlockStore: Clone + ConditionalSync {
         let block = self.get_block(cid).await?;
 
         Ok(match block {
-            Some(bytes) => Some(T::decode(codec, &mut Cursor::new(bytes))?),
+            Some(bytes) => {
+                let _section = synchronous_section("block_decode");
+                Some(T::decode(codec, &mut Cursor::new(bytes))?)
+            }
             None => None,
         })
     }
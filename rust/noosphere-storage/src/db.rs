@@ -7,7 +7,7 @@ use libipld_core::{
     ipld::Ipld,
     raw::RawCodec,
 };
-use noosphere_common::ConditionalSend;
+use noosphere_common::{metrics::metrics, ConditionalSend};
 use noosphere_ucan::store::UcanStore;
 use serde::{de::DeserializeOwned, Serialize};
 use std::future::Future;
@@ -36,6 +36,7 @@ pub struct SphereDb<S>
 where
     S: Storage,
 {
+    storage: S,
     block_store: S::BlockStore,
     link_store: S::KeyValueStore,
     version_store: S::KeyValueStore,
@@ -48,6 +49,7 @@ where
 {
     pub async fn new(storage: &S) -> Result<SphereDb<S>> {
         Ok(SphereDb {
+            storage: storage.clone(),
             block_store: storage.get_block_store(BLOCK_STORE).await?,
             link_store: storage.get_key_value_store(LINK_STORE).await?,
             version_store: storage.get_key_value_store(VERSION_STORE).await?,
@@ -55,6 +57,12 @@ where
         })
     }
 
+    /// The [Storage] that backs this [SphereDb], for example to get its
+    /// [crate::StorageStats] when it implements [crate::Space]
+    pub fn storage(&self) -> &S {
+        &self.storage
+    }
+
     /// Given a [MemoryStore], store copies of all the blocks found within in
     /// the storage that backs this [SphereDb].
     pub async fn persist(&mut self, memory_store: &MemoryStore) -> Result<()> {
@@ -90,6 +98,7 @@ where
 
     /// Manually flush all pending writes to the underlying [Storage]
     pub async fn flush(&self) -> Result<()> {
+        let _timer = metrics().storage.operation_duration.start_timer("flush");
         let (block_store_result, link_store_result, version_store_result, metadata_store_result) = tokio::join!(
             self.block_store.flush(),
             self.link_store.flush(),
@@ -208,6 +217,10 @@ where
         C: Codec + Default,
         Ipld: References<C>,
     {
+        let _timer = metrics()
+            .storage
+            .operation_duration
+            .start_timer("put_links");
         let codec = C::default();
         let mut links = Vec::new();
 
@@ -219,11 +232,33 @@ where
     }
 
     async fn put_block(&mut self, cid: &cid::Cid, block: &[u8]) -> Result<()> {
-        self.block_store.put_block(cid, block).await
+        let storage_metrics = &metrics().storage;
+        let _timer = storage_metrics.operation_duration.start_timer("put_block");
+
+        self.block_store.put_block(cid, block).await?;
+
+        storage_metrics
+            .block_bytes
+            .get("written")
+            .inc_by(block.len() as u64);
+
+        Ok(())
     }
 
     async fn get_block(&self, cid: &cid::Cid) -> Result<Option<Vec<u8>>> {
-        self.block_store.get_block(cid).await
+        let storage_metrics = &metrics().storage;
+        let _timer = storage_metrics.operation_duration.start_timer("get_block");
+
+        let block = self.block_store.get_block(cid).await?;
+
+        if let Some(block) = &block {
+            storage_metrics
+                .block_bytes
+                .get("read")
+                .inc_by(block.len() as u64);
+        }
+
+        Ok(block)
     }
 }
 
@@ -238,6 +273,7 @@ where
         K: AsRef<[u8]> + ConditionalSend,
         V: Serialize + ConditionalSend,
     {
+        let _timer = metrics().storage.operation_duration.start_timer("set_key");
         self.metadata_store.set_key(key, value).await
     }
 
@@ -245,6 +281,10 @@ where
     where
         K: AsRef<[u8]> + ConditionalSend,
     {
+        let _timer = metrics()
+            .storage
+            .operation_duration
+            .start_timer("unset_key");
         self.metadata_store.unset_key(key).await
     }
 
@@ -253,6 +293,7 @@ where
         K: AsRef<[u8]> + ConditionalSend,
         V: DeserializeOwned + ConditionalSend,
     {
+        let _timer = metrics().storage.operation_duration.start_timer("get_key");
         self.metadata_store.get_key(key).await
     }
 }
@@ -131,18 +131,35 @@ impl Store for MemoryStore {
     }
 }
 
-#[cfg(feature = "performance")]
+#[cfg(any(test, feature = "helpers"))]
 #[cfg_attr(not(target_arch = "wasm32"), async_trait)]
 #[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
 impl crate::Space for MemoryStorage {
     async fn get_space_usage(&self) -> Result<u64> {
-        let mut size = 0;
-        for (_, store) in self.stores.lock().await.iter() {
-            for (key, entry) in store.entries.lock().await.iter() {
-                size += key.len() as u64;
-                size += entry.len() as u64;
-            }
+        Ok(self.get_storage_stats().await?.space_usage)
+    }
+
+    async fn get_storage_stats(&self) -> Result<crate::StorageStats> {
+        let mut stats = crate::StorageStats::default();
+
+        for (name, store) in self.stores.lock().await.iter() {
+            let entries = store.entries.lock().await;
+            let live_bytes = entries
+                .iter()
+                .map(|(key, entry)| (key.len() + entry.len()) as u64)
+                .sum::<u64>();
+
+            stats.space_usage += live_bytes;
+            stats.stores.insert(
+                name.clone(),
+                crate::StoreStats {
+                    live_bytes: Some(live_bytes),
+                    on_disk_bytes: Some(live_bytes),
+                    entries: Some(entries.len() as u64),
+                },
+            );
         }
-        Ok(size)
+
+        Ok(stats)
     }
 }
@@ -1,10 +1,11 @@
 use crate::{
-    storage::Storage, store::Store, ConfigurableStorage, StorageConfig, SPHERE_DB_STORE_NAMES,
+    storage::Storage, store::Store, ConfigurableStorage, StorageConfig, StorageStats, StoreStats,
+    SPHERE_DB_STORE_NAMES,
 };
 use anyhow::{anyhow, Result};
 use async_trait::async_trait;
 use noosphere_common::ConditionalSend;
-use rocksdb::{ColumnFamilyDescriptor, DBWithThreadMode, Options};
+use rocksdb::{properties, ColumnFamilyDescriptor, DBWithThreadMode, Options};
 use std::{
     path::{Path, PathBuf},
     sync::Arc,
@@ -92,6 +93,22 @@ impl RocksDbStorage {
 
         RocksDbStore::new(self.db.clone(), name.to_owned())
     }
+
+    /// Read an integer-valued RocksDB property of the column family backing
+    /// the store called `name`
+    fn property_of_store(
+        &self,
+        name: &str,
+        property: &properties::PropName,
+    ) -> Result<Option<u64>> {
+        let cf = self
+            .db
+            .cf_handle(name)
+            .ok_or_else(|| anyhow!("Could not open handle for {}", name))?;
+        #[cfg(feature = "rocksdb-multi-thread")]
+        let cf = &cf;
+        Ok(self.db.property_int_value_cf(cf, property)?)
+    }
 }
 
 #[async_trait]
@@ -185,7 +202,43 @@ impl Store for RocksDbStore {
 
 #[async_trait]
 impl crate::Space for RocksDbStorage {
+    /// The total size of the SST files of all stores, as tracked by RocksDB
+    /// (so, without walking the database directory). Write-ahead logs are
+    /// not included.
     async fn get_space_usage(&self) -> Result<u64> {
-        crate::get_dir_size(&self.debug_data.0).await
+        let mut space_usage = 0;
+
+        for name in SPHERE_DB_STORE_NAMES {
+            space_usage += self
+                .property_of_store(name, properties::TOTAL_SST_FILES_SIZE)?
+                .unwrap_or_default();
+        }
+
+        Ok(space_usage)
+    }
+
+    /// Stats are read from RocksDB's own properties, which are estimates that
+    /// are maintained as data is written and compacted
+    async fn get_storage_stats(&self) -> Result<StorageStats> {
+        let mut stats = StorageStats::default();
+        let mut pending_compaction_bytes = 0;
+
+        for name in SPHERE_DB_STORE_NAMES {
+            let store_stats = StoreStats {
+                live_bytes: self.property_of_store(name, properties::ESTIMATE_LIVE_DATA_SIZE)?,
+                on_disk_bytes: self.property_of_store(name, properties::TOTAL_SST_FILES_SIZE)?,
+                entries: self.property_of_store(name, properties::ESTIMATE_NUM_KEYS)?,
+            };
+
+            stats.space_usage += store_stats.on_disk_bytes.unwrap_or_default();
+            pending_compaction_bytes += self
+                .property_of_store(name, properties::ESTIMATE_PENDING_COMPACTION_BYTES)?
+                .unwrap_or_default();
+            stats.stores.insert(name.to_string(), store_stats);
+        }
+
+        stats.pending_compaction_bytes = Some(pending_compaction_bytes);
+
+        Ok(stats)
     }
 }
@@ -12,6 +12,7 @@ mod db;
 mod encoding;
 mod implementation;
 mod key_value;
+mod meter;
 mod retry;
 mod storage;
 mod store;
@@ -25,6 +26,7 @@ pub use db::*;
 pub use encoding::*;
 pub use implementation::*;
 pub use key_value::*;
+pub use meter::*;
 pub use retry::*;
 pub use storage::*;
 pub use store::*;
@@ -0,0 +1,504 @@
+use crate::{BlockStore, Space, Storage, StorageStats};
+use anyhow::Result;
+use async_trait::async_trait;
+use cid::Cid;
+use libipld_core::{
+    codec::{Codec, References},
+    ipld::Ipld,
+};
+use noosphere_common::metrics::{metrics, IO_OPERATIONS, OTHER_LABEL_VALUE};
+use std::{
+    collections::BTreeMap,
+    future::Future,
+    pin::Pin,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc,
+    },
+    task::{Context, Poll},
+};
+use tokio_stream::Stream;
+
+#[cfg(doc)]
+use crate::TrackingStore;
+
+/// The logical operations that a [BlockStoreMeter] attributes I/O to by
+/// default; these are also the operations that I/O is reported by in
+/// [noosphere_common::metrics::StorageMetrics]
+pub const DEFAULT_IO_OPERATIONS: &[&str] = IO_OPERATIONS;
+
+/// The operation that I/O is attributed to when it does not happen within a
+/// known operation
+pub const UNATTRIBUTED_IO_OPERATION: &str = OTHER_LABEL_VALUE;
+
+tokio::task_local! {
+    static IO_OPERATION: &'static str;
+}
+
+/// Run `future`, attributing any block I/O that a [BlockStoreMeter] sees
+/// while it is polled to `operation`. Nested calls take precedence over outer
+/// ones. The tag is carried by the task (so it does not depend on how
+/// `tracing` is configured), and is not inherited by tasks that `future`
+/// spawns.
+pub async fn with_io_operation<F>(operation: &'static str, future: F) -> F::Output
+where
+    F: Future,
+{
+    IO_OPERATION.scope(operation, future).await
+}
+
+/// The same as [with_io_operation], but for a [Stream] whose items are
+/// produced lazily (e.g., one that is handed off as a response body and
+/// polled long after the call that created it has returned).
+pub fn stream_with_io_operation<S>(operation: &'static str, stream: S) -> IoOperationStream<S>
+where
+    S: Stream,
+{
+    IoOperationStream {
+        operation,
+        stream: Box::pin(stream),
+    }
+}
+
+/// A [Stream] that attributes the block I/O made while it is polled to an
+/// operation; see [stream_with_io_operation]
+pub struct IoOperationStream<S>
+where
+    S: Stream,
+{
+    operation: &'static str,
+    stream: Pin<Box<S>>,
+}
+
+impl<S> Stream for IoOperationStream<S>
+where
+    S: Stream,
+{
+    type Item = S::Item;
+
+    fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let operation = self.operation;
+        let stream = self.stream.as_mut();
+
+        IO_OPERATION.sync_scope(operation, || stream.poll_next(cx))
+    }
+}
+
+/// A point-in-time snapshot of the block I/O attributed to one operation
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct IoStats {
+    /// Calls to [BlockStore::get_block]
+    pub reads: u64,
+    /// Reads that did not find a block
+    pub misses: u64,
+    /// Total size of the blocks that were found
+    pub bytes_read: u64,
+    /// Calls to [BlockStore::put_block]
+    pub writes: u64,
+    /// Total size of the blocks that were written
+    pub bytes_written: u64,
+}
+
+#[derive(Debug, Default)]
+struct IoCounters {
+    reads: AtomicU64,
+    misses: AtomicU64,
+    bytes_read: AtomicU64,
+    writes: AtomicU64,
+    bytes_written: AtomicU64,
+}
+
+impl IoCounters {
+    fn snapshot(&self) -> IoStats {
+        IoStats {
+            reads: self.reads.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            bytes_read: self.bytes_read.load(Ordering::Relaxed),
+            writes: self.writes.load(Ordering::Relaxed),
+            bytes_written: self.bytes_written.load(Ordering::Relaxed),
+        }
+    }
+
+    fn reset(&self) {
+        for counter in [
+            &self.reads,
+            &self.misses,
+            &self.bytes_read,
+            &self.writes,
+            &self.bytes_written,
+        ] {
+            counter.store(0, Ordering::Relaxed);
+        }
+    }
+}
+
+/// Shared, lock-free I/O counters for a set of logical operations. An
+/// [IoMeter] is cheap to clone, and clones count into the same totals.
+///
+/// I/O is attributed to the operation that it was tagged with via
+/// [with_io_operation] (or [stream_with_io_operation]); untagged I/O, or I/O
+/// tagged with an operation that the meter does not know, is attributed to
+/// [UNATTRIBUTED_IO_OPERATION].
+#[derive(Clone, Debug)]
+pub struct IoMeter {
+    operations: &'static [&'static str],
+    // The last set of counters is for unattributed I/O
+    counters: Arc<[IoCounters]>,
+}
+
+impl Default for IoMeter {
+    fn default() -> Self {
+        IoMeter::new(DEFAULT_IO_OPERATIONS)
+    }
+}
+
+impl IoMeter {
+    /// Create an [IoMeter] that attributes I/O to the given `operations`
+    pub fn new(operations: &'static [&'static str]) -> Self {
+        IoMeter {
+            operations,
+            counters: (0..=operations.len())
+                .map(|_| IoCounters::default())
+                .collect(),
+        }
+    }
+
+    /// Get a snapshot of the I/O attributed to each operation so far
+    pub fn to_stats(&self) -> BTreeMap<&'static str, IoStats> {
+        self.operations
+            .iter()
+            .copied()
+            .chain(std::iter::once(UNATTRIBUTED_IO_OPERATION))
+            .zip(self.counters.iter().map(IoCounters::snapshot))
+            .collect()
+    }
+
+    /// Get the sum of the I/O attributed to all operations so far
+    pub fn to_total_stats(&self) -> IoStats {
+        self.counters
+            .iter()
+            .map(IoCounters::snapshot)
+            .fold(IoStats::default(), |total, stats| IoStats {
+                reads: total.reads + stats.reads,
+                misses: total.misses + stats.misses,
+                bytes_read: total.bytes_read + stats.bytes_read,
+                writes: total.writes + stats.writes,
+                bytes_written: total.bytes_written + stats.bytes_written,
+            })
+    }
+
+    /// Set all counters back to zero
+    pub fn reset(&self) {
+        for counters in self.counters.iter() {
+            counters.reset();
+        }
+    }
+
+    /// The name of the operation that I/O made right now is attributed to,
+    /// along with its counters
+    fn current_counters(&self) -> (&'static str, &IoCounters) {
+        let index = IO_OPERATION
+            .try_with(|tag| {
+                self.operations
+                    .iter()
+                    .position(|operation| operation == tag)
+            })
+            .ok()
+            .flatten();
+
+        match index {
+            Some(index) => (self.operations[index], &self.counters[index]),
+            None => (
+                UNATTRIBUTED_IO_OPERATION,
+                &self.counters[self.operations.len()],
+            ),
+        }
+    }
+}
+
+/// The label value that I/O attributed to `operation` is reported under in
+/// [noosphere_common::metrics::StorageMetrics]
+fn metrics_label(operation: &'static str) -> &'static str {
+    if IO_OPERATIONS.contains(&operation) {
+        operation
+    } else {
+        OTHER_LABEL_VALUE
+    }
+}
+
+/// Wraps any [BlockStore] and counts the blocks (and bytes) that are read from
+/// and written to it, attributing them to logical operations via an [IoMeter].
+/// The same counts are also recorded, by operation, in the process-wide
+/// [noosphere_common::metrics::StorageMetrics]. Unlike [TrackingStore],
+/// counting never takes a lock, so [BlockStoreMeter] is suitable for use in
+/// production to find out which code paths cause the most I/O.
+#[derive(Clone, Debug)]
+pub struct BlockStoreMeter<S>
+where
+    S: BlockStore,
+{
+    store: S,
+    meter: IoMeter,
+}
+
+impl<S> BlockStoreMeter<S>
+where
+    S: BlockStore,
+{
+    /// Wrap `store`, counting its I/O with `meter`
+    pub fn new(store: S, meter: IoMeter) -> Self {
+        BlockStoreMeter { store, meter }
+    }
+
+    /// The [IoMeter] that counts the I/O of this store
+    pub fn meter(&self) -> &IoMeter {
+        &self.meter
+    }
+}
+
+#[cfg_attr(not(target_arch = "wasm32"), async_trait)]
+#[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
+impl<S> BlockStore for BlockStoreMeter<S>
+where
+    S: BlockStore,
+{
+    async fn put_links<C>(&mut self, cid: &Cid, block: &[u8]) -> Result<()>
+    where
+        C: Codec + Default,
+        Ipld: References<C>,
+    {
+        self.store.put_links::<C>(cid, block).await
+    }
+
+    async fn put_block(&mut self, cid: &Cid, block: &[u8]) -> Result<()> {
+        let (operation, counters) = self.meter.current_counters();
+        let label = metrics_label(operation);
+        let storage_metrics = &metrics().storage;
+
+        self.store.put_block(cid, block).await?;
+
+        counters.writes.fetch_add(1, Ordering::Relaxed);
+        counters
+            .bytes_written
+            .fetch_add(block.len() as u64, Ordering::Relaxed);
+        storage_metrics.io_writes.get(label).inc();
+        storage_metrics
+            .io_bytes_written
+            .get(label)
+            .inc_by(block.len() as u64);
+
+        Ok(())
+    }
+
+    async fn get_block(&self, cid: &Cid) -> Result<Option<Vec<u8>>> {
+        let (operation, counters) = self.meter.current_counters();
+        let label = metrics_label(operation);
+        let storage_metrics = &metrics().storage;
+        let block = self.store.get_block(cid).await?;
+
+        counters.reads.fetch_add(1, Ordering::Relaxed);
+        storage_metrics.io_reads.get(label).inc();
+
+        match &block {
+            Some(bytes) => {
+                counters
+                    .bytes_read
+                    .fetch_add(bytes.len() as u64, Ordering::Relaxed);
+                storage_metrics
+                    .io_bytes_read
+                    .get(label)
+                    .inc_by(bytes.len() as u64);
+            }
+            None => {
+                counters.misses.fetch_add(1, Ordering::Relaxed);
+                storage_metrics.io_misses.get(label).inc();
+            }
+        };
+
+        Ok(block)
+    }
+
+    async fn flush(&self) -> Result<()> {
+        self.store.flush().await
+    }
+}
+
+/// A [Storage] whose block stores are all wrapped in a [BlockStoreMeter] that
+/// shares a single [IoMeter]. Key/value stores are not metered.
+#[derive(Clone, Debug)]
+pub struct MeteredStorage<S>
+where
+    S: Storage,
+{
+    storage: S,
+    meter: IoMeter,
+}
+
+impl<S> MeteredStorage<S>
+where
+    S: Storage,
+{
+    /// Wrap `storage`, counting the I/O of its block stores with `meter`
+    pub fn new(storage: S, meter: IoMeter) -> Self {
+        MeteredStorage { storage, meter }
+    }
+
+    /// The [IoMeter] that counts the I/O of this storage
+    pub fn meter(&self) -> &IoMeter {
+        &self.meter
+    }
+}
+
+#[cfg_attr(not(target_arch = "wasm32"), async_trait)]
+#[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
+impl<S> Storage for MeteredStorage<S>
+where
+    S: Storage,
+{
+    type BlockStore = BlockStoreMeter<S::BlockStore>;
+
+    type KeyValueStore = S::KeyValueStore;
+
+    async fn get_block_store(&self, name: &str) -> Result<Self::BlockStore> {
+        Ok(BlockStoreMeter::new(
+            self.storage.get_block_store(name).await?,
+            self.meter.clone(),
+        ))
+    }
+
+    async fn get_key_value_store(&self, name: &str) -> Result<Self::KeyValueStore> {
+        self.storage.get_key_value_store(name).await
+    }
+}
+
+#[cfg_attr(not(target_arch = "wasm32"), async_trait)]
+#[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
+impl<S> Space for MeteredStorage<S>
+where
+    S: Storage + Space,
+{
+    async fn get_space_usage(&self) -> Result<u64> {
+        self.storage.get_space_usage().await
+    }
+
+    async fn get_storage_stats(&self) -> Result<StorageStats> {
+        self.storage.get_storage_stats().await
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use anyhow::Result;
+    use async_trait::async_trait;
+    use cid::Cid;
+    use libipld_cbor::DagCborCodec;
+    use noosphere_common::metrics::metrics;
+    use tokio_stream::StreamExt;
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    use crate::{
+        stream_with_io_operation, with_io_operation, BlockStore, BlockStoreMeter, IoMeter,
+        MemoryStore, UNATTRIBUTED_IO_OPERATION,
+    };
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    /// A [BlockStore] that refuses every write
+    #[derive(Clone)]
+    struct ReadOnlyStore;
+
+    #[cfg_attr(not(target_arch = "wasm32"), async_trait)]
+    #[cfg_attr(target_arch = "wasm32", async_trait(?Send))]
+    impl BlockStore for ReadOnlyStore {
+        async fn put_block(&mut self, _cid: &Cid, _block: &[u8]) -> Result<()> {
+            Err(anyhow::anyhow!("Read-only"))
+        }
+
+        async fn get_block(&self, _cid: &Cid) -> Result<Option<Vec<u8>>> {
+            Ok(None)
+        }
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_attributes_io_to_the_innermost_operation() {
+        let mut store = BlockStoreMeter::new(MemoryStore::default(), IoMeter::default());
+        let reads_before = metrics().storage.io_reads.get("traverse").get();
+
+        let cid = store
+            .save::<DagCborCodec, _>(vec![1u8, 2, 3])
+            .await
+            .unwrap();
+        let missing_cid = MemoryStore::default()
+            .save::<DagCborCodec, _>(vec![4u8, 5, 6])
+            .await
+            .unwrap();
+
+        with_io_operation("render", async {
+            store.require_block(&cid).await.unwrap();
+            with_io_operation("hydrate", async {
+                store.require_block(&cid).await.unwrap();
+                store.get_block(&missing_cid).await.unwrap();
+            })
+            .await;
+        })
+        .await;
+
+        with_io_operation("traverse", store.require_block(&cid))
+            .await
+            .unwrap();
+        with_io_operation("unknown", store.require_block(&cid))
+            .await
+            .unwrap();
+
+        let reads = stream_with_io_operation(
+            "replicate",
+            tokio_stream::iter([cid, cid]).then(|cid| {
+                let store = store.clone();
+                async move { store.require_block(&cid).await }
+            }),
+        )
+        .collect::<Vec<_>>()
+        .await;
+
+        assert_eq!(reads.len(), 2);
+
+        let stats = store.meter().to_stats();
+        let block_size = store.require_block(&cid).await.unwrap().len() as u64;
+
+        assert_eq!(stats["render"].reads, 1);
+        assert_eq!(stats["render"].bytes_read, block_size);
+        assert_eq!(stats["hydrate"].reads, 2);
+        assert_eq!(stats["hydrate"].misses, 1);
+        assert_eq!(stats["hydrate"].bytes_read, block_size);
+        assert_eq!(stats["traverse"].reads, 1);
+        assert_eq!(stats["replicate"].reads, 2);
+        assert_eq!(stats[UNATTRIBUTED_IO_OPERATION].reads, 1);
+        assert_eq!(stats[UNATTRIBUTED_IO_OPERATION].writes, 1);
+        assert_eq!(stats[UNATTRIBUTED_IO_OPERATION].bytes_written, block_size);
+        assert_eq!(
+            metrics().storage.io_reads.get("traverse").get() - reads_before,
+            1
+        );
+
+        let total = store.meter().to_total_stats();
+
+        assert_eq!(total.reads, 8);
+        assert_eq!(total.writes, 1);
+    }
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_does_not_count_writes_that_fail() {
+        let mut store = BlockStoreMeter::new(ReadOnlyStore, IoMeter::default());
+
+        assert!(store.save::<DagCborCodec, _>(vec![1u8]).await.is_err());
+
+        let total = store.meter().to_total_stats();
+
+        assert_eq!(total.writes, 0);
+        assert_eq!(total.bytes_written, 0);
+    }
+}
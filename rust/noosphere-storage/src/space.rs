@@ -1,6 +1,109 @@
 use anyhow::Result;
 use async_trait::async_trait;
-use noosphere_common::ConditionalSend;
+use noosphere_common::{metrics::metrics, ConditionalSend};
+use serde::{Deserialize, Serialize};
+use std::collections::BTreeMap;
+
+use crate::{BLOCK_STORE, SPHERE_DB_STORE_NAMES};
+
+/// Space usage of a single named store (such as `blocks` or `links`). Values
+/// that a storage provider can not determine cheaply are `None`.
+#[derive(Debug, Clone, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub struct StoreStats {
+    /// Bytes of keys and values that are currently live in the store
+    pub live_bytes: Option<u64>,
+    /// Bytes that the store occupies on disk, including data that is no longer
+    /// live but has yet to be compacted away
+    pub on_disk_bytes: Option<u64>,
+    /// The number of entries in the store (this may be an estimate)
+    pub entries: Option<u64>,
+}
+
+/// A breakdown of the space used by a storage provider, suitable for exposing
+/// by gateways and the CLI (see [Space::get_storage_stats])
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct StorageStats {
+    /// The underlying (e.g. disk) space usage of the whole storage provider
+    pub space_usage: u64,
+    /// Stats for each store, by name
+    pub stores: BTreeMap<String, StoreStats>,
+    /// Bytes that are due to be rewritten by pending compactions, if the
+    /// storage provider compacts and reports it
+    pub pending_compaction_bytes: Option<u64>,
+}
+
+impl StorageStats {
+    /// The number of blocks in the block store, if known
+    pub fn block_count(&self) -> Option<u64> {
+        self.stores.get(BLOCK_STORE)?.entries
+    }
+
+    /// The mean size of the entries in the block store, if known
+    pub fn average_block_size(&self) -> Option<f64> {
+        let blocks = self.stores.get(BLOCK_STORE)?;
+
+        match (blocks.live_bytes, blocks.entries) {
+            (Some(bytes), Some(entries)) if entries > 0 => Some(bytes as f64 / entries as f64),
+            _ => None,
+        }
+    }
+
+    /// The ratio of on-disk bytes to live bytes across all stores that report
+    /// both, if any do
+    pub fn space_amplification(&self) -> Option<f64> {
+        let (live, on_disk) = self
+            .stores
+            .values()
+            .filter_map(|store| Some((store.live_bytes?, store.on_disk_bytes?)))
+            .fold(
+                (0u64, 0u64),
+                |(live, on_disk), (store_live, store_on_disk)| {
+                    (live + store_live, on_disk + store_on_disk)
+                },
+            );
+
+        (live > 0).then(|| on_disk as f64 / live as f64)
+    }
+
+    /// Publish these stats to the storage gauges of the process-wide metrics
+    /// registry, so that they are reported wherever metrics are scraped
+    pub fn record_metrics(&self) {
+        let storage_metrics = &metrics().storage;
+
+        storage_metrics
+            .space_usage_bytes
+            .set(clamp(self.space_usage));
+
+        for (name, store) in self.stores.iter() {
+            if !SPHERE_DB_STORE_NAMES.contains(&name.as_str()) {
+                continue;
+            }
+
+            if let Some(live_bytes) = store.live_bytes {
+                storage_metrics.live_bytes.get(name).set(clamp(live_bytes));
+            }
+            if let Some(on_disk_bytes) = store.on_disk_bytes {
+                storage_metrics
+                    .on_disk_bytes
+                    .get(name)
+                    .set(clamp(on_disk_bytes));
+            }
+            if let Some(entries) = store.entries {
+                storage_metrics.entries.get(name).set(clamp(entries));
+            }
+        }
+
+        if let Some(pending_compaction_bytes) = self.pending_compaction_bytes {
+            storage_metrics
+                .pending_compaction_bytes
+                .set(clamp(pending_compaction_bytes));
+        }
+    }
+}
+
+fn clamp(value: u64) -> i64 {
+    i64::try_from(value).unwrap_or(i64::MAX)
+}
 
 /// [Space] is a general trait for a storage provider to provide
 /// a the size on disk, used to calculate space amplification.
@@ -9,6 +112,16 @@ use noosphere_common::ConditionalSend;
 pub trait Space: ConditionalSend {
     /// Get the underlying (e.g. disk) space usage of a storage provider.
     async fn get_space_usage(&self) -> Result<u64>;
+
+    /// Get a per-store breakdown of space usage. Implementations should only
+    /// report what they can determine without walking the filesystem; by
+    /// default, only [Space::get_space_usage] is reported.
+    async fn get_storage_stats(&self) -> Result<StorageStats> {
+        Ok(StorageStats {
+            space_usage: self.get_space_usage().await?,
+            ..Default::default()
+        })
+    }
 }
 
 #[allow(unused)]
@@ -35,3 +148,42 @@ pub(crate) async fn get_dir_size(path: impl Into<std::path::PathBuf>) -> Result<
 
     dir_size(tokio::fs::read_dir(path).await?).await
 }
+
+#[cfg(test)]
+mod tests {
+    use libipld_cbor::DagCborCodec;
+    use noosphere_common::metrics::metrics;
+    #[cfg(target_arch = "wasm32")]
+    use wasm_bindgen_test::wasm_bindgen_test;
+
+    use crate::{BlockStore, MemoryStorage, Space, SphereDb, BLOCK_STORE, LINK_STORE};
+
+    #[cfg(target_arch = "wasm32")]
+    wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+
+    #[cfg_attr(target_arch = "wasm32", wasm_bindgen_test)]
+    #[cfg_attr(not(target_arch = "wasm32"), tokio::test)]
+    async fn it_reports_stats_for_each_store() {
+        let storage = MemoryStorage::default();
+        let mut db = SphereDb::new(&storage).await.unwrap();
+
+        for index in 0..4u8 {
+            db.save::<DagCborCodec, _>(vec![index; 32]).await.unwrap();
+        }
+
+        let stats = db.storage().get_storage_stats().await.unwrap();
+
+        assert_eq!(stats.block_count(), Some(4));
+        assert!(stats.average_block_size().unwrap() > 32.0);
+        assert_eq!(stats.stores[LINK_STORE].entries, Some(4));
+        assert_eq!(stats.space_usage, storage.get_space_usage().await.unwrap());
+        assert_eq!(stats.space_amplification(), Some(1.0));
+
+        stats.record_metrics();
+
+        assert_eq!(
+            metrics().storage.entries.get(BLOCK_STORE).get(),
+            stats.block_count().unwrap() as i64
+        );
+    }
+}
@@ -0,0 +1,353 @@
+//! A load generator for Noosphere gateways. One single-tenant gateway is
+//! started per simulated client, and all of the gateways are backed by
+//! in-process stand-ins for IPFS Kubo and the Noosphere name system, so no
+//! external services are needed. Every client then runs a loop of writing,
+//! saving, syncing and (periodically) replicating a peer's sphere revision
+//! through its gateway.
+//!
+//! At the end of the run, latency percentiles for each client operation, push
+//! and fetch throughput and on-disk storage growth are reported:
+//!
+//! `cargo run --release --example gateway_load -- --clients 8 --iterations 50`
+//!
+//! Options:
+//!
+//! - `--clients <n>`: number of simulated clients and gateways (default 4)
+//! - `--iterations <n>`: write/save/sync loops per client (default 20)
+//! - `--slugs <n>`: distinct slugs that each client writes to (default 32)
+//! - `--file-size <bytes>`: size of each file written (default 1024)
+//! - `--writes-per-save <n>`: writes that make up each revision (default 4)
+//! - `--replicate-every <n>`: replicate a random syndicated revision every
+//!   `n` loops, or never if `0` (default 5)
+//! - `--json <path>`: also write the report as JSON
+
+// TODO(#629): Remove this when we migrate off of `release-please`
+#[cfg(not(target_arch = "wasm32"))]
+extern crate noosphere_cli_dev as noosphere_cli;
+#[cfg(not(target_arch = "wasm32"))]
+extern crate noosphere_ns_dev as noosphere_ns;
+
+#[cfg(not(target_arch = "wasm32"))]
+mod proxy;
+#[cfg(not(target_arch = "wasm32"))]
+mod report;
+#[cfg(not(target_arch = "wasm32"))]
+mod stand_in;
+
+#[cfg(target_arch = "wasm32")]
+pub fn main() {}
+
+#[cfg(not(target_arch = "wasm32"))]
+pub fn main() -> anyhow::Result<()> {
+    native::main()
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+mod native {
+    use crate::{
+        proxy::{CountingProxy, Traffic},
+        report::{
+            directory_size, LatencySummary, LoadRecorder, Operation, StorageSummary, TrafficSummary,
+        },
+        stand_in::{StandInKubo, StandInNameSystem},
+    };
+    use anyhow::{anyhow, Result};
+    use noosphere_cli::{helpers::SpherePair, workspace::CliSphereContext};
+    use noosphere_core::{
+        context::{HasMutableSphereContext, HasSphereContext, SphereContentWrite, SphereSync},
+        data::ContentType,
+        tracing::initialize_tracing,
+    };
+    use rand::{rngs::StdRng, Rng, RngCore, SeedableRng};
+    use serde::Serialize;
+    use std::{
+        collections::BTreeMap,
+        path::PathBuf,
+        sync::{atomic::Ordering, Arc},
+        time::Instant,
+    };
+    use tokio::sync::Mutex;
+    use tokio_stream::StreamExt;
+
+    #[derive(Debug, Clone, Serialize)]
+    struct LoadConfig {
+        clients: usize,
+        iterations: usize,
+        slugs: usize,
+        file_size: usize,
+        writes_per_save: usize,
+        replicate_every: usize,
+        #[serde(skip)]
+        json: Option<PathBuf>,
+    }
+
+    impl Default for LoadConfig {
+        fn default() -> Self {
+            LoadConfig {
+                clients: 4,
+                iterations: 20,
+                slugs: 32,
+                file_size: 1024,
+                writes_per_save: 4,
+                replicate_every: 5,
+                json: None,
+            }
+        }
+    }
+
+    impl LoadConfig {
+        fn from_args() -> Result<Self> {
+            let mut config = LoadConfig::default();
+            let mut args = std::env::args().skip(1);
+
+            while let Some(arg) = args.next() {
+                let mut value = || {
+                    args.next()
+                        .ok_or_else(|| anyhow!("Missing value for {}", arg))
+                };
+
+                match arg.as_str() {
+                    "--clients" => config.clients = value()?.parse()?,
+                    "--iterations" => config.iterations = value()?.parse()?,
+                    "--slugs" => config.slugs = value()?.parse()?,
+                    "--file-size" => config.file_size = value()?.parse()?,
+                    "--writes-per-save" => config.writes_per_save = value()?.parse()?,
+                    "--replicate-every" => config.replicate_every = value()?.parse()?,
+                    "--json" => config.json = Some(value()?.into()),
+                    _ => return Err(anyhow!("Unrecognized argument: {}", arg)),
+                }
+            }
+
+            if config.clients == 0 || config.slugs == 0 {
+                return Err(anyhow!("--clients and --slugs must be at least 1"));
+            }
+
+            Ok(config)
+        }
+    }
+
+    /// The outcome of a load run, in a form that is suitable for serializing
+    /// as JSON (see `--json` above)
+    #[derive(Serialize)]
+    struct LoadReport {
+        config: LoadConfig,
+        elapsed_secs: f64,
+        operations: BTreeMap<String, LatencySummary>,
+        traffic: TrafficSummary,
+        storage: StorageSummary,
+    }
+
+    struct SimulatedClient {
+        pair: SpherePair,
+        _proxy: CountingProxy,
+    }
+
+    impl SimulatedClient {
+        /// Create a client and gateway sphere pair, start the gateway, and
+        /// route the client's gateway traffic through a [CountingProxy]
+        async fn new(
+            index: usize,
+            kubo: &StandInKubo,
+            name_system: &StandInNameSystem,
+            traffic: Arc<Traffic>,
+        ) -> Result<Self> {
+            let mut pair =
+                SpherePair::new(&format!("LOAD{index}"), kubo.url(), name_system.url()).await?;
+            pair.start_gateway().await?;
+
+            let gateway_url = pair.client.workspace.gateway_url().await?;
+            let proxy = CountingProxy::start(&gateway_url, traffic).await?;
+
+            pair.sphere_context()
+                .await?
+                .lock()
+                .await
+                .configure_gateway_url(Some(proxy.url()))
+                .await?;
+
+            Ok(SimulatedClient {
+                pair,
+                _proxy: proxy,
+            })
+        }
+
+        fn storage_size(&self) -> Result<(u64, u64)> {
+            Ok((
+                directory_size(self.pair.client.sphere_root())?,
+                directory_size(self.pair.gateway.sphere_root())?,
+            ))
+        }
+    }
+
+    async fn run_client(
+        mut ctx: Arc<Mutex<CliSphereContext>>,
+        config: LoadConfig,
+        seed: u64,
+        recorder: Arc<LoadRecorder>,
+        kubo: Arc<StandInKubo>,
+    ) -> Result<()> {
+        let mut rng = StdRng::seed_from_u64(seed);
+        let mut bytes = vec![0u8; config.file_size];
+
+        for iteration in 1..=config.iterations {
+            for _ in 0..config.writes_per_save {
+                let slug = format!("slug{}", rng.gen_range(0..config.slugs));
+                rng.fill_bytes(&mut bytes);
+
+                let _ = recorder
+                    .time(
+                        Operation::Write,
+                        ctx.write(&slug, &ContentType::Bytes, bytes.as_slice(), None),
+                    )
+                    .await;
+            }
+
+            let _ = recorder.time(Operation::Save, ctx.save(None)).await;
+            let _ = recorder.time(Operation::Sync, ctx.sync()).await;
+
+            if config.replicate_every > 0 && iteration % config.replicate_every == 0 {
+                if let Some(root) = kubo.random_root(&mut rng) {
+                    let _ = recorder
+                        .time(Operation::Replicate, async {
+                            let client = ctx.sphere_context().await?.client().await?;
+                            let (_, stream) = client.replicate(root, None).await?;
+
+                            tokio::pin!(stream);
+
+                            while let Some(item) = stream.next().await {
+                                let (_, block) = item?;
+                                recorder.record_replicated_bytes(block.len());
+                            }
+
+                            Ok(()) as Result<()>
+                        })
+                        .await;
+                }
+            }
+        }
+
+        Ok(())
+    }
+
+    fn log_latencies(operations: &BTreeMap<String, LatencySummary>) {
+        for (name, summary) in operations {
+            println!(
+                "{}: {} ok, {} failed (avg {:.1}ms, p50 {:.1}ms, p90 {:.1}ms, p99 {:.1}ms, p999 {:.1}ms, max {:.1}ms)",
+                name,
+                summary.count,
+                summary.failures,
+                summary.mean / 1000.0,
+                summary.p50 as f64 / 1000.0,
+                summary.p90 as f64 / 1000.0,
+                summary.p99 as f64 / 1000.0,
+                summary.p999 as f64 / 1000.0,
+                summary.max as f64 / 1000.0
+            );
+        }
+    }
+
+    fn log_report(report: &LoadReport) {
+        println!(
+            "{} clients x {} iterations in {:.2}s",
+            report.config.clients, report.config.iterations, report.elapsed_secs
+        );
+        log_latencies(&report.operations);
+
+        let traffic = &report.traffic;
+        println!(
+            "push: {} bytes ({:.0} bytes/s)",
+            traffic.push_bytes, traffic.push_bytes_per_sec
+        );
+        println!(
+            "fetch: {} bytes ({:.0} bytes/s, {} replicated block bytes)",
+            traffic.fetch_bytes, traffic.fetch_bytes_per_sec, traffic.replicated_block_bytes
+        );
+
+        let storage = &report.storage;
+        println!(
+            "client storage: {} -> {} bytes",
+            storage.client_bytes_before, storage.client_bytes_after
+        );
+        println!(
+            "gateway storage: {} -> {} bytes",
+            storage.gateway_bytes_before, storage.gateway_bytes_after
+        );
+        println!("syndicated to IPFS: {} bytes", storage.syndicated_bytes);
+    }
+
+    fn total_storage_size(clients: &[SimulatedClient]) -> Result<(u64, u64)> {
+        clients
+            .iter()
+            .try_fold((0, 0), |(client_total, gateway_total), client| {
+                let (client_size, gateway_size) = client.storage_size()?;
+                Ok((client_total + client_size, gateway_total + gateway_size))
+            })
+    }
+
+    #[tokio::main(flavor = "multi_thread")]
+    pub async fn main() -> Result<()> {
+        initialize_tracing(None);
+
+        let config = LoadConfig::from_args()?;
+        let kubo = Arc::new(StandInKubo::start().await?);
+        let name_system = StandInNameSystem::start().await?;
+        let traffic = Arc::new(Traffic::default());
+        let recorder = Arc::new(LoadRecorder::default());
+
+        let mut clients = Vec::with_capacity(config.clients);
+
+        for index in 0..config.clients {
+            clients.push(SimulatedClient::new(index, &kubo, &name_system, traffic.clone()).await?);
+        }
+
+        let (client_bytes_before, gateway_bytes_before) = total_storage_size(&clients)?;
+        let started = Instant::now();
+
+        let mut tasks = Vec::with_capacity(clients.len());
+
+        for (index, client) in clients.iter().enumerate() {
+            tasks.push(tokio::spawn(run_client(
+                client.pair.sphere_context().await?,
+                config.clone(),
+                index as u64,
+                recorder.clone(),
+                kubo.clone(),
+            )));
+        }
+
+        for task in tasks {
+            task.await??;
+        }
+
+        let elapsed = started.elapsed();
+        let (client_bytes_after, gateway_bytes_after) = total_storage_size(&clients)?;
+
+        let report = LoadReport {
+            config: config.clone(),
+            elapsed_secs: elapsed.as_secs_f64(),
+            operations: recorder.summarize(),
+            traffic: TrafficSummary::new(
+                traffic.upstream.load(Ordering::Relaxed),
+                traffic.downstream.load(Ordering::Relaxed),
+                recorder.replicated_bytes(),
+                elapsed,
+            ),
+            storage: StorageSummary {
+                client_bytes_before,
+                client_bytes_after,
+                gateway_bytes_before,
+                gateway_bytes_after,
+                syndicated_bytes: kubo.imported_bytes(),
+            },
+        };
+
+        log_report(&report);
+
+        if let Some(path) = &config.json {
+            std::fs::write(path, serde_json::to_string_pretty(&report)?)?;
+            println!("Wrote JSON report to {}", path.display());
+        }
+
+        Ok(())
+    }
+}
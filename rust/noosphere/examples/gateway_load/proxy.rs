@@ -0,0 +1,104 @@
+//! A TCP relay that sits between a client and its gateway and counts the bytes
+//! that flow in each direction. Bytes sent to the gateway are mostly pushed
+//! history; bytes received from it are mostly fetched and replicated blocks.
+
+use anyhow::{anyhow, Result};
+use std::{
+    net::SocketAddr,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc,
+    },
+};
+use tokio::{
+    io::{AsyncRead, AsyncReadExt, AsyncWrite, AsyncWriteExt},
+    net::{TcpListener, TcpStream},
+    task::JoinHandle,
+};
+use url::Url;
+
+const RELAY_BUFFER_SIZE: usize = 64 * 1024;
+
+/// Running byte totals, shared by every [CountingProxy] in a run
+#[derive(Debug, Default)]
+pub struct Traffic {
+    /// Bytes sent from clients to gateways
+    pub upstream: AtomicU64,
+    /// Bytes sent from gateways to clients
+    pub downstream: AtomicU64,
+}
+
+pub struct CountingProxy {
+    url: Url,
+    task: JoinHandle<()>,
+}
+
+impl CountingProxy {
+    /// Start relaying connections to the host and port of `target`
+    pub async fn start(target: &Url, traffic: Arc<Traffic>) -> Result<Self> {
+        let target_address = target
+            .socket_addrs(|| None)?
+            .into_iter()
+            .next()
+            .ok_or_else(|| anyhow!("Could not resolve {}", target))?;
+
+        let listener = TcpListener::bind("127.0.0.1:0").await?;
+        let address = listener.local_addr()?;
+        let url = Url::parse(&format!("http://{}:{}", address.ip(), address.port()))?;
+
+        let task = tokio::spawn(async move {
+            while let Ok((inbound, _)) = listener.accept().await {
+                tokio::spawn(relay_connection(inbound, target_address, traffic.clone()));
+            }
+        });
+
+        Ok(CountingProxy { url, task })
+    }
+
+    pub fn url(&self) -> &Url {
+        &self.url
+    }
+}
+
+impl Drop for CountingProxy {
+    fn drop(&mut self) {
+        self.task.abort();
+    }
+}
+
+async fn relay_connection(inbound: TcpStream, target: SocketAddr, traffic: Arc<Traffic>) {
+    let outbound = match TcpStream::connect(target).await {
+        Ok(outbound) => outbound,
+        Err(error) => {
+            tracing::warn!("Could not connect to gateway at {}: {}", target, error);
+            return;
+        }
+    };
+
+    let (inbound_read, inbound_write) = inbound.into_split();
+    let (outbound_read, outbound_write) = outbound.into_split();
+
+    let _ = tokio::join!(
+        relay(inbound_read, outbound_write, &traffic.upstream),
+        relay(outbound_read, inbound_write, &traffic.downstream)
+    );
+}
+
+async fn relay<R, W>(mut from: R, mut to: W, counter: &AtomicU64) -> std::io::Result<()>
+where
+    R: AsyncRead + Unpin,
+    W: AsyncWrite + Unpin,
+{
+    let mut buffer = vec![0u8; RELAY_BUFFER_SIZE];
+
+    loop {
+        let read = from.read(&mut buffer).await?;
+
+        if read == 0 {
+            return to.shutdown().await;
+        }
+
+        to.write_all(&buffer[..read]).await?;
+        counter.fetch_add(read as u64, Ordering::Relaxed);
+    }
+}
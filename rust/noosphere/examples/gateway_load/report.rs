@@ -0,0 +1,219 @@
+use anyhow::Result;
+use hdrhistogram::Histogram;
+use serde::Serialize;
+use std::{
+    collections::BTreeMap,
+    fmt::Display,
+    future::Future,
+    path::Path,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Mutex,
+    },
+    time::{Duration, Instant},
+};
+
+/// The highest latency that can be recorded, in microseconds; slower
+/// operations are clamped to this value
+const MAX_TRACKABLE_LATENCY_US: u64 = 10 * 60 * 1_000_000;
+
+/// Number of significant decimal digits retained by each latency histogram
+const LATENCY_PRECISION: u8 = 3;
+
+/// The client operations whose latencies are recorded. A sync is a fetch
+/// request followed by a push request; a replication is a single replicate
+/// request that the gateway may have to satisfy from IPFS.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, PartialOrd, Ord)]
+pub enum Operation {
+    Write,
+    Save,
+    Sync,
+    Replicate,
+}
+
+impl Operation {
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Operation::Write => "write",
+            Operation::Save => "save",
+            Operation::Sync => "sync",
+            Operation::Replicate => "replicate",
+        }
+    }
+}
+
+#[derive(Debug)]
+struct OperationRecorder {
+    latencies: Histogram<u64>,
+    failures: u64,
+}
+
+impl Default for OperationRecorder {
+    fn default() -> Self {
+        OperationRecorder {
+            latencies: Histogram::new_with_bounds(1, MAX_TRACKABLE_LATENCY_US, LATENCY_PRECISION)
+                .expect("Histogram bounds are valid"),
+            failures: 0,
+        }
+    }
+}
+
+/// Collects latencies for every [Operation] performed by every simulated
+/// client in a run
+#[derive(Debug, Default)]
+pub struct LoadRecorder {
+    operations: Mutex<BTreeMap<Operation, OperationRecorder>>,
+    replicated_bytes: AtomicU64,
+}
+
+impl LoadRecorder {
+    /// Await `future`, recording how long it took under `operation`. Errors
+    /// are counted as failures and logged, then handed back to the caller.
+    pub async fn time<T, E, F>(&self, operation: Operation, future: F) -> Result<T, E>
+    where
+        F: Future<Output = Result<T, E>>,
+        E: Display,
+    {
+        let start = Instant::now();
+        let result = future.await;
+        let elapsed = start.elapsed();
+
+        let mut operations = self.operations.lock().unwrap();
+        let recorder = operations.entry(operation).or_default();
+
+        match &result {
+            Ok(_) => {
+                let micros = u64::try_from(elapsed.as_micros()).unwrap_or(u64::MAX);
+                recorder.latencies.saturating_record(micros.max(1));
+            }
+            Err(error) => {
+                tracing::warn!("Failed to {}: {}", operation.as_str(), error);
+                recorder.failures += 1;
+            }
+        }
+
+        result
+    }
+
+    pub fn record_replicated_bytes(&self, bytes: usize) {
+        self.replicated_bytes
+            .fetch_add(bytes as u64, Ordering::Relaxed);
+    }
+
+    pub fn replicated_bytes(&self) -> u64 {
+        self.replicated_bytes.load(Ordering::Relaxed)
+    }
+
+    pub fn summarize(&self) -> BTreeMap<String, LatencySummary> {
+        self.operations
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|(operation, recorder)| (operation.as_str().to_owned(), recorder.into()))
+            .collect()
+    }
+}
+
+/// A summary of the latencies of one kind of [Operation], in microseconds
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct LatencySummary {
+    pub count: u64,
+    pub failures: u64,
+    pub mean: f64,
+    pub p50: u64,
+    pub p90: u64,
+    pub p99: u64,
+    pub p999: u64,
+    pub max: u64,
+}
+
+impl From<&OperationRecorder> for LatencySummary {
+    fn from(value: &OperationRecorder) -> Self {
+        let histogram = &value.latencies;
+
+        if histogram.is_empty() {
+            return LatencySummary {
+                failures: value.failures,
+                ..Default::default()
+            };
+        }
+
+        LatencySummary {
+            count: histogram.len(),
+            failures: value.failures,
+            mean: histogram.mean(),
+            p50: histogram.value_at_quantile(0.5),
+            p90: histogram.value_at_quantile(0.9),
+            p99: histogram.value_at_quantile(0.99),
+            p999: histogram.value_at_quantile(0.999),
+            max: histogram.max(),
+        }
+    }
+}
+
+/// Bytes that crossed the wire between clients and gateways over the run
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct TrafficSummary {
+    pub push_bytes: u64,
+    pub push_bytes_per_sec: f64,
+    pub fetch_bytes: u64,
+    pub fetch_bytes_per_sec: f64,
+    /// The portion of the block bytes received by clients that came from
+    /// replicate requests
+    pub replicated_block_bytes: u64,
+}
+
+impl TrafficSummary {
+    pub fn new(
+        push_bytes: u64,
+        fetch_bytes: u64,
+        replicated_block_bytes: u64,
+        elapsed: Duration,
+    ) -> Self {
+        let seconds = elapsed.as_secs_f64();
+        let per_second = |bytes: u64| {
+            if seconds > 0.0 {
+                bytes as f64 / seconds
+            } else {
+                0.0
+            }
+        };
+
+        TrafficSummary {
+            push_bytes,
+            push_bytes_per_sec: per_second(push_bytes),
+            fetch_bytes,
+            fetch_bytes_per_sec: per_second(fetch_bytes),
+            replicated_block_bytes,
+        }
+    }
+}
+
+/// On-disk size of the client and gateway spheres before and after the run,
+/// along with the bytes syndicated to the stand-in IPFS node
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct StorageSummary {
+    pub client_bytes_before: u64,
+    pub client_bytes_after: u64,
+    pub gateway_bytes_before: u64,
+    pub gateway_bytes_after: u64,
+    pub syndicated_bytes: u64,
+}
+
+/// Sum the sizes of all files below `path`
+pub fn directory_size(path: &Path) -> Result<u64> {
+    let mut size = 0;
+
+    for entry in std::fs::read_dir(path)? {
+        let entry = entry?;
+        let file_type = entry.file_type()?;
+
+        if file_type.is_dir() {
+            size += directory_size(&entry.path())?;
+        } else if file_type.is_file() {
+            size += entry.metadata()?.len();
+        }
+    }
+
+    Ok(size)
+}
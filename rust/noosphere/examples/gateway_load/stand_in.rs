@@ -0,0 +1,269 @@
+//! In-process stand-ins for the IPFS Kubo RPC API and the Noosphere name
+//! system REST API. The gateway reaches both of these over HTTP (via
+//! `KuboClient` and the name system `HttpClient` respectively), so the
+//! stand-ins implement just enough of each API for a gateway to syndicate,
+//! replicate, publish and resolve against them without any external services.
+
+use anyhow::Result;
+use axum::{
+    extract::{DefaultBodyLimit, Multipart, Path, Query, State},
+    http::StatusCode,
+    routing::{get, post},
+    serve, Json, Router,
+};
+use cid::Cid;
+use iroh_car::CarReader;
+use noosphere_core::data::{Did, LinkRecord};
+use noosphere_ns::PeerId;
+use noosphere_storage::{BlockStore, MemoryStore};
+use rand::Rng;
+use serde::Deserialize;
+use serde_json::{json, Map, Value};
+use std::{
+    collections::{HashMap, HashSet},
+    io::Cursor,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc, Mutex,
+    },
+};
+use tokio::{net::TcpListener, task::JoinHandle};
+use url::Url;
+
+type HandlerResult<T> = Result<T, (StatusCode, String)>;
+
+fn internal_error<E: std::fmt::Display>(error: E) -> (StatusCode, String) {
+    (StatusCode::INTERNAL_SERVER_ERROR, error.to_string())
+}
+
+async fn serve_router(router: Router) -> Result<(Url, JoinHandle<()>)> {
+    let listener = TcpListener::bind("127.0.0.1:0").await?;
+    let address = listener.local_addr()?;
+    let url = Url::parse(&format!("http://{}:{}", address.ip(), address.port()))?;
+
+    let task = tokio::spawn(async move {
+        if let Err(error) = serve(listener, router.into_make_service()).await {
+            tracing::error!("Stand-in server stopped: {}", error);
+        }
+    });
+
+    Ok((url, task))
+}
+
+#[derive(Deserialize)]
+struct ArgQuery {
+    arg: String,
+}
+
+#[derive(Clone, Default)]
+struct KuboState {
+    blocks: MemoryStore,
+    pins: Arc<Mutex<HashSet<String>>>,
+    roots: Arc<Mutex<Vec<Cid>>>,
+    imported_bytes: Arc<AtomicU64>,
+}
+
+/// A stand-in for the subset of the Kubo RPC API that a gateway uses: DAG
+/// import and retrieval, pinning and node identity. Imported blocks are kept
+/// in a [MemoryStore] that is shared by every gateway in the run.
+pub struct StandInKubo {
+    url: Url,
+    state: KuboState,
+    task: JoinHandle<()>,
+}
+
+impl StandInKubo {
+    pub async fn start() -> Result<Self> {
+        let state = KuboState::default();
+        let router = Router::new()
+            .route("/api/v0/id", post(kubo_id))
+            .route("/api/v0/pin/add", post(kubo_pin_add))
+            .route("/api/v0/pin/ls", post(kubo_pin_ls))
+            .route("/api/v0/dag/import", post(kubo_dag_import))
+            .route("/api/v0/dag/get", post(kubo_dag_get))
+            // Syndicated CARs can be far larger than the default body limit
+            .layer(DefaultBodyLimit::disable())
+            .with_state(state.clone());
+
+        let (url, task) = serve_router(router).await?;
+
+        Ok(StandInKubo { url, state, task })
+    }
+
+    pub fn url(&self) -> &Url {
+        &self.url
+    }
+
+    /// The total size of all CARs that have been imported so far
+    pub fn imported_bytes(&self) -> u64 {
+        self.state.imported_bytes.load(Ordering::Relaxed)
+    }
+
+    /// Pick one of the sphere revisions that has been syndicated so far, if
+    /// there are any
+    pub fn random_root<R: Rng>(&self, rng: &mut R) -> Option<Cid> {
+        let roots = self.state.roots.lock().unwrap();
+
+        if roots.is_empty() {
+            None
+        } else {
+            Some(roots[rng.gen_range(0..roots.len())])
+        }
+    }
+}
+
+impl Drop for StandInKubo {
+    fn drop(&mut self) {
+        self.task.abort();
+    }
+}
+
+async fn kubo_id() -> Json<Value> {
+    let peer_id = PeerId::random().to_string();
+    Json(json!({ "ID": peer_id, "PublicKey": peer_id }))
+}
+
+async fn kubo_pin_add(
+    State(state): State<KuboState>,
+    Query(ArgQuery { arg }): Query<ArgQuery>,
+) -> Json<Value> {
+    state.pins.lock().unwrap().insert(arg.clone());
+    Json(json!({ "Pins": [arg] }))
+}
+
+async fn kubo_pin_ls(
+    State(state): State<KuboState>,
+    Query(ArgQuery { arg }): Query<ArgQuery>,
+) -> HandlerResult<Json<Value>> {
+    if state.pins.lock().unwrap().contains(&arg) {
+        let mut keys = Map::new();
+        keys.insert(arg, json!({ "Type": "recursive" }));
+        Ok(Json(json!({ "Keys": keys })))
+    } else {
+        Err(internal_error(format!("path '{arg}' is not pinned")))
+    }
+}
+
+async fn kubo_dag_import(
+    State(state): State<KuboState>,
+    mut multipart: Multipart,
+) -> HandlerResult<Json<Value>> {
+    let mut blocks = state.blocks.clone();
+
+    while let Some(field) = multipart
+        .next_field()
+        .await
+        .map_err(|error| (StatusCode::BAD_REQUEST, error.to_string()))?
+    {
+        let car_bytes = field
+            .bytes()
+            .await
+            .map_err(|error| (StatusCode::BAD_REQUEST, error.to_string()))?;
+        let car_length = car_bytes.len() as u64;
+        let mut reader = CarReader::new(Cursor::new(car_bytes))
+            .await
+            .map_err(internal_error)?;
+        let roots = reader.header().roots().to_vec();
+
+        while let Some((cid, block)) = reader.next_block().await.map_err(internal_error)? {
+            blocks
+                .put_block(&cid, &block)
+                .await
+                .map_err(internal_error)?;
+        }
+
+        state
+            .imported_bytes
+            .fetch_add(car_length, Ordering::Relaxed);
+        state.roots.lock().unwrap().extend(roots);
+    }
+
+    Ok(Json(json!({})))
+}
+
+async fn kubo_dag_get(
+    State(state): State<KuboState>,
+    Query(ArgQuery { arg }): Query<ArgQuery>,
+) -> HandlerResult<Vec<u8>> {
+    let cid = Cid::try_from(arg.as_str())
+        .map_err(|error| (StatusCode::BAD_REQUEST, error.to_string()))?;
+
+    match state.blocks.get_block(&cid).await.map_err(internal_error)? {
+        Some(block) => Ok(block),
+        None => Err(internal_error(format!("block {cid} not found"))),
+    }
+}
+
+#[derive(Clone)]
+struct NameSystemState {
+    peer_id: PeerId,
+    records: Arc<Mutex<HashMap<Did, LinkRecord>>>,
+}
+
+/// A stand-in for the Noosphere name system REST API that keeps the latest
+/// published [LinkRecord] for each sphere in memory. Records are not
+/// validated, so the measured cost of name system jobs is mostly that of the
+/// gateway itself.
+pub struct StandInNameSystem {
+    url: Url,
+    task: JoinHandle<()>,
+}
+
+impl StandInNameSystem {
+    pub async fn start() -> Result<Self> {
+        let state = NameSystemState {
+            peer_id: PeerId::random(),
+            records: Default::default(),
+        };
+        let router = Router::new()
+            .route("/api/v0alpha1/peer_id", get(name_system_peer_id))
+            .route(
+                "/api/v0alpha1/records/:identity",
+                get(name_system_get_record),
+            )
+            .route("/api/v0alpha1/records", post(name_system_post_record))
+            .with_state(state);
+
+        let (url, task) = serve_router(router).await?;
+
+        Ok(StandInNameSystem { url, task })
+    }
+
+    pub fn url(&self) -> &Url {
+        &self.url
+    }
+}
+
+impl Drop for StandInNameSystem {
+    fn drop(&mut self) {
+        self.task.abort();
+    }
+}
+
+async fn name_system_peer_id(State(state): State<NameSystemState>) -> Json<PeerId> {
+    Json(state.peer_id)
+}
+
+async fn name_system_get_record(
+    State(state): State<NameSystemState>,
+    Path(identity): Path<Did>,
+) -> Json<Option<LinkRecord>> {
+    Json(state.records.lock().unwrap().get(&identity).cloned())
+}
+
+async fn name_system_post_record(
+    State(state): State<NameSystemState>,
+    Json(record): Json<LinkRecord>,
+) -> Json<()> {
+    let mut records = state.records.lock().unwrap();
+    let identity = record.to_sphere_identity();
+
+    match records.get(&identity) {
+        Some(existing) if record.superceded_by(existing) => (),
+        _ => {
+            records.insert(identity, record);
+        }
+    }
+
+    Json(())
+}
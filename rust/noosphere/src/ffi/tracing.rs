@@ -1,5 +1,6 @@
 #![allow(missing_docs)]
 
+use noosphere_common::enable_stall_detection;
 use noosphere_core::tracing::{initialize_tracing, NoosphereLog};
 use safer_ffi::prelude::*;
 
@@ -31,6 +32,8 @@ const NOOSPHERE_LOG_ACADEMIC: u32 = 4;
 const NOOSPHERE_LOG_TIRESOME: u32 = 5;
 const NOOSPHERE_LOG_DEAFENING: u32 = 6;
 
+const NOOSPHERE_LOG_STALL_DETECTION: u32 = 1 << 8;
+
 #[derive_ReprC(rename = "ns_noosphere_log")]
 #[repr(u32)]
 #[ffi_export]
@@ -53,6 +56,19 @@ pub enum NsNoosphereLog {
     Deafening = NOOSPHERE_LOG_DEAFENING,
 }
 
+#[derive_ReprC(rename = "ns_noosphere_log_flag")]
+#[repr(u32)]
+#[ffi_export]
+/// Flags that may be combined (with bitwise OR) with one of the
+/// ns_noosphere_log presets in the configuration passed to
+/// ns_tracing_initialize.
+pub enum NsNoosphereLogFlag {
+    /// Switch on the runtime stall detector: task polls and synchronous
+    /// sections are timed, and stalled CAR and replication streams are
+    /// reported as warnings along with the span that they were created in
+    StallDetection = NOOSPHERE_LOG_STALL_DETECTION,
+}
+
 impl From<NsNoosphereLog> for NoosphereLog {
     fn from(log: NsNoosphereLog) -> Self {
         match log {
@@ -82,7 +98,12 @@ impl From<u32> for NsNoosphereLog {
 }
 
 #[ffi_export]
-/// Initialize log output for Noosphere-related code
+/// Initialize log output for Noosphere-related code. The configuration is one
+/// of the ns_noosphere_log presets, optionally combined (with bitwise OR) with
+/// NS_NOOSPHERE_LOG_FLAG_STALL_DETECTION to switch on the stall detector.
 pub fn ns_tracing_initialize(configuration: u32) {
-    initialize_tracing(Some(NsNoosphereLog::from(configuration).into()));
+    enable_stall_detection(configuration & NOOSPHERE_LOG_STALL_DETECTION != 0);
+    initialize_tracing(Some(
+        NsNoosphereLog::from(configuration & !NOOSPHERE_LOG_STALL_DETECTION).into(),
+    ));
 }